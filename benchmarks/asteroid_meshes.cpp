@@ -0,0 +1,39 @@
+#include <iostream>
+
+#include <rg/AsteroidMeshes.hpp>
+#include <rg/JobSystem.hpp>
+
+#include "bench.hpp"
+
+// Generation time and size of the asteroid pool for 16, 64 (the demo's default) and 256 variants, and
+// whether the pool fits in the 65536 texels every GL 3.3 buffer texture holds.
+
+int main(int argc, char **argv) {
+    bench::Arguments arguments(argc, argv, "[subdivisions] [runs] [threads]");
+    int subdivisions = arguments.get(1, 2);
+    int runs = arguments.get(2, 5);
+    int threads = arguments.get(3, -1);
+    rg::JobSystem jobs(threads);
+    const size_t guaranteedTexels = 65536;
+
+    std::cout << "subdivision " << subdivisions << ", best of " << runs << " runs on " << jobs.threadCount()
+              << " threads:\n";
+    for (int variants: {16, 64, 256}) {
+        size_t bytes = 0, texels = 0;
+        int vertexCount = 0;
+        double seconds = bench::bestOf(runs, [&](int) {
+            rg::AsteroidMeshes meshes(variants, subdivisions, 1234u, jobs);
+            bytes = meshes.memoryUsage();
+            texels = meshes.vertices.size() * 2;
+            vertexCount = meshes.vertexCount();
+        });
+        std::cout << "  " << variants << " variants of " << vertexCount << " vertices: " << seconds * 1000.0
+                  << " ms, " << bytes / 1024 << " KiB, " << texels << " texels";
+        if (texels > guaranteedTexels) {
+            std::cout << ", over the GL 3.3 minimum, setupMesh keeps " << guaranteedTexels / (2 * vertexCount)
+                      << " on such drivers";
+        }
+        std::cout << '\n';
+    }
+    return 0;
+}
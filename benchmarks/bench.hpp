@@ -0,0 +1,55 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_BENCH_HPP
+#define MATF_RG_PROJEKAT_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+// Timing and argument helpers shared by the programs in benchmarks/, which print plain results to stdout.
+namespace bench {
+
+    inline double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Seconds taken by the fastest of `runs` calls to run(i), i counting from 0. The fastest run is the one
+     * the scheduler and the rest of the system disturbed least, so it is the most repeatable number.
+     */
+    template<typename Run>
+    double bestOf(int runs, Run &&run) {
+        double best = -1.0;
+        for (int i = 0; i < runs; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            run(i);
+            double seconds = secondsSince(start);
+            best = best < 0.0 ? seconds : std::min(best, seconds);
+        }
+        return best;
+    }
+
+    // Optional positional integer arguments, -h or --help prints "Usage: <program> <usage>" and exits.
+    class Arguments {
+        int argc;
+        char **argv;
+    public:
+        Arguments(int argc, char **argv, const char *usage) : argc(argc), argv(argv) {
+            if (argc > 1 && (std::strcmp(argv[1], "-h") == 0 || std::strcmp(argv[1], "--help") == 0)) {
+                std::cout << "Usage: " << argv[0] << ' ' << usage << '\n';
+                std::exit(0);
+            }
+        }
+
+        int get(int index, int fallback) const {
+            return index < argc ? std::atoi(argv[index]) : fallback;
+        }
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_BENCH_HPP
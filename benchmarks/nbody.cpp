@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <rg/NBody.hpp>
+#include <rg/JobSystem.hpp>
+
+#include "bench.hpp"
+
+// Steps per second and energy drift of the N-body belt on its own: the demo's belt and masses, but the
+// sun and planets are fixed attractors, so total energy should only oscillate.
+
+int main(int argc, char **argv) {
+    bench::Arguments arguments(argc, argv, "[particles] [steps] [threads]");
+    int particles = arguments.get(1, 20000);
+    int steps = arguments.get(2, 600);
+    int threads = arguments.get(3, -1);
+    const float dt = 1.0f / 60.0f;
+    const float sunMass = 270.0f;
+    const float particleMass = 1e-4f;
+
+    rg::JobSystem jobs(threads);
+    rg::NBody bodies;
+    bodies.attractors = {{glm::vec3(0.0f), sunMass}, {glm::vec3(0.0f, 0.0f, 60.0f), 2.0f},
+                         {glm::vec3(20.0f, 0.0f, 0.0f), 5.0f}};
+
+    // same ring AsteroidBelt::seedBodies puts on circular orbits
+    std::mt19937 random(1234u);
+    std::uniform_real_distribution<float> spread(-2.0f, 2.0f);
+    for (int i = 0; i < particles; ++i) {
+        float radius = 30.0f + spread(random);
+        float angle = 2.0f * (float) M_PI * (float) i / (float) particles;
+        float speed = std::sqrt(bodies.gravity * sunMass / radius);
+        bodies.addParticle(glm::vec3(radius * std::sin(angle), spread(random), radius * std::cos(angle)),
+                           glm::vec3(speed * std::cos(angle), 0.0f, -speed * std::sin(angle)), particleMass);
+    }
+
+    double initialEnergy = bodies.energy(jobs);
+    double maxDrift = 0.0;
+    double stepSeconds = 0.0;
+    for (int i = 0; i < steps; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        bodies.step(dt, jobs);
+        stepSeconds += bench::secondsSince(start);
+        // sampled outside the timing, the energy costs about as much as a step
+        if (i % 60 == 59 || i == steps - 1) {
+            double drift = (bodies.energy(jobs) - initialEnergy) / std::abs(initialEnergy);
+            maxDrift = std::max(maxDrift, std::abs(drift));
+        }
+    }
+    double finalDrift = (bodies.energy(jobs) - initialEnergy) / std::abs(initialEnergy);
+
+    std::cout << particles << " particles, " << steps << " steps of " << dt << " s on " << jobs.threadCount()
+              << " threads:\n"
+              << "  " << steps / stepSeconds << " steps/s, " << stepSeconds / steps * 1000.0 << " ms per step, "
+              << (double) particles * steps / stepSeconds / 1e6 << " M particle steps/s\n"
+              << "  energy drift: " << finalDrift * 100.0 << "% at the end, " << maxDrift * 100.0
+              << "% at most\n";
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <rg/ObjLoader.hpp>
+
+#include "bench.hpp"
+
+// Load time and peak memory of rg::loadObj against Assimp with the flags Model::loadModel uses, on the
+// .obj files given as arguments or, run from the repository root, on the sun and a generated ~100 MB file
+// with several material runs.
+
+namespace {
+    struct Result {
+        double milliseconds;
+        long peakKilobytes;
+    };
+
+    // Every loader runs in its own process so its peak resident size isn't hidden by the others.
+    Result measure(const std::function<bool()> &load, int runs) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            return {-1.0, -1};
+        }
+        pid_t child = fork();
+        if (child == 0) {
+            close(fds[0]);
+            bool loaded = true;
+            double best = bench::bestOf(runs, [&](int) {
+                loaded = load() && loaded;
+            }) * 1000.0;
+            if (!loaded) {
+                best = -1.0;
+            }
+            ssize_t written = write(fds[1], &best, sizeof(best));
+            _exit(written == sizeof(best) ? 0 : 1);
+        }
+        close(fds[1]);
+        double best = -1.0;
+        if (read(fds[0], &best, sizeof(best)) != sizeof(best)) {
+            best = -1.0;
+        }
+        close(fds[0]);
+        int status = 0;
+        rusage usage{};
+        wait4(child, &status, 0, &usage);
+        return {best, usage.ru_maxrss};
+    }
+
+    // Wavy grid of quads with positions, uvs and normals, switching between 8 materials every few rows.
+    bool writeSyntheticObj(const std::string &path, int size) {
+        std::ofstream obj(path);
+        std::ofstream mtl(path + ".mtl");
+        if (!obj || !mtl) {
+            return false;
+        }
+        for (int m = 0; m < 8; ++m) {
+            mtl << "newmtl material" << m << "\nKd 0.8 0.8 0.8\n";
+        }
+        std::string mtlName = path.substr(path.find_last_of('/') + 1) + ".mtl";
+        obj << "mtllib " << mtlName << '\n';
+        char line[128];
+        for (int i = 0; i <= size; ++i) {
+            for (int j = 0; j <= size; ++j) {
+                float x = (float) i / size;
+                float z = (float) j / size;
+                float y = 0.05f * std::sin(40.0f * x) * std::cos(40.0f * z);
+                std::snprintf(line, sizeof(line), "v %.6f %.6f %.6f\nvt %.6f %.6f\nvn 0.0 1.0 0.0\n", x, y, z, x, z);
+                obj << line;
+            }
+        }
+        int runRows = std::max(1, size / 32);
+        for (int i = 0; i < size; ++i) {
+            if (i % runRows == 0) {
+                obj << "usemtl material" << (i / runRows) % 8 << '\n';
+            }
+            for (int j = 0; j < size; ++j) {
+                int a = i * (size + 1) + j + 1;
+                int b = a + 1;
+                int c = a + size + 2;
+                int d = a + size + 1;
+                std::snprintf(line, sizeof(line), "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", a, a, a, b, b, b, c, c, c,
+                              d, d, d);
+                obj << line;
+            }
+        }
+        return (bool) obj;
+    }
+
+    void report(const char *loader, const Result &result) {
+        if (result.milliseconds < 0.0) {
+            std::cout << "  " << loader << ": failed to load\n";
+            return;
+        }
+        std::cout << "  " << loader << ": " << result.milliseconds << " ms, peak " << result.peakKilobytes / 1024
+                  << " MB\n";
+    }
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> paths(argv + 1, argv + argc);
+    // the generated file and its .mtl live in a directory of their own, removed before returning
+    std::string syntheticDirectory;
+    std::string synthetic;
+    if (paths.empty()) {
+        paths.emplace_back("resources/objects/sun/Sun.obj");
+        const char *tmp = std::getenv("TMPDIR");
+        std::string pattern = std::string(tmp && *tmp ? tmp : "/tmp") + "/obj_loader_benchmark.XXXXXX";
+        if (mkdtemp(&pattern[0])) {
+            syntheticDirectory = pattern;
+            synthetic = syntheticDirectory + "/synthetic_100mb.obj";
+        }
+        if (!synthetic.empty() && writeSyntheticObj(synthetic, 820)) {
+            paths.push_back(synthetic);
+        } else {
+            std::cerr << "Failed to write " << (synthetic.empty() ? pattern : synthetic) << '\n';
+        }
+    }
+
+    for (const std::string &path: paths) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            std::cerr << "Failed to open " << path << '\n';
+            continue;
+        }
+        double megabytes = (double) file.tellg() / (1 << 20);
+        // small files are loaded a few times for a stable number, large ones once
+        int runs = megabytes < 10.0 ? 10 : 1;
+        std::cout << path << " (" << megabytes << " MB), best of " << runs << ":\n";
+
+        report("rg::loadObj", measure([&]() {
+            rg::ObjData data;
+            return rg::loadObj(path, data);
+        }, runs));
+        report("rg::loadObj, 1 thread", measure([&]() {
+            rg::ObjData data;
+            return rg::loadObj(path, data, 1);
+        }, runs));
+        report("Assimp", measure([&]() {
+            Assimp::Importer importer;
+            const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals |
+                                                           aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+            return scene && !(scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE) && scene->mRootNode;
+        }, runs));
+    }
+
+    if (!syntheticDirectory.empty()) {
+        std::remove(synthetic.c_str());
+        std::remove((synthetic + ".mtl").c_str());
+        rmdir(syntheticDirectory.c_str());
+    }
+    return 0;
+}
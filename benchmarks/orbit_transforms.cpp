@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/OrbitTransforms.hpp>
+
+#include "bench.hpp"
+
+// Asteroid matrices per second on one thread for the glm::translate * glm::rotate loop AsteroidBelt used to
+// run and for each buildOrbitTransforms path, and how far each path is from glm.
+
+namespace {
+    using Build = std::function<void(float orbitAngle, float spinAngle, float *out)>;
+}
+
+int main(int argc, char **argv) {
+    bench::Arguments arguments(argc, argv, "[instances] [frames]");
+    int instances = arguments.get(1, 100000);
+    int frames = arguments.get(2, 100);
+
+    std::mt19937 random(1234u);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    rg::OrbitBatch batch;
+    std::vector<glm::vec3> orbits;
+    std::vector<glm::vec3> axes;
+    for (int i = 0; i < instances; ++i) {
+        orbits.emplace_back(30.0f + 2.0f * unit(random), 2.0f * unit(random), glm::radians(360.0f) * unit(random));
+        axes.push_back(glm::normalize(glm::vec3(unit(random), unit(random), unit(random))));
+        batch.add(orbits.back().x, orbits.back().y, orbits.back().z, axes.back());
+    }
+
+    struct Path {
+        const char *name;
+        Build build;
+    };
+    std::vector<Path> paths = {
+            {"glm", [&](float orbitAngle, float spinAngle, float *out) {
+                auto *matrices = (glm::mat4 *) out;
+                for (int i = 0; i < instances; ++i) {
+                    float angle = orbits[i].z + orbitAngle;
+                    glm::vec3 position(orbits[i].x * std::sin(angle), orbits[i].y, orbits[i].x * std::cos(angle));
+                    glm::mat4 model = glm::translate(glm::mat4(1.0f), position);
+                    matrices[i] = glm::rotate(model, spinAngle, axes[i]);
+                }
+            }},
+            {"scalar", [&](float orbitAngle, float spinAngle, float *out) {
+                rg::buildOrbitTransformsScalar(batch, orbitAngle, spinAngle, out, 0, batch.size());
+            }},
+    };
+#if defined(__x86_64__)
+    paths.push_back({"sse", [&](float orbitAngle, float spinAngle, float *out) {
+        rg::buildOrbitTransformsSSE(batch, orbitAngle, spinAngle, out, 0, batch.size());
+    }});
+    if (std::strcmp(rg::orbitTransformsBackend(), "avx2") == 0) {
+        paths.push_back({"avx2", [&](float orbitAngle, float spinAngle, float *out) {
+            rg::buildOrbitTransformsAVX2(batch, orbitAngle, spinAngle, out, 0, batch.size());
+        }});
+    } else {
+        std::cout << "No AVX2 and FMA on this CPU, skipping the avx2 path.\n";
+    }
+#endif
+
+    std::cout << instances << " instances, best of " << frames << " frames on one thread:\n";
+    std::vector<float> reference((size_t) instances * 16);
+    std::vector<float> out((size_t) instances * 16);
+    double glmSeconds = 0.0;
+    bool passed = true;
+    for (const Path &path: paths) {
+        std::vector<float> &target = glmSeconds == 0.0 ? reference : out;
+        double seconds = bench::bestOf(frames, [&](int i) {
+            path.build(std::fmod(0.01f * (float) i, 2.0f * (float) M_PI),
+                       std::fmod(0.05f * (float) i, 2.0f * (float) M_PI), target.data());
+        });
+        if (glmSeconds == 0.0) {
+            glmSeconds = seconds;
+        }
+        // the paths sum sin(phase + angle) from sine/cosine pairs, glm takes sin of the sum
+        float difference = 0.0f;
+        for (size_t i = 0; i < out.size(); ++i) {
+            difference = std::max(difference, std::abs(target[i] - reference[i]));
+        }
+        passed = passed && difference <= 1e-3f;
+        std::cout << "  " << path.name << ": " << seconds * 1000.0 << " ms per frame, " << instances / seconds / 1e6
+                  << " M matrices/s, " << glmSeconds / seconds << "x glm, max difference " << difference
+                  << (difference <= 1e-3f ? "\n" : ", FAILED\n");
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+#include <glm/glm.hpp>
+
+#include <rg/SceneGraph.hpp>
+
+#include "bench.hpp"
+
+// SceneGraph::update on a deep hierarchy (one chain) and a wide one (every node a child of the root), when
+// the root moves, when one leaf moves and when nothing does.
+
+namespace {
+    // average update() time in ms after change() each round, and how many matrices the last one recomputed
+    void measure(const char *name, rg::SceneGraph &scene, int updates, const std::function<void(int)> &change) {
+        scene.update();
+        double seconds = 0.0;
+        for (int i = 0; i < updates; ++i) {
+            change(i);
+            auto start = std::chrono::steady_clock::now();
+            scene.update();
+            seconds += bench::secondsSince(start);
+        }
+        std::cout << "    " << name << ": " << seconds / updates * 1000.0 << " ms per update, "
+                  << scene.lastUpdateCount() << " matrices\n";
+    }
+
+    bool close(const glm::vec3 &a, const glm::vec3 &b, float tolerance) {
+        return glm::length(a - b) <= tolerance;
+    }
+}
+
+int main(int argc, char **argv) {
+    bench::Arguments arguments(argc, argv, "[nodes] [updates]");
+    int nodes = arguments.get(1, 100000);
+    int updates = arguments.get(2, 100);
+    const glm::vec3 step(1e-3f, 0.0f, 0.0f);
+    bool passed = true;
+
+    rg::SceneGraph deep;
+    int parent = deep.addNode();
+    for (int i = 1; i < nodes; ++i) {
+        parent = deep.addNode(parent);
+        deep.setTranslation(parent, step);
+    }
+    const int deepLeaf = parent;
+
+    rg::SceneGraph wide;
+    const int root = wide.addNode();
+    for (int i = 1; i < nodes; ++i) {
+        wide.setTranslation(wide.addNode(root), step * (float) i);
+    }
+    const int wideLeaf = nodes - 1;
+
+    std::cout << nodes << " nodes, " << updates << " updates each:\n";
+    for (rg::SceneGraph *scene: {&deep, &wide}) {
+        int leaf = scene == &deep ? deepLeaf : wideLeaf;
+        std::cout << "  " << (scene == &deep ? "deep" : "wide") << ":\n";
+        measure("root moves", *scene, updates, [&](int i) {
+            scene->setTranslation(0, glm::vec3(0.0f, (float) i, 0.0f));
+        });
+        // both end with the leaf (nodes - 1) steps from the root
+        glm::vec3 expected = glm::vec3(0.0f, (float) (updates - 1), 0.0f) + step * (float) (nodes - 1);
+        glm::vec3 position = scene->worldPosition(leaf);
+        // a long chain of float matrix products drifts a little
+        if (!close(position, expected, 1e-3f * glm::length(expected))) {
+            std::cout << "Leaf at (" << position.x << ", " << position.y << ", " << position.z << "), expected ("
+                      << expected.x << ", " << expected.y << ", " << expected.z << ")\n";
+            passed = false;
+        }
+        measure("one leaf moves", *scene, updates, [&](int) {
+            scene->setTranslation(leaf, scene->translation(leaf));
+        });
+        measure("nothing moves", *scene, updates, [](int) {});
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rg/World.hpp>
+#include <rg/Components.hpp>
+#include <rg/JobSystem.hpp>
+
+#include "bench.hpp"
+
+// Iterating 1M entities with an Orbit and a Motion, spread over four archetypes, the way orbitSystem does:
+// World::each on one thread and on the job system, World::get per entity, and a plain array of structs
+// holding the same components for comparison.
+
+namespace {
+    // one orbitSystem step
+    inline void move(const rg::Orbit &orbit, rg::Motion &motion, float time) {
+        float angle = orbit.phase + time * orbit.speed;
+        motion.previous = motion.current;
+        motion.current = glm::vec3(orbit.radius * std::sin(angle), 0.0f, orbit.radius * std::cos(angle));
+    }
+}
+
+int main(int argc, char **argv) {
+    bench::Arguments arguments(argc, argv, "[entities] [passes] [threads]");
+    int count = arguments.get(1, 1000000);
+    int passes = arguments.get(2, 20);
+    int threads = arguments.get(3, -1);
+    rg::JobSystem jobs(threads);
+
+    struct Object {
+        rg::Orbit orbit;
+        rg::Motion motion;
+        rg::Gravity gravity;
+        rg::Occluder occluder;
+    };
+    std::vector<Object> objects(count);
+    std::vector<rg::Entity> entities(count);
+    rg::World world;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        Object &o = objects[i];
+        o.orbit = {10.0f + (float) (i % 1000) * 0.1f, 0.1f + (float) (i % 7) * 0.01f, (float) i * 1e-3f};
+        o.motion = {glm::vec3(0.0f), glm::vec3(0.0f)};
+        o.gravity = {1.0f};
+        o.occluder = {0.5f};
+        // half of them attractors and half occluders, in every combination
+        if (i % 4 == 0) {
+            entities[i] = world.create(o.orbit, o.motion, o.gravity, o.occluder);
+        } else if (i % 2 == 0) {
+            entities[i] = world.create(o.orbit, o.motion, o.gravity);
+        } else if (i % 4 == 1) {
+            entities[i] = world.create(o.orbit, o.motion, o.occluder);
+        } else {
+            entities[i] = world.create(o.orbit, o.motion);
+        }
+    }
+    double createSeconds = bench::secondsSince(start);
+
+    struct Path {
+        const char *name;
+        std::function<void(float)> pass;
+    };
+    const Path paths[] = {
+            {"array of structs", [&](float time) {
+                for (Object &o: objects) {
+                    move(o.orbit, o.motion, time);
+                }
+            }},
+            {"World::each", [&](float time) {
+                world.each<rg::Orbit, rg::Motion>([time](rg::Entity, rg::Orbit &orbit, rg::Motion &motion) {
+                    move(orbit, motion, time);
+                });
+            }},
+            {"World::each, job system", [&](float time) {
+                world.each<rg::Orbit, rg::Motion>(jobs, 4096, [time](rg::Entity, rg::Orbit &orbit,
+                                                                     rg::Motion &motion) {
+                    move(orbit, motion, time);
+                });
+            }},
+            {"World::get per entity", [&](float time) {
+                for (rg::Entity e: entities) {
+                    move(*world.get<rg::Orbit>(e), *world.get<rg::Motion>(e), time);
+                }
+            }},
+    };
+
+    std::cout << count << " entities in 4 archetypes, created in " << createSeconds * 1000.0 << " ms, best of "
+              << passes << " passes, " << jobs.threadCount() << " threads for the job system:\n";
+    bool passed = true;
+    for (const Path &path: paths) {
+        double seconds = bench::bestOf(passes, [&](int i) {
+            path.pass(0.01f * (float) i);
+        });
+        std::cout << "  " << path.name << ": " << seconds * 1000.0 << " ms per pass, " << count / seconds / 1e6
+                  << " M entities/s\n";
+    }
+    // every path ran the same times last, so the world must match the array
+    for (int i = 0; i < count; ++i) {
+        if (world.get<rg::Motion>(entities[i])->current != objects[i].motion.current) {
+            std::cout << "Entity " << entities[i] << " moved differently from the array\n";
+            passed = false;
+            break;
+        }
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_ANTIALIASING_HPP
+#define MATF_RG_PROJEKAT_ANTIALIASING_HPP
+
+#include <cstddef>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/Camera.hpp>
+#include <rg/GpuQuery.hpp>
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    /**
+     * Anti-aliasing of the HDR scene pass, one of:
+     *
+     * MSAA - the scene renders into multisampled copies of the scene targets, msaa_resolve.fs averages the
+     * samples back into the single sampled ones. Colour samples are weighted by 1 / (1 + luminance) so an edge
+     * against the sun doesn't resolve to a fringe the tonemapper blows out again.
+     *
+     * TAA - the projection is jittered along a Halton(2, 3) sequence and taa.fs blends every frame into an
+     * accumulated history. Motion vectors come from depth and the camera matrices of this and the last frame,
+     * objects moving on their own are covered by clamping the history to the current 3x3 neighbourhood.
+     *
+     * Targets of a mode are created the first time it is used and show up in rg::renderTargets.
+     */
+    class AntiAliasing {
+    public:
+        enum class Mode {
+            None,
+            MSAA,
+            TAA
+        };
+
+        // sceneFBO renders into sceneTexture (attachment 0, HDR colour) and a bright pass (attachment 1),
+        // depthTexture is its depth attachment.
+        AntiAliasing(int width, int height, unsigned int sceneFBO, unsigned int sceneTexture,
+                     unsigned int depthTexture, unsigned int quadVAO, ShaderLibrary &shaders);
+
+        Mode mode = Mode::None;
+        // MSAA sample count, clamped to GL_MAX_SAMPLES and fixed once the targets exist.
+        int samples = 4;
+        // Weight of the new frame in the history, lower is smoother and slower to react.
+        float blendFactor = 0.1f;
+        // Halton points before the sequence repeats.
+        int jitterPhases = 8;
+
+        static const char *name(Mode mode);
+
+        // Render into the bottom left width x height of the targets only (rg::DynamicResolution). A different
+        // size starts the TAA history over.
+        void setRenderSize(int width, int height);
+
+        // Start a frame: the projection the scene has to render with, jittered under TAA.
+        glm::mat4 beginFrame(const Camera &camera, float aspect);
+
+        // Framebuffer the scene pass draws into.
+        unsigned int framebuffer() const;
+
+        // Resolve this frame's scene; returns the texture holding the anti-aliased HDR colour. The bright pass
+        // stays in sceneFBO's attachment 1 (resolved there under MSAA).
+        unsigned int resolve();
+
+        // Start the history over, for cuts and mode switches.
+        void resetHistory();
+
+        // Sub-pixel offset of this frame in pixels, zero unless TAA.
+        glm::vec2 jitter() const;
+
+        double resolveMilliseconds() const;
+
+        // Extra target memory of the current mode.
+        size_t memoryUsage() const;
+
+    private:
+        int width;
+        int height;
+        int renderWidth;
+        int renderHeight;
+        unsigned int sceneFBO;
+        unsigned int sceneTexture;
+        unsigned int depthTexture;
+        unsigned int quadVAO;
+        ShaderLibrary &shaders;
+        GpuQuery timer;
+
+        unsigned int msaaFBO{};
+        unsigned int msaaTextures[2]{};
+        unsigned int msaaDepth{};
+        int msaaSamples = 0; // of the allocated targets, 0 before the first MSAA frame
+
+        unsigned int historyFBOs[2]{};
+        unsigned int historyTextures[2]{};
+        int current = 0; // history written this frame
+        bool historyValid = false;
+        Mode lastMode = Mode::None;
+
+        long long frame = 0;
+        glm::vec2 offset{0.0f};
+        glm::mat4 unjitteredViewProjection{1.0f};
+        glm::mat4 previousViewProjection{1.0f}; // last frame's, without jitter
+
+        void createMultisampled();
+
+        void createHistory();
+
+        void drawQuad() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_ANTIALIASING_HPP
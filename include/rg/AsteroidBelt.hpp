@@ -0,0 +1,161 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_ASTEROIDBELT_HPP
+#define MATF_RG_PROJEKAT_ASTEROIDBELT_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/OrbitTransforms.hpp>
+#include <rg/JobSystem.hpp>
+#include <rg/NBody.hpp>
+#include <rg/OcclusionBuffer.hpp>
+#include <rg/StreamBuffer.hpp>
+
+namespace rg {
+
+    /**
+     * Ring of asteroids orbiting the origin and spinning around their own random axis.
+     *
+     * Orbital parameters are stored per instance so the belt can either be animated on the CPU
+     * (updateMatrices, SIMD batch into a per instance mat4 buffer) or entirely in asteroid_belt.vs
+     * from a single time uniform.
+     *
+     * With an rg::OcclusionBuffer the update functions drop hidden asteroids and stream the rest
+     * compacted, static per instance attributes included, so the instanced draw only covers survivors.
+     */
+    class AsteroidBelt {
+        unsigned int instanceVBO{};
+        unsigned int variantVBO{};
+        unsigned int VAO{};
+        unsigned int allInstancesVAO{};
+        unsigned int allMatricesVAO{};
+        OrbitBatch batch;
+        int visibleInstances;
+        // matrices are built here first when culling, the stream only gets the visible ones
+        std::vector<glm::mat4> matrices;
+        std::vector<unsigned char> visible;
+        // the last updateMatrices streamed only the visible matrices
+        bool matricesCulled = false;
+
+        glm::mat4 *mapMatrices(StreamBuffer &stream, GLintptr &offset) const;
+
+        // Point attributes 5-8 at this frame's matrices and 3, 4 and 9 back at the static buffers.
+        void bindMatrices(const StreamBuffer &stream, GLintptr offset);
+
+        // Point attributes 3-9 at this frame's CulledInstance records.
+        void bindCulled(const StreamBuffer &stream, GLintptr offset) const;
+
+        // Test matrices against the occluders and stream the visible instances.
+        void streamVisible(const OcclusionBuffer &culler, JobSystem &jobs, StreamBuffer &stream);
+
+        // Point attributes 3, 4 and 9 at this frame's OrbitInstance records.
+        void bindOrbits(const StreamBuffer &stream, GLintptr offset) const;
+    public:
+        // Everything the belt shaders read per instance, streamed when culling.
+        struct CulledInstance {
+            glm::mat4 model;
+            glm::vec3 orbit;
+            int variant;
+            glm::vec3 axis;
+            float padding;
+        };
+
+        // What asteroid_belt.vs reads per instance, streamed when the GPU animated belt is culled.
+        struct OrbitInstance {
+            glm::vec3 orbit;
+            int variant;
+            glm::vec3 axis;
+            float padding;
+        };
+
+        // x - orbit radius, y - height above the orbital plane, z - phase (radians)
+        std::vector<glm::vec3> orbits;
+        // normalized spin axes
+        std::vector<glm::vec3> axes;
+        // index into rg::AsteroidMeshes, assigned in setupInstancing
+        std::vector<int> variants;
+
+        float orbitSpeed = 0.1f; // radians per second
+        float spinSpeed = 20.0f; // degrees per second
+        float boundingRadius = 1.0f; // of the largest mesh variant, used for culling
+
+        AsteroidBelt(int count, float radius, float spread);
+
+        int size() const;
+
+        // Instances the next drawInstanced covers, all of them unless culled.
+        int visibleCount() const;
+
+        // Largest stream allocation one frame of updates and drawAllMatrices makes for count asteroids.
+        static size_t frameBytes(int count);
+
+        // Orbit and spin angles (radians) at the given time, wrapped to one turn so they stay precise
+        // in float after long running sessions.
+        glm::vec2 angles(double time) const;
+
+        // CPU reference for what asteroid_belt.vs computes.
+        glm::mat4 modelMatrix(int i, double time) const;
+
+        /**
+         * Upload orbital parameters and attach them to the mesh VAO as per instance attributes
+         * 3 (orbit) and 4 (axis) and a random mesh variant as integer attribute 9. Model matrices
+         * (attributes 5-8) are streamed every frame by updateMatrices.
+         */
+        void setupInstancing(unsigned int meshVAO, int variantCount);
+
+        /**
+         * Rebuild all model matrices for the given time straight into this frame's region of the stream
+         * buffer, split across the job system workers. With a culler only visible instances are streamed.
+         */
+        void updateMatrices(double time, JobSystem &jobs, StreamBuffer &stream,
+                            const OcclusionBuffer *culler = nullptr);
+
+        /**
+         * Mark the asteroids whose bounding spheres pass the culler at the given time and return how many
+         * did. Only the orbit centers are computed, the spin doesn't move them. Needs no GL context.
+         */
+        int cullOrbits(double time, JobSystem &jobs, const OcclusionBuffer &culler);
+
+        // Per asteroid result of the last cull, 1 if visible.
+        const std::vector<unsigned char> &visibility() const;
+
+        /**
+         * For the GPU animated belt: cull by orbit centers and stream the visible asteroids' orbit, axis
+         * and variant for asteroid_belt.vs. No matrices are built.
+         */
+        void updateVisible(double time, JobSystem &jobs, StreamBuffer &stream, const OcclusionBuffer &culler);
+
+        /**
+         * Replace the particles in bodies with the belt as it is at the given time, each asteroid moving
+         * with circular orbit speed around a central mass at the origin.
+         */
+        void seedBodies(NBody &bodies, double time, float centralMass, float particleMass) const;
+
+        // Same as updateMatrices, but translations come from the N-body particles.
+        void updateMatrices(const NBody &bodies, double time, JobSystem &jobs, StreamBuffer &stream,
+                            const OcclusionBuffer *culler = nullptr);
+
+        // For the unculled GPU animated belt, draw every instance from the static attributes.
+        void useStaticInstances();
+
+        void drawInstanced(GLsizei indexCount) const;
+
+        // Every asteroid from the static attributes, culled or not, for asteroid_belt.vs passes that don't
+        // look through the camera (shadows).
+        void drawAllInstanced(GLsizei indexCount) const;
+
+        /**
+         * Every asteroid with the matrices of the last updateMatrices, culled or not, for asteroid.vs passes
+         * that don't look through the camera (shadows). A culled update only streamed the visible ones, then
+         * the rest are streamed here.
+         */
+        void drawAllMatrices(StreamBuffer &stream, GLsizei indexCount);
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_ASTEROIDBELT_HPP
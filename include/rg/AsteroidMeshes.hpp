@@ -0,0 +1,75 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_ASTEROIDMESHES_HPP
+#define MATF_RG_PROJEKAT_ASTEROIDMESHES_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/JobSystem.hpp>
+
+namespace rg {
+
+    // Two RGBA32F texels when read back through the vertex buffer texture.
+    struct AsteroidVertex {
+        glm::vec3 position;
+        glm::vec2 texCoords;
+        glm::vec3 normal;
+    };
+
+    /**
+     * Pool of procedurally generated asteroid meshes: icospheres displaced by fractal value noise.
+     *
+     * Every variant has the same topology, so all of them share one index buffer and are packed back to
+     * back into one vertex buffer, variant v starting at baseVertex(v). Single variants can be drawn with
+     * glDrawElementsBaseVertex, instanced draws pick the variant per instance in the vertex shader by
+     * fetching from vertexTexture() (the same buffer exposed as a samplerBuffer), since GL 3.3 has no
+     * per instance base vertex.
+     */
+    class AsteroidMeshes {
+        unsigned int VAO{};
+        unsigned int VBO{};
+        unsigned int EBO{};
+        unsigned int TBO{};
+        int variantCount;
+        int verticesPerVariant = 0;
+    public:
+        std::vector<AsteroidVertex> vertices;
+        std::vector<unsigned int> indices;
+
+        // Generation is split across the job system, one variant per job range. Radius is 0.5 before
+        // displacement, same as the old octahedron.
+        AsteroidMeshes(int variants, int subdivisions, unsigned int seed, JobSystem &jobs);
+
+        int variants() const;
+
+        int vertexCount() const;
+
+        GLsizei indexCount() const;
+
+        GLint baseVertex(int variant) const;
+
+        // Farthest vertex from the origin over all variants.
+        float boundingRadius() const;
+
+        // Bytes of vertex and index data on the GPU.
+        size_t memoryUsage() const;
+
+        /**
+         * Create the shared VBO/EBO, a VAO with attributes 0 (position), 1 (uv) and 2 (normal), and a
+         * GL_TEXTURE_BUFFER over the VBO. Variants past GL_MAX_TEXTURE_BUFFER_SIZE are dropped with a
+         * warning, so read variants() after this.
+         */
+        void setupMesh();
+
+        unsigned int vao() const;
+
+        unsigned int vertexTexture() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_ASTEROIDMESHES_HPP
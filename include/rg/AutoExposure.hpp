@@ -0,0 +1,86 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_AUTOEXPOSURE_HPP
+#define MATF_RG_PROJEKAT_AUTOEXPOSURE_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/GpuQuery.hpp>
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    /**
+     * Exposure that follows the scene brightness.
+     *
+     * meter() draws the log luminance of the HDR scene into a small RG16F target (luminance.fs) and lets
+     * glGenerateMipmap average it down to one texel, which is read into a pixel pack buffer with a fence.
+     * update() only maps a buffer once its fence has signalled, so the CPU never waits for the GPU and the
+     * exposure is a couple of frames behind the image, hidden by the smooth adaptation anyway.
+     */
+    class AutoExposure {
+        static const int ringSize = 3;
+
+        int width;
+        int height;
+        int levels;
+        glm::vec2 uvScale{1.0f};
+        unsigned int quadVAO;
+        unsigned int meteringTexture{};
+        unsigned int meteringFBO{};
+        unsigned int readFBO{}; // the 1x1 mip level
+        unsigned int pixelBuffers[ringSize]{};
+        GLsync fences[ringSize]{};
+        long long issuedFrame[ringSize]{};
+        int next = 0;
+        long long frame = 0;
+        float averageLuminance = -1.0f; // none read back yet
+        GpuQuery timer;
+        ShaderLibrary &shaders;
+
+        void poll();
+
+    public:
+        // Mid grey the log average luminance is mapped to.
+        float key = 0.18f;
+        float minExposure = 0.05f;
+        float maxExposure = 8.0f;
+        // Fraction of the remaining log exposure difference closed per second is 1 - exp(-speed).
+        float adaptationSpeed = 1.5f;
+        // Darker pixels don't count (space), brighter ones are clamped so the sun doesn't dominate.
+        float minLuminance = 1.0e-3f;
+        float maxLuminance = 10.0f;
+
+        struct Stats {
+            long long readbacks = 0;
+            long long notReady = 0; // polls that found the oldest readback still in flight
+            long long skipped = 0; // frames not metered because every pixel buffer was still in flight
+            long long latencyFrames = 0; // of the last readback
+            double maxReadbackMilliseconds = 0.0; // CPU time of glReadPixels into a buffer plus the map
+        };
+
+        // Metering runs at a fifth of the scene size.
+        AutoExposure(int sceneWidth, int sceneHeight, unsigned int quadVAO, ShaderLibrary &shaders);
+
+        // The scene only covers the bottom left width x height of its target (rg::DynamicResolution).
+        void setRenderSize(int width, int height);
+
+        // Meter the HDR scene and start reading the result back.
+        void meter(unsigned int scene);
+
+        // Collect finished readbacks and move exposure towards the target for the latest luminance.
+        float update(float exposure, float deltaTime);
+
+        // Log average luminance of the lit pixels from the latest readback, -1 before the first one.
+        float luminance() const;
+
+        double meteringMilliseconds() const;
+
+        Stats stats;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_AUTOEXPOSURE_HPP
@@ -0,0 +1,90 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_BLUR_HPP
+#define MATF_RG_PROJEKAT_BLUR_HPP
+
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    /**
+     * Separable Gaussian blur of arbitrary radius with its own pair of ping-pong targets.
+     *
+     * Kernels are generated at runtime. With linear sampling neighbouring taps are folded into one
+     * bilinear fetch between them, so a kernel of radius r costs 1 + 2 * ceil(r / 2) fetches instead
+     * of 1 + 2 * r. Large radii are split into several horizontal + vertical iterations, since n passes
+     * of sigma s add up to sigma s * sqrt(n). Horizontal and vertical passes are separate rg::ShaderLibrary
+     * variants of blur.fs (or blur.comp) per tap count.
+     */
+    class Blur {
+        int targetWidth;
+        int targetHeight;
+        int renderWidth;
+        int renderHeight;
+        unsigned int quadVAO;
+        unsigned int framebuffers[2]{};
+        unsigned int textures[2]{};
+        ShaderLibrary &shaders;
+
+        const Shader &program(int taps, bool horizontal, bool computeShader);
+
+        void pass(const Shader &shader, const std::vector<float> &offsets, const std::vector<float> &weights,
+                  unsigned int source, int target);
+
+        void computePass(const Shader &shader, const std::vector<float> &weights, unsigned int source, int target,
+                         bool horizontal);
+
+    public:
+        // Taps of one side including the center, the other side mirrors them.
+        struct Kernel {
+            std::vector<float> offsets; // in texels
+            std::vector<float> weights;
+
+            // Texture fetches per pixel and pass.
+            int fetches() const;
+        };
+
+        // Widest kernel a single pass uses, wider blurs take more iterations.
+        int maxPassRadius = 16;
+        bool linearSampling = true;
+        // Run the passes as blur.comp dispatches, a tile and its apron go through shared memory so every texel
+        // is fetched once per group. Needs glext.computeShaders and a source of the blur's size.
+        bool compute = false;
+
+        // Targets are R11F_G11F_B10F, the blur runs at their size whatever the source size is.
+        Blur(int width, int height, unsigned int quadVAO, ShaderLibrary &shaders);
+
+        /**
+         * Only blur the bottom left width x height of the targets, reading the same region of a source of the
+         * blur's size (rg::DynamicResolution). Taps past the region are clamped to its edge.
+         */
+        void setRenderSize(int width, int height);
+
+        /**
+         * Normalized Gaussian of the given sigma truncated at radius texels. With linear sampling taps
+         * 2k - 1 and 2k are merged into one at their weighted average offset.
+         */
+        static Kernel gaussianKernel(float sigma, int radius, bool linearSampling);
+
+        // Iterations and per pass sigma that make up a Gaussian reaching radius texels (3 sigma).
+        std::pair<int, float> iterationsFor(float radius) const;
+
+        // Blur source, returns the texture holding the result, one of the blur's own targets.
+        unsigned int apply(unsigned int source, float radius);
+
+        /**
+         * Time apply at each radius with and without linear sampling (and as compute when available) and log
+         * milliseconds per pass with the effective bandwidth, one read and write of the 4 byte texel.
+         */
+        void benchmark(unsigned int source, const std::vector<float> &radii);
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_BLUR_HPP
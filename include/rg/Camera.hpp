@@ -40,6 +40,9 @@ namespace rg {
 
         glm::mat4 getPerspectiveMatrix(float aspect) const;
 
+        // Same projection with the image shifted by jitter pixels of a viewportSize target, for temporal AA.
+        glm::mat4 getPerspectiveMatrix(float aspect, const glm::vec2 &jitter, const glm::vec2 &viewportSize) const;
+
         void move(Direction direction, float deltaTime);
 
         void rotate(float xoffset, float yoffset, bool constrainPitch);
@@ -0,0 +1,62 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_COMPONENTS_HPP
+#define MATF_RG_PROJEKAT_COMPONENTS_HPP
+
+#include <glm/glm.hpp>
+
+#include <rg/light.hpp>
+
+namespace rg {
+    class Model;
+
+    class Shader;
+
+    // Placement of an entity, node is its rg::SceneGraph node.
+    struct Transform {
+        int node;
+    };
+
+    // Circular orbit around the parent scene node, in its xz plane.
+    struct Orbit {
+        float radius;
+        float speed; // radians per second
+        float phase;
+    };
+
+    // Last two fixed step positions, rendering interpolates between them.
+    struct Motion {
+        glm::vec3 previous;
+        glm::vec3 current;
+    };
+
+    // Mass pulling on the N-body asteroids, G is folded into it.
+    struct Gravity {
+        float mass;
+    };
+
+    // Flat color instead of lighting, what sun.fs outputs.
+    struct Emissive {
+        glm::vec3 color;
+    };
+
+    // Sphere inside the entity's model (in model space) that hides asteroids behind it.
+    struct Occluder {
+        float radius;
+    };
+
+    // depthShader draws the model in the depth pre-pass, it must share the vertex shader with shader.
+    struct Renderable {
+        Model *model;
+        Shader *shader;
+        Shader *depthShader;
+    };
+
+    struct Light {
+        PointLight point;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_COMPONENTS_HPP
@@ -0,0 +1,67 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_COMPOSITOR_HPP
+#define MATF_RG_PROJEKAT_COMPOSITOR_HPP
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    /**
+     * Final fragment passes: bloom add, tonemap, gamma and the screen effect, drawn to the default framebuffer.
+     *
+     * Every combination of effect, hdr and bloom is its own rg::ShaderLibrary variant of hdr.fs / screen.fs
+     * instead of branching on uniforms. Per pixel effects (none, grayscale) are fused into the resolve and take a single
+     * pass. Kernel effects (edge detection, sharpen) need tonemapped neighbours, only they resolve into the
+     * intermediate target and run screen.fs over it.
+     *
+     * With a render size below the target size (rg::DynamicResolution) the last pass stretches the rendered
+     * region to the window, bilinear, and with sharpen on that pass is a sharpening screen.fs.
+     */
+    class Compositor {
+        int width;
+        int height;
+        int renderWidth;
+        int renderHeight;
+        unsigned int quadVAO;
+        unsigned int intermediateFBO{};
+        unsigned int intermediateTexture{};
+        ShaderLibrary &shaders;
+
+        void drawQuad() const;
+
+    public:
+        // Sharpen the upscale from a reduced render size, amount in [0, 1].
+        bool sharpen = true;
+        float sharpness = 0.5f;
+
+        Compositor(int width, int height, unsigned int quadVAO, ShaderLibrary &shaders);
+
+        // Scene and bloom only cover the bottom left width x height of their targets.
+        void setRenderSize(int width, int height);
+
+        // Feature keys of the resolve pass, shared with rg::ComputeComposite.
+        static std::vector<std::string> features(int effect, bool hdr, bool bloom);
+
+        // Effects that sample neighbouring tonemapped pixels and so cost a second pass.
+        static bool needsNeighbours(int effect);
+
+        // Full screen passes apply takes for the effect at the current render size.
+        int passes(int effect) const;
+
+        // Bytes read and written by apply, for bandwidth estimates.
+        size_t bytesPerFrame(int effect) const;
+
+        // effect: 0 - none, 1 - grayscale, 2 - edge detection, 3 - sharpen
+        void apply(unsigned int scene, unsigned int bloomTexture, bool hdr, bool bloom, float exposure, int effect);
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_COMPOSITOR_HPP
@@ -0,0 +1,50 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_COMPUTECOMPOSITE_HPP
+#define MATF_RG_PROJEKAT_COMPUTECOMPOSITE_HPP
+
+#include <string>
+
+#include <glad/glad.h>
+
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    /**
+     * Bloom composite, tonemap and screen effect fused into one post.comp dispatch, the compute counterpart
+     * of the hdr.fs + screen.fs passes. Writes an RGBA8 image that present blits to the default framebuffer,
+     * so the intermediate RGBA8 screen target is neither written nor read. Like rg::Compositor there is a
+     * variant per effect, hdr and bloom, only kernel effects load a halo into shared memory. Needs glext.computeShaders.
+     */
+    class ComputeComposite {
+        int width;
+        int height;
+        int renderWidth;
+        int renderHeight;
+        unsigned int outputTexture{};
+        unsigned int outputFBO{};
+        std::string haloX;
+        std::string haloY;
+        ShaderLibrary &shaders;
+
+    public:
+        ComputeComposite(int width, int height, ShaderLibrary &shaders);
+
+        // Only the bottom left width x height of scene and bloom was rendered, present stretches it (bilinear).
+        void setRenderSize(int width, int height);
+
+        // scene and bloom have to be width x height, effect as in screen.fs.
+        void apply(unsigned int scene, unsigned int bloomTexture, bool hdr, bool bloom, float exposure, int effect);
+
+        // Copy the result to the default framebuffer, scaled to the current viewport.
+        void present() const;
+
+        // Bytes read and written by apply, for bandwidth estimates.
+        size_t bytesPerFrame() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_COMPUTECOMPOSITE_HPP
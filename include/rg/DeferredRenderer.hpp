@@ -0,0 +1,79 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_DEFERREDRENDERER_HPP
+#define MATF_RG_PROJEKAT_DEFERREDRENDERER_HPP
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/GpuQuery.hpp>
+#include <rg/LocalLights.hpp>
+#include <rg/ShaderLibrary.hpp>
+#include <rg/ShadowMap.hpp>
+#include <rg/light.hpp>
+
+namespace rg {
+
+    /**
+     * Deferred alternative to shading the lit bodies in lit.fs.
+     *
+     * The geometry pass writes a compact G-buffer through gbuffer.fs: albedo and specular intensity in RGBA8,
+     * an octahedral normal in RG16F and the scene depth, positions are rebuilt from depth. Lighting then
+     * writes the scene target of the forward path: a full-screen pass for the sun and the spot light, and one
+     * instanced sphere per rg::LocalLights light (back faces, so the camera may be inside) that only shades
+     * the pixels it covers. A pixel costs its number of lights instead of every light times the overdraw.
+     * The bright pass is thresholded from the finished sum, bloom and HDR take it from there unchanged.
+     */
+    class DeferredRenderer {
+        int width;
+        int height;
+        int renderWidth;
+        int renderHeight;
+        unsigned int depthTexture;
+        unsigned int sceneTexture;
+        unsigned int brightTexture;
+        unsigned int quadVAO;
+        unsigned int gBufferFBO{};
+        unsigned int gBufferTextures[2]{};
+        unsigned int lightFBO{};
+        unsigned int brightFBO{};
+        unsigned int sphereVAO{};
+        unsigned int sphereBuffers[2]{};
+        GLsizei sphereIndexCount = 0;
+        GpuQuery timer;
+        ShaderLibrary &shaders;
+
+        void create();
+
+        void createSphere();
+
+        void drawQuad() const;
+
+    public:
+        // Targets of the forward path the deferred one reads and writes: scene depth, scene and bright pass.
+        DeferredRenderer(int width, int height, unsigned int depthTexture, unsigned int sceneTexture,
+                         unsigned int brightTexture, unsigned int quadVAO, ShaderLibrary &shaders);
+
+        // Rendered region, see rg::DynamicResolution.
+        void setRenderSize(int width, int height);
+
+        // G-buffer for the geometry pass, created on first use. Its depth is the scene depth.
+        unsigned int framebuffer();
+
+        /**
+         * Light the G-buffer into the scene target and extract the bright pass. spotLight and shadowMap may be
+         * null, view and projection must be the ones the G-buffer was drawn with (jitter included).
+         */
+        void light(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &viewPos, const PointLight &sun,
+                   const SpotLight *spotLight, const ShadowMap *shadowMap, const LocalLights &localLights);
+
+        double lightingMilliseconds() const;
+
+        // G-buffer colour targets, 0 until first used.
+        size_t memoryUsage() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_DEFERREDRENDERER_HPP
@@ -0,0 +1,104 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_DYNAMICRESOLUTION_HPP
+#define MATF_RG_PROJEKAT_DYNAMICRESOLUTION_HPP
+
+#include <ostream>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+namespace rg {
+
+    /**
+     * Render scale that keeps the GPU frame time under a budget.
+     *
+     * The scene and post targets stay allocated at full size, a frame only renders into the bottom left
+     * width() x height() of them and the last pass stretches that to the window. GPU time of a frame is
+     * taken with a pair of timestamps read back a few frames later (no stalls, a frame whose slot isn't
+     * done yet goes unmeasured), smoothed, and since most of the cost is per pixel the scale moves by
+     * sqrt(budget / time), a limited step at a time. After a change the controller waits until frames
+     * rendered at the new scale are the ones being measured.
+     */
+    class DynamicResolution {
+        static const int ringSize = 4;
+
+        int maxWidth;
+        int maxHeight;
+        unsigned int queries[ringSize][2]{};
+        bool pending[ringSize]{};
+        bool measuring = false; // beginFrame issued this frame's first timestamp
+        int frame = 0;
+        float currentScale = 1.0f;
+        double filteredMilliseconds = -1.0; // none measured yet
+        int settleFrames = 0;
+        int spikeFrames = 0;
+        double spikeMilliseconds = 0.0;
+        int traceFrames = 0;
+
+    public:
+        struct Sample {
+            long long frame;
+            double gpuMilliseconds; // measured, synthetic load included
+            double filteredMilliseconds;
+            float scale;
+        };
+
+        bool enabled = true;
+        float targetMilliseconds = 1000.0f / 60.0f;
+        // Aim this far under the budget, measurements are noisy and a frame over it is a missed vsync.
+        float headroom = 0.85f;
+        float minScale = 0.5f;
+        float maxScale = 1.0f;
+        // Largest scale change per adjustment.
+        float maxStep = 0.05f;
+        // Weight of a new measurement in the smoothed frame time.
+        float smoothing = 0.25f;
+        // Changes smaller than this are not worth a different render size.
+        float deadband = 0.01f;
+
+        // Frames traced after the last spike, see injectSpike.
+        std::vector<Sample> trace;
+
+        DynamicResolution(int maxWidth, int maxHeight);
+
+        // Timestamps around everything the GPU does for a frame, the first call creates the queries.
+        void beginFrame();
+
+        void endFrame();
+
+        /**
+         * Take one frame's GPU time and move the scale, returns the new scale. endFrame feeds it the
+         * timestamps as they arrive, it doesn't touch GL so the controller can also run on made up timings.
+         */
+        float update(double gpuMilliseconds);
+
+        /**
+         * Pretend the GPU got slower: for the next frames, milliseconds at full resolution (scaled down with the
+         * pixel count) are added to every measurement. The controller's response is recorded in trace.
+         */
+        void injectSpike(double milliseconds, int frames, int tracedFrames);
+
+        // The spike trace is complete, clear trace once it has been used.
+        bool traceReady() const;
+
+        void writeTrace(std::ostream &out) const;
+
+        float scale() const;
+
+        // Size of the rendered region.
+        int width() const;
+
+        int height() const;
+
+        // Rendered region in texture coordinates of the full size targets.
+        glm::vec2 uvScale() const;
+
+        double milliseconds() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_DYNAMICRESOLUTION_HPP
@@ -0,0 +1,27 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_FRAMESTATS_HPP
+#define MATF_RG_PROJEKAT_FRAMESTATS_HPP
+
+#include <ostream>
+
+namespace rg {
+
+    // Per frame counters of the scene geometry submission, reset at the start of every frame.
+    struct FrameStats {
+        int drawCalls = 0;
+        int meshes = 0; // meshes drawn, what drawCalls would be with one glDrawElements each
+        int textureBinds = 0; // material textures only, post processing binds aren't counted
+        int culledInstances = 0; // asteroids dropped by occlusion culling
+
+        void reset();
+    };
+
+    extern FrameStats frameStats;
+
+    std::ostream &operator<<(std::ostream &os, const FrameStats &stats);
+}
+
+#endif //MATF_RG_PROJEKAT_FRAMESTATS_HPP
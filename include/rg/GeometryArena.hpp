@@ -0,0 +1,69 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_GEOMETRYARENA_HPP
+#define MATF_RG_PROJEKAT_GEOMETRYARENA_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <rg/Mesh.hpp>
+#include <rg/StreamBuffer.hpp>
+#include <rg/utils/glext.hpp>
+
+namespace rg {
+
+    /**
+     * Shared vertex and index buffers that static meshes are suballocated from, so everything can be
+     * drawn from one VAO.
+     *
+     * Draws are submitted as lists of DrawElementsIndirectCommand. With multi draw indirect a list is a
+     * single glMultiDrawElementsIndirect, the commands are written into the frame's stream buffer region.
+     * Without it every command becomes a glDrawElementsBaseVertex, still without
+     * any VAO switches.
+     */
+    class GeometryArena {
+        unsigned int VAO{};
+        unsigned int VBO{};
+        unsigned int EBO{};
+        StreamBuffer &frameData;
+        GLsizeiptr vertexCapacity;
+        GLsizeiptr indexCapacity;
+        GLsizeiptr vertexCount = 0;
+        GLsizeiptr indexCount = 0;
+
+        void grow(GLsizeiptr minVertices, GLsizeiptr minIndices);
+
+        void setupAttributes() const;
+
+    public:
+        struct Range {
+            GLuint firstIndex;
+            GLsizei indexCount;
+            GLint baseVertex;
+        };
+
+        // Models fall back to their own per mesh VAOs when false.
+        bool enabled = true;
+
+        explicit GeometryArena(StreamBuffer &frameData, GLsizeiptr vertexCapacity = 1 << 16,
+                               GLsizeiptr indexCapacity = 1 << 18);
+
+        // Copy the mesh into the shared buffers, growing them if needed.
+        Range allocate(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+
+        static DrawElementsIndirectCommand command(const Range &range);
+
+        void bind() const;
+
+        // Submit the commands with the arena VAO bound, counted in rg::frameStats.
+        void draw(const std::vector<DrawElementsIndirectCommand> &commands);
+
+        // Bytes allocated for vertices and indices.
+        size_t memoryUsage() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_GEOMETRYARENA_HPP
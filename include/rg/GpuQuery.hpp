@@ -0,0 +1,45 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_GPUQUERY_HPP
+#define MATF_RG_PROJEKAT_GPUQUERY_HPP
+
+#include <glad/glad.h>
+
+namespace rg {
+
+    /**
+     * Ring of query objects for one target (GL_TIME_ELAPSED, GL_SAMPLES_PASSED, ...), one per frame in
+     * flight. A query is read back only when its object comes around again a few frames later, so the
+     * result is slightly old but reading it never stalls the pipeline. If even that one isn't done, the
+     * frame goes unmeasured and result() keeps the previous value.
+     */
+    class GpuQuery {
+        static const int ringSize = 4;
+
+        GLenum queryTarget;
+        unsigned int ids[ringSize]{};
+        bool pending[ringSize]{};
+        int frame = 0;
+        bool active = false;
+        bool measuring = false; // this begin() issued a query
+        GLuint64 latest = 0;
+
+    public:
+        explicit GpuQuery(GLenum target);
+
+        void begin();
+
+        void end();
+
+        // Most recent available result: nanoseconds for GL_TIME_ELAPSED, counts for the rest.
+        GLuint64 result() const;
+
+        double milliseconds() const;
+
+        GLenum target() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_GPUQUERY_HPP
@@ -0,0 +1,99 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_JOBSYSTEM_HPP
+#define MATF_RG_PROJEKAT_JOBSYSTEM_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rg {
+
+    using JobCounter = std::atomic<int>;
+
+    /**
+     * Fixed pool of worker threads with one job deque per thread.
+     *
+     * A thread pushes and pops jobs at the back of its own deque and steals from the front of the others
+     * when it runs dry. The thread that owns the JobSystem (the GL thread) has deque 0 and takes part in
+     * the work while it waits, so a JobSystem with 0 workers simply runs everything inline.
+     */
+    class JobSystem {
+        struct Queue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> jobs;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> workers;
+
+        std::mutex sleepMutex;
+        std::condition_variable wakeUp;
+        std::atomic<int> pending{0};
+        std::atomic<bool> running{true};
+        std::atomic<unsigned int> nextQueue{0};
+
+        void workerLoop(unsigned int index);
+
+        bool runOne(unsigned int index);
+
+    public:
+        /**
+         * @param workerCount Number of background threads, defaults to hardware concurrency - 1.
+         */
+        explicit JobSystem(int workerCount = -1);
+
+        ~JobSystem();
+
+        JobSystem(const JobSystem &) = delete;
+
+        JobSystem &operator=(const JobSystem &) = delete;
+
+        // Number of threads executing jobs, including the calling thread.
+        unsigned int threadCount() const;
+
+        // Queue a job, counter is incremented now and decremented when the job finishes.
+        void submit(std::function<void()> job, JobCounter &counter);
+
+        // Run queued jobs on the calling thread until counter reaches zero.
+        void wait(JobCounter &counter);
+
+        /**
+         * Split [begin, end) into ranges of at least grain elements and run f(rangeBegin, rangeEnd) on
+         * all threads. Returns when every range is done.
+         */
+        template<typename F>
+        void parallelFor(size_t begin, size_t end, size_t grain, F &&f) {
+            if (end <= begin) {
+                return;
+            }
+            size_t count = end - begin;
+            grain = std::max<size_t>(grain, 1);
+            // a few ranges per thread so stealing can even out uneven work
+            size_t ranges = std::min((count + grain - 1) / grain, (size_t) threadCount() * 4);
+            if (ranges <= 1) {
+                f(begin, end);
+                return;
+            }
+
+            JobCounter counter{0};
+            size_t step = (count + ranges - 1) / ranges;
+            for (size_t first = begin + step; first < end; first += step) {
+                size_t last = std::min(first + step, end);
+                submit([&f, first, last]() { f(first, last); }, counter);
+            }
+            f(begin, std::min(begin + step, end));
+            wait(counter);
+        }
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_JOBSYSTEM_HPP
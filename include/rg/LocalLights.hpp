@@ -0,0 +1,50 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_LOCALLIGHTS_HPP
+#define MATF_RG_PROJEKAT_LOCALLIGHTS_HPP
+
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/Shader.hpp>
+
+namespace rg {
+
+    /**
+     * Many small coloured point lights with a finite range, orbiting the sun between two radii, for lighting
+     * benchmarks. Positions are computed on the CPU every frame and uploaded into a buffer texture, two texels
+     * per light (position.xyz radius, color.rgb unused), which both the forward (lit.fs LOCAL_LIGHTS) and
+     * the deferred (light_volume.vs/fs) paths read. CalcLocalLight in lighting.glsl shades them.
+     */
+    class LocalLights {
+        unsigned int buffer{};
+        unsigned int texture{};
+        // x - orbit radius, y - height above the orbital plane, z - phase, w - angular speed
+        std::vector<glm::vec4> orbits;
+        // rgb - color, a - range
+        std::vector<glm::vec4> colors;
+        std::vector<glm::vec4> texels;
+
+    public:
+        static const int textureUnit = 7;
+
+        // Lights in use, at most capacity().
+        int count = 0;
+
+        LocalLights(int capacity, float innerRadius, float outerRadius);
+
+        int capacity() const;
+
+        // Move the lights to where they are at time and upload the first count of them.
+        void update(double time);
+
+        // Bind the buffer texture to textureUnit and set localLights and localLightCount.
+        void bind(const Shader &shader) const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_LOCALLIGHTS_HPP
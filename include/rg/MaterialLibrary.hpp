@@ -0,0 +1,87 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_MATERIALLIBRARY_HPP
+#define MATF_RG_PROJEKAT_MATERIALLIBRARY_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <rg/Shader.hpp>
+
+namespace rg {
+
+    /**
+     * Materials backed by texture arrays instead of one GL_TEXTURE_2D per image.
+     *
+     * Images of the same size and color space become layers of one GL_TEXTURE_2D_ARRAY. Per material
+     * layer indices live in an integer buffer texture the shaders index with the materialIndex uniform,
+     * so switching between materials whose images share arrays is a uniform change, not a texture bind.
+     *
+     * Texture units 3 (diffuseArray), 4 (specularArray) and 5 (materials) are reserved for it.
+     */
+    class MaterialLibrary {
+        struct Array {
+            unsigned int id{};
+            int width;
+            int height;
+            bool srgb;
+            std::vector<unsigned char *> layers; // decoded RGBA8 images until build()
+        };
+
+        struct Material {
+            int diffuseArray = -1;
+            int diffuseLayer = -1;
+            int specularArray = -1;
+            int specularLayer = -1;
+        };
+
+        struct Location {
+            int array;
+            int layer;
+        };
+
+        std::vector<Array> arrays;
+        std::vector<Material> materials;
+        std::unordered_map<std::string, Location> images;
+        std::unordered_map<std::string, int> materialIds;
+        unsigned int materialBuffer{};
+        unsigned int materialTexture{};
+        unsigned int boundDiffuse = 0;
+        unsigned int boundSpecular = 0;
+        bool built = false;
+
+        Location addImage(const std::string &path, bool gammaCorrection, bool flip);
+
+    public:
+        static const int diffuseUnit = 3;
+        static const int specularUnit = 4;
+        static const int materialUnit = 5;
+
+        // Decodes the images right away, empty paths mean no texture. Returns the material index.
+        int addMaterial(const std::string &diffusePath, const std::string &specularPath, bool gammaCorrection,
+                        bool flip);
+
+        // Upload every array and the material buffer, must be called before the first bind().
+        void build();
+
+        // Point the shader's samplers at the reserved units.
+        void setupShader(const Shader &shader) const;
+
+        /**
+         * Make the material current for the bound shader. Arrays are only rebound when they differ from
+         * the ones already bound, every bind is counted in rg::frameStats.
+         */
+        void bind(int material, const Shader &shader);
+
+        int size() const;
+
+        size_t memoryUsage() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_MATERIALLIBRARY_HPP
@@ -41,6 +41,14 @@ namespace rg {
 
         void draw(Shader &shader);
 
+        // Draw with whatever textures are currently bound.
+        void drawElements() const;
+
+        // Bind the textures to consecutive units and point the sampler uniforms at them.
+        void bindTextures(Shader &shader) const;
+
+        bool sameTextures(const Mesh &other) const;
+
     private:
         void setupMesh();
     };
@@ -15,6 +15,8 @@
 
 #include <rg/Shader.hpp>
 #include <rg/Mesh.hpp>
+#include <rg/GeometryArena.hpp>
+#include <rg/MaterialLibrary.hpp>
 
 namespace rg {
     class Model {
@@ -27,13 +29,40 @@ namespace rg {
 
         explicit Model(const std::string &path, bool gammaCorrection = false);
 
+        // Goes through the arena if the model was added to one, consecutive meshes with the same textures
+        // are submitted together.
         void draw(Shader &shader);
 
+        // Geometry only for the depth pre-pass, no material binds, all meshes in one submission.
+        void drawDepth();
+
+        void addToArena(GeometryArena &geometryArena);
+
+        /**
+         * Register a material (first diffuse and specular texture) per mesh. Once added, draw binds
+         * through the library and the shader has to sample diffuseArray/specularArray instead of
+         * texture_diffuseN.
+         */
+        void addToMaterials(MaterialLibrary &library, bool flip);
+
         void setTextureNamePrefix(const std::string &prefix);
 
     private:
+        GeometryArena *arena = nullptr;
+        std::vector<GeometryArena::Range> arenaRanges;
+        std::vector<DrawElementsIndirectCommand> commands;
+        MaterialLibrary *materialLibrary = nullptr;
+        std::vector<int> meshMaterials;
+
+        void bindMaterial(size_t mesh, Shader &shader);
+
+        bool sameMaterial(size_t a, size_t b) const;
+
         void loadModel(const std::string &path);
 
+        // .obj files skip Assimp and go through the streaming reader in rg/ObjLoader.hpp
+        void loadObjModel(const std::string &path);
+
         void processNode(aiNode *node, const aiScene *scene);
 
         Mesh processMesh(aiMesh *mesh, const aiScene *scene);
@@ -41,6 +70,8 @@ namespace rg {
         void loadTextureMaterial(aiMaterial *mat, aiTextureType type, const std::string &typeName,
                                  std::vector<Texture> &textures);
 
+        void loadTexture(const std::string &filename, const std::string &typeName, std::vector<Texture> &textures);
+
         unsigned int textureFromFile(const char *filename) const;
     };
 }
@@ -0,0 +1,81 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_NBODY_HPP
+#define MATF_RG_PROJEKAT_NBODY_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rg/JobSystem.hpp>
+
+namespace rg {
+
+    // Massive body moved by someone else (orbit system), only pulls on the particles.
+    struct Attractor {
+        glm::vec3 position;
+        float mass;
+    };
+
+    /**
+     * Gravitational N-body integrator for the asteroid belt.
+     *
+     * Particles are kept as structure of arrays. Particle-particle forces use a Barnes-Hut octree rebuilt
+     * every step, attractors are summed directly. Integration is kick-drift-kick leapfrog, which is
+     * symplectic, so energy oscillates instead of drifting away for a fixed dt.
+     */
+    class NBody {
+        struct Node {
+            glm::vec3 com;
+            float mass;
+            float size; // edge length of the cell
+            int firstChild; // children are consecutive, -1 for leaves
+            int childCount;
+            int begin, end; // range in the sorted particle arrays, only used by leaves
+        };
+
+        std::vector<Node> nodes;
+        // particle indices and positions in tree order, so every leaf is a contiguous range
+        std::vector<int> order;
+        std::vector<float> sortedX, sortedY, sortedZ, sortedMass;
+        bool accelerationsValid = false;
+
+        void buildTree();
+
+        void buildNode(int index, int begin, int end, const glm::vec3 &center, float halfSize, int depth);
+
+        // Sum of tree and attractor accelerations (and potential) at particle i.
+        glm::vec3 acceleration(size_t i, float *potential) const;
+
+        void computeAccelerations(JobSystem &jobs);
+
+    public:
+        std::vector<float> px, py, pz;
+        std::vector<float> vx, vy, vz;
+        std::vector<float> ax, ay, az;
+        std::vector<float> mass;
+
+        std::vector<Attractor> attractors;
+
+        float gravity = 1.0f;
+        float theta = 0.5f; // opening angle, smaller is more accurate
+        float softening = 0.05f;
+
+        void addParticle(const glm::vec3 &position, const glm::vec3 &velocity, float m);
+
+        void clear();
+
+        size_t size() const;
+
+        glm::vec3 position(size_t i) const;
+
+        void step(float dt, JobSystem &jobs);
+
+        // Kinetic + potential energy, particle-particle potential is approximated through the tree.
+        double energy(JobSystem &jobs);
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_NBODY_HPP
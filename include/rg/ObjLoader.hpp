@@ -0,0 +1,62 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_OBJLOADER_HPP
+#define MATF_RG_PROJEKAT_OBJLOADER_HPP
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rg/Mesh.hpp>
+
+namespace rg {
+
+    struct ObjMaterial {
+        std::string name;
+        glm::vec3 ambient{1.0f};
+        glm::vec3 diffuse{0.8f};
+        glm::vec3 specular{0.0f};
+        float shininess = 0.0f;
+
+        // texture paths relative to the .obj directory, empty if not present
+        std::string diffuseMap;
+        std::string specularMap;
+        std::string normalMap;
+        std::string heightMap;
+        std::string ambientMap;
+        std::string emissiveMap;
+    };
+
+    struct ObjMesh {
+        int material = -1; // index into ObjData::materials, -1 if none
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+    };
+
+    struct ObjData {
+        std::vector<ObjMesh> meshes;
+        std::vector<ObjMaterial> materials;
+    };
+
+    /**
+     * Streaming Wavefront OBJ/MTL reader.
+     *
+     * The file is memory mapped and split into line aligned chunks that are tokenized in parallel, then
+     * every position/uv/normal triplet is deduplicated into an indexed vertex. Polygons are triangulated
+     * as fans, v texture coordinates are flipped and missing normals/tangents are generated, so the output
+     * matches what Assimp produces with the flags used in Model::loadModel.
+     *
+     * @param path Path to the .obj file.
+     * @param out Parsed meshes, one per material run.
+     * @param threads Number of parsing threads, 0 picks one based on file size and hardware concurrency.
+     * @return false if the file could not be opened or mapped.
+     */
+    bool loadObj(const std::string &path, ObjData &out, unsigned int threads = 0);
+
+    bool loadMtl(const std::string &path, std::vector<ObjMaterial> &materials);
+}
+
+#endif //MATF_RG_PROJEKAT_OBJLOADER_HPP
@@ -0,0 +1,73 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_OCCLUSIONBUFFER_HPP
+#define MATF_RG_PROJEKAT_OCCLUSIONBUFFER_HPP
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rg {
+
+    /**
+     * Low resolution software rasterized depth buffer of the big occluders (sun and planets) with a
+     * hierarchical max-depth pyramid on top, for culling asteroids on the CPU before they are streamed.
+     *
+     * Depth is window depth in [0, 1] as glDepthRange(0, 1) would produce, cleared to 1. Every pyramid
+     * texel holds the farthest depth of the texels below it, so a sphere whose nearest point is behind
+     * that value is hidden. Occluders must lie inside the objects they stand for, since the buffer is
+     * coarser than the real framebuffer. Triangles crossing the near plane are dropped, which only makes
+     * the buffer occlude less.
+     *
+     * Needs no GL context.
+     */
+    class OcclusionBuffer {
+        int bufferWidth;
+        int bufferHeight;
+        glm::mat4 view{1.0f};
+        glm::mat4 projection{1.0f};
+        glm::mat4 viewProjection{1.0f};
+        float nearPlane = 0.1f;
+        // level 0 is the rasterized depth, level n is level n - 1 halved (rounded up) with max
+        std::vector<std::vector<float>> levels;
+        std::vector<glm::ivec2> sizes;
+        std::vector<glm::vec3> sphereVertices;
+        std::vector<unsigned int> sphereIndices;
+
+        void rasterize(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c);
+
+    public:
+        int trianglesRasterized = 0;
+
+        OcclusionBuffer(int width, int height);
+
+        // Start a frame, depth is reset to 1.
+        void clear(const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix);
+
+        // Counter clockwise triangles, positions in model space.
+        void addOccluder(const glm::mat4 &model, const std::vector<glm::vec3> &positions,
+                         const std::vector<unsigned int> &indices);
+
+        // Icosphere whose vertices are on the given sphere, so it never covers more than the sphere.
+        void addSphereOccluder(const glm::vec3 &center, float radius);
+
+        // Rebuild the max pyramid from level 0, call after the occluders are added.
+        void buildPyramid();
+
+        // False when the sphere is outside the view or hidden behind occluders. Safe to call from
+        // several threads once the pyramid is built.
+        bool isVisible(const glm::vec3 &center, float radius) const;
+
+        int width() const;
+
+        int height() const;
+
+        int levelCount() const;
+
+        float depth(int x, int y, int level = 0) const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_OCCLUSIONBUFFER_HPP
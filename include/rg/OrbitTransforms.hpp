@@ -0,0 +1,61 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_ORBITTRANSFORMS_HPP
+#define MATF_RG_PROJEKAT_ORBITTRANSFORMS_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace rg {
+
+    /**
+     * Structure-of-arrays orbit description for batches of instances that circle the origin and spin
+     * around their own axis with a common angular speed.
+     *
+     * Phases are stored as sine/cosine pairs so a frame only needs one scalar sin/cos for the orbit
+     * and one for the spin, everything per instance is multiply-add.
+     */
+    struct OrbitBatch {
+        std::vector<float> radius;
+        std::vector<float> height;
+        std::vector<float> sinPhase;
+        std::vector<float> cosPhase;
+        std::vector<float> axisX;
+        std::vector<float> axisY;
+        std::vector<float> axisZ;
+
+        void add(float orbitRadius, float orbitHeight, float phase, const glm::vec3 &axis);
+
+        size_t size() const;
+    };
+
+    /**
+     * Writes translate(orbit(time)) * rotate(spin(time), axis) for instances [first, first + count) as
+     * column major 4x4 float matrices to out (16 floats per instance, out points at instance first).
+     *
+     * Uses AVX2 or SSE depending on what the CPU supports, with a scalar fallback.
+     */
+    void buildOrbitTransforms(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                              size_t first, size_t count);
+
+    void buildOrbitTransformsScalar(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                                    size_t first, size_t count);
+
+#if defined(__x86_64__)
+    // The paths buildOrbitTransforms picks from, AVX2 only where orbitTransformsBackend() says "avx2".
+    void buildOrbitTransformsSSE(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                                 size_t first, size_t count);
+
+    void buildOrbitTransformsAVX2(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                                  size_t first, size_t count);
+#endif
+
+    // "avx2", "sse" or "scalar"
+    const char *orbitTransformsBackend();
+}
+
+#endif //MATF_RG_PROJEKAT_ORBITTRANSFORMS_HPP
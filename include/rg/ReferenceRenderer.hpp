@@ -0,0 +1,159 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_REFERENCERENDERER_HPP
+#define MATF_RG_PROJEKAT_REFERENCERENDERER_HPP
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include <rg/Camera.hpp>
+#include <rg/JobSystem.hpp>
+#include <rg/ObjLoader.hpp>
+#include <rg/light.hpp>
+
+namespace rg {
+
+    /**
+     * Software rasterizer for the sun and planets, the CPU reference for what the GL path draws into the
+     * HDR buffer: lit.fs Blinn-Phong for lit models and sun.fs flat color for emissive ones. There is
+     * no skybox, bloom or mipmapping (textures are sampled bilinearly from the base level).
+     *
+     * Draw calls transform, near-clip and set up triangles. render() bins them into tiles and rasterizes
+     * the tiles in parallel on the job system, each tile in submission order, so the image doesn't
+     * depend on the number of workers. Coverage and depth are evaluated four pixels at a time with SSE
+     * where available, pixel centers and the top-left fill rule follow GL.
+     *
+     * Geometry comes from rg::loadObj (or any ObjData) and textures straight from their files, no GL calls
+     * and no context needed.
+     */
+    class ReferenceRenderer {
+    public:
+        static const int tileSize = 64;
+
+        struct Stats {
+            size_t triangles = 0; // after near plane clipping
+            size_t tileBins = 0; // triangle-tile pairs rasterized
+            size_t fragments = 0; // pixels shaded
+            double setupMilliseconds = 0.0; // transform, clipping and triangle setup in the draw calls
+            double rasterMilliseconds = 0.0; // binning and tiles
+        };
+
+        ReferenceRenderer(int width, int height);
+
+        // Start a frame: clear to black and far depth, take matrices and lights for the draws that follow.
+        void begin(const Camera &camera, const PointLight &pointLight, const SpotLight &spotLight);
+
+        /**
+         * Keep geometry for the draws of this and later frames.
+         *
+         * @param directory Where the materials' texture paths are relative to.
+         * @return Id for drawLit and drawEmissive.
+         */
+        int addModel(ObjData data, const std::string &directory, bool gammaCorrection = false);
+
+        // addModel with the meshes of an .obj file read by rg::loadObj, -1 if it can't be read.
+        int loadModel(const std::string &path, bool gammaCorrection = false);
+
+        // Shaded like lit.fs (planet variant) with each mesh's diffuse map as albedo.
+        void drawLit(int model, const glm::mat4 &transform, bool flipTextures);
+
+        // Shaded like sun.fs, one color.
+        void drawEmissive(int model, const glm::mat4 &transform, const glm::vec3 &emissive);
+
+        void render(JobSystem &jobs);
+
+        int width() const;
+
+        int height() const;
+
+        // Linear HDR color, y = 0 is the bottom row as in GL.
+        const glm::vec3 &pixel(int x, int y) const;
+
+        // hdr.fs tone mapping (without bloom) and gamma, 8 bit RGB with the top row first.
+        std::vector<unsigned char> toneMapped(float exposure) const;
+
+        // toneMapped as a binary PPM.
+        bool writePPM(const std::string &path, float exposure) const;
+
+        const Stats &stats() const;
+
+    private:
+        struct ClipVertex {
+            glm::vec4 clip;
+            glm::vec3 world;
+            glm::vec3 normal;
+            glm::vec2 uv;
+        };
+
+        // Counter clockwise in window space, edge i is the one opposite to vertex i:
+        // E_i(x, y) = a[i] * x + b[i] * y + c[i], positive inside.
+        struct Triangle {
+            float a[3], b[3], c[3];
+            bool topLeft[3];
+            float z[3];
+            float invW[3];
+            float invArea;
+            int minX, maxX, minY, maxY;
+            int firstVertex; // three consecutive entries in vertices
+            int material;
+        };
+
+        struct Material {
+            bool lit;
+            glm::vec3 emissive;
+            int texture; // -1 without a diffuse texture
+        };
+
+        struct CpuModel {
+            ObjData data;
+            std::string directory;
+            bool gammaCorrection;
+        };
+
+        struct CpuTexture {
+            int width;
+            int height;
+            bool srgb;
+            std::vector<unsigned char> rgba;
+
+            glm::vec3 sample(const glm::vec2 &uv) const;
+        };
+
+        int imageWidth;
+        int imageHeight;
+        int tilesX;
+        int tilesY;
+        glm::mat4 viewProjection{1.0f};
+        glm::vec3 viewPos{0.0f};
+        PointLight point{};
+        SpotLight spot{};
+
+        std::vector<glm::vec3> color;
+        std::vector<float> depth;
+        std::vector<ClipVertex> vertices;
+        std::vector<Triangle> triangles;
+        std::vector<Material> materials;
+        std::vector<CpuModel> models;
+        std::vector<CpuTexture> textures;
+        std::unordered_map<std::string, int> textureIds;
+        Stats frameStats;
+
+        int loadTexture(const std::string &path, bool srgb, bool flip);
+
+        void draw(const ObjMesh &mesh, const glm::mat4 &transform, int material);
+
+        void addTriangle(const ClipVertex &a, const ClipVertex &b, const ClipVertex &c, int material);
+
+        // Returns the number of fragments shaded.
+        size_t rasterizeTile(int tileX, int tileY, const std::vector<int> &bin);
+
+        glm::vec3 shade(const Triangle &triangle, float b0, float b1, float b2) const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_REFERENCERENDERER_HPP
@@ -0,0 +1,82 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_RENDERTARGETS_HPP
+#define MATF_RG_PROJEKAT_RENDERTARGETS_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+namespace rg {
+
+    struct TargetFormat {
+        GLenum internalFormat;
+        GLenum format;
+        GLenum type;
+        int bytesPerPixel;
+        const char *name;
+        const char *imageFormat; // GLSL image layout qualifier, for compute passes writing the target
+    };
+
+    // HDR colour and bloom chains, no alpha, 6/6/5 bit mantissas with a shared 5 bit exponent range.
+    extern const TargetFormat packedHdrFormat;
+    // What every target used to be, kept as the quality and size baseline.
+    extern const TargetFormat halfFloatFormat;
+    // Tonemapped and gamma encoded intermediates.
+    extern const TargetFormat ldrFormat;
+    // Log luminance and coverage for exposure metering.
+    extern const TargetFormat meteringFormat;
+    // Octahedral normals of the G-buffer, two signed components.
+    extern const TargetFormat normalFormat;
+    extern const TargetFormat depthFormat;
+
+    /**
+     * Offscreen targets with explicit formats, each one remembered for the VRAM and bandwidth report.
+     * accessesPerFrame is an estimate of full-target reads plus writes with default settings.
+     */
+    class RenderTargets {
+        struct Entry {
+            std::string name;
+            int width;
+            int height;
+            const TargetFormat *format;
+            float accessesPerFrame;
+            int levels;
+            int samples;
+
+            size_t bytes() const;
+        };
+
+        std::vector<Entry> entries;
+
+    public:
+        // Allocate a clamped, linearly filtered 2D texture.
+        unsigned int createTexture(const std::string &name, int width, int height, const TargetFormat &format,
+                                   float accessesPerFrame);
+
+        // Record a target allocated elsewhere (renderbuffers, mip chains, multisampled), levels counts the mips.
+        void track(const std::string &name, int width, int height, const TargetFormat &format,
+                   float accessesPerFrame, int levels = 1, int samples = 1);
+
+        // Forget a target that was freed (reallocated at another size, tracked again under the same name).
+        void release(const std::string &name);
+
+        size_t memoryUsage() const;
+
+        // Per target size, traffic per frame and what RGBA16F would have cost.
+        void report(std::ostream &out) const;
+
+        // Value the format would store for color, alpha ignored. Used to diff formats on CPU rendered frames.
+        static glm::vec3 quantize(const glm::vec3 &color, const TargetFormat &format);
+    };
+
+    extern RenderTargets renderTargets;
+}
+
+#endif //MATF_RG_PROJEKAT_RENDERTARGETS_HPP
@@ -0,0 +1,69 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_SCENEGRAPH_HPP
+#define MATF_RG_PROJEKAT_SCENEGRAPH_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+namespace rg {
+
+    /**
+     * Flat transform hierarchy.
+     *
+     * Nodes live in parallel arrays indexed by node id and a parent always has a smaller id than its
+     * children, so a single forward pass computes every world matrix. Only nodes whose local transform
+     * changed, and their descendants, are recomputed.
+     */
+    class SceneGraph {
+        std::vector<int> parents;
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::mat4> worlds;
+        std::vector<uint8_t> dirty;
+        std::vector<uint8_t> changed;
+
+        size_t lastUpdated = 0;
+
+    public:
+        static constexpr int noParent = -1;
+
+        /**
+         * Add a node with an identity local transform.
+         *
+         * @param parent Id of an existing node or noParent.
+         * @return Id of the new node.
+         */
+        int addNode(int parent = noParent);
+
+        size_t size() const;
+
+        int parent(int node) const;
+
+        void setTranslation(int node, const glm::vec3 &translation);
+
+        void setRotation(int node, const glm::quat &rotation);
+
+        void setScale(int node, const glm::vec3 &scale);
+
+        const glm::vec3 &translation(int node) const;
+
+        // Recompute world matrices of dirty nodes and their subtrees.
+        void update();
+
+        const glm::mat4 &world(int node) const;
+
+        glm::vec3 worldPosition(int node) const;
+
+        // Number of world matrices recomputed by the last update().
+        size_t lastUpdateCount() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_SCENEGRAPH_HPP
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <initializer_list>
+#include <vector>
 
 #include <glm/glm.hpp>
 #include <glad/glad.h>
@@ -13,10 +15,23 @@
 
 namespace rg {
     class Shader {
-        unsigned int pId;
+        unsigned int pId{};
+
+        Shader() = default;
     public:
         Shader(std::string vertexShaderPath, std::string fragmentShaderPath);
 
+        // defines ("#define NAME value" lines) go right after the #version line of both stages.
+        // Sources may #include "file" relative to themselves, each file is pasted once.
+        Shader(std::string vertexShaderPath, std::string fragmentShaderPath, const std::string &defines);
+
+        // With a geometry stage in between, defines go into all three.
+        Shader(const std::string &vertexShaderPath, const std::string &geometryShaderPath,
+               const std::string &fragmentShaderPath, const std::string &defines);
+
+        // Compute program, needs glext.computeShaders.
+        static Shader compute(const std::string &computeShaderPath, const std::string &defines = "");
+
         // activate the shader
         void use() const;
 
@@ -25,8 +40,12 @@ namespace rg {
 
         void setInt(const std::string &name, int value) const;
 
+        void setIVec2(const std::string &name, int x, int y) const;
+
         void setFloat(const std::string &name, float value) const;
 
+        void setFloats(const std::string &name, const float *values, int count) const;
+
         void setVec2(const std::string &name, const glm::vec2 &value) const;
 
         void setVec2(const std::string &name, float x, float y) const;
@@ -57,11 +76,21 @@ namespace rg {
         /**
          * Compile shader.
          *
-         * @param type The type of shader we want to compile: GL_VERTEX_SHADER, GL_FRAGMENT_SHADER
+         * @param type The type of shader we want to compile: GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER
          * @param source The source of the shader as a string.
          * @return Shader ID.
          */
         static int compileShader(GLenum type, const std::string &source);
+
+        static unsigned int linkProgram(std::initializer_list<int> shaders);
+
+        static std::string injectDefines(const std::string &source, const std::string &defines);
+
+        // Source with #include lines replaced by the files, #line directives keep compile errors pointing at the
+        // right file (source string number is the index in included) and line.
+        static std::string loadSource(const std::string &path, std::vector<std::string> &included);
+
+        static std::string loadSource(const std::string &path);
     };
 }
 
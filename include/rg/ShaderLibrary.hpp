@@ -0,0 +1,72 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_SHADERLIBRARY_HPP
+#define MATF_RG_PROJEKAT_SHADERLIBRARY_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <rg/Shader.hpp>
+
+namespace rg {
+
+    /**
+     * Shader permutations. A variant is a program plus a set of feature keys, each key becomes a #define
+     * ("NAME" -> #define NAME 1, "NAME value" -> #define NAME value) so the shader can #ifdef features out
+     * instead of branching on uniforms. Variants are compiled the first time they are asked for and kept for
+     * the rest of the run, key order doesn't matter.
+     */
+    class ShaderLibrary {
+    public:
+        // Runs once right after a variant is compiled, for uniforms that never change (sampler units).
+        using Setup = std::function<void(const Shader &)>;
+
+        struct Stats {
+            int variants = 0;
+            long long lookups = 0;
+            double compileMilliseconds = 0.0; // compile and link of all variants
+            double slowestMilliseconds = 0.0;
+            std::string slowest;
+        };
+
+        const Shader &get(const std::string &vertexShaderPath, const std::string &fragmentShaderPath,
+                          std::vector<std::string> features = {}, const Setup &setup = nullptr);
+
+        // Vertex, geometry and fragment program.
+        const Shader &getGeometry(const std::string &vertexShaderPath, const std::string &geometryShaderPath,
+                                  const std::string &fragmentShaderPath, std::vector<std::string> features = {},
+                                  const Setup &setup = nullptr);
+
+        // Needs glext.computeShaders.
+        const Shader &getCompute(const std::string &computeShaderPath, std::vector<std::string> features = {},
+                                 const Setup &setup = nullptr);
+
+        const Stats &stats() const;
+
+        // One line per variant with its compile time, in key order.
+        void report(std::ostream &out) const;
+
+    private:
+        struct Variant {
+            std::unique_ptr<Shader> shader;
+            double compileMilliseconds;
+        };
+
+        std::map<std::string, Variant> variants;
+        Stats counters;
+
+        template<typename Compile>
+        const Shader &variant(std::string key, std::vector<std::string> &features, const Setup &setup,
+                              Compile &&compile);
+
+        static std::string defines(const std::vector<std::string> &features);
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_SHADERLIBRARY_HPP
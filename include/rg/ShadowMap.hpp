@@ -0,0 +1,100 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_SHADOWMAP_HPP
+#define MATF_RG_PROJEKAT_SHADOWMAP_HPP
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <rg/GpuQuery.hpp>
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    /**
+     * Omnidirectional shadows for a point light.
+     *
+     * All six faces of a depth cube map are rendered in one pass: casters go through their usual vertex
+     * shader with identity view and projection (so gl_Position is the world position) and shadow.gs emits
+     * every triangle once per face with gl_Layer. The map stores distance to the light over farPlane, lit
+     * shaders compare against it through a samplerCubeShadow (shadows.glsl).
+     *
+     * The map is cached: it is only rendered again when the light or the scene time moved since the last
+     * render, and then at most every updateInterval frames. A paused simulation costs nothing.
+     */
+    class ShadowMap {
+        ShaderLibrary &shaders;
+        unsigned int fbo{};
+        unsigned int texture{};
+        int allocatedResolution = 0;
+        glm::mat4 faceMatrices[6];
+        glm::vec3 light{0.0f};
+        glm::vec3 cachedLight{0.0f};
+        double cachedTime = 0.0;
+        bool valid = false;
+        bool rendering = false;
+        int framesSinceRender = 0;
+        GLint viewport[4]{};
+        GLint previousFramebuffer = 0;
+        GpuQuery timer;
+
+        void allocate();
+
+    public:
+        struct Stats {
+            long long renders = 0;
+            long long reused = 0; // frames that kept the cached map
+        };
+
+        static const int textureUnit = 6;
+
+        bool enabled = true;
+        // Size of a cube face.
+        int resolution = 1024;
+        // Frames between renders while the casters move, 1 renders every frame.
+        int updateInterval = 1;
+        float nearPlane = 0.5f;
+        // Casters and receivers past this distance from the light are not shadowed.
+        float farPlane = 150.0f;
+        // PCF kernel radius in shadow map texels.
+        float filterRadius = 1.5f;
+        Stats stats;
+
+        explicit ShadowMap(ShaderLibrary &shaders);
+
+        /**
+         * Returns true when the map has to be rendered this frame, with its framebuffer bound and cleared.
+         * Draw the casters with caster() shaders and finish with end(). sceneTime is whatever changes when
+         * casters move (the simulation time).
+         */
+        bool begin(const glm::vec3 &lightPosition, double sceneTime);
+
+        /**
+         * Variant of vertexShaderPath + shadow.gs + shadow.fs with this frame's face matrices set, in use.
+         * features and setup as in ShaderLibrary::get, for whatever the vertex shader itself needs.
+         */
+        const Shader &caster(const std::string &vertexShaderPath, std::vector<std::string> features = {},
+                             const ShaderLibrary::Setup &setup = nullptr);
+
+        // Restores the framebuffer and viewport bound before begin().
+        void end();
+
+        // Next begin() renders regardless of the cache.
+        void invalidate();
+
+        // Bind the map to textureUnit and set the shadows.glsl uniforms of a lit shader.
+        void bind(const Shader &shader) const;
+
+        // Of the last measured render.
+        double milliseconds() const;
+
+        size_t memoryUsage() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_SHADOWMAP_HPP
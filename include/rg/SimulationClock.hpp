@@ -0,0 +1,57 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_SIMULATIONCLOCK_HPP
+#define MATF_RG_PROJEKAT_SIMULATIONCLOCK_HPP
+
+namespace rg {
+
+    /**
+     * Fixed timestep accumulator in double precision.
+     *
+     * Real frame time is fed in with advance(), then tick() is called until it returns false, each call
+     * moving simulation time forward by one fixed step. Rendering interpolates between the last two
+     * simulated states with alpha(). At most maxStepsPerFrame steps run per frame, the rest of the
+     * backlog is dropped, so a slow frame can't snowball into slower ones. That also caps the time scale:
+     * beyond maxStepsPerFrame a frame of one fixed step would feed more than it can simulate.
+     */
+    class SimulationClock {
+        double fixedStep;
+        int maxStepsPerFrame;
+        double accumulator = 0.0;
+        // time is derived from the step count so it doesn't accumulate rounding error
+        long long steps = 0;
+        int stepsThisFrame = 0;
+        double scale = 1.0;
+    public:
+        bool paused = false;
+
+        explicit SimulationClock(double fixedStep = 1.0 / 60.0, int maxStepsPerFrame = 8);
+
+        void advance(double realSeconds);
+
+        // Clamped to maxTimeScale(), returns the scale that was set.
+        double setTimeScale(double timeScale);
+
+        double timeScale() const;
+
+        double maxTimeScale() const;
+
+        // Consume one fixed step, false once the accumulator holds less than a step.
+        bool tick();
+
+        double step() const;
+
+        // Simulation time of the latest simulated state.
+        double now() const;
+
+        // Blend factor between the previous (0) and latest (1) simulated state.
+        double alpha() const;
+
+        // Simulation time matching alpha(), for anything evaluated analytically while rendering.
+        double renderTime() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_SIMULATIONCLOCK_HPP
@@ -0,0 +1,77 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_STREAMBUFFER_HPP
+#define MATF_RG_PROJEKAT_STREAMBUFFER_HPP
+
+#include <glad/glad.h>
+
+namespace rg {
+
+    /**
+     * The GL calls a StreamBuffer makes. streamBufferGL goes to the current context, tests pass fakes to run
+     * the region and fence rotation without one.
+     */
+    struct StreamBufferGL {
+        // New buffer of size bytes, persistently mapped into *persistent when the context supports it.
+        unsigned int (*create)(GLsizeiptr size, char **persistent);
+        void *(*mapRange)(unsigned int buffer, GLintptr offset, GLsizeiptr size);
+        void (*unmap)(unsigned int buffer);
+        GLsync (*fenceSync)();
+        GLenum (*clientWaitSync)(GLsync fence, GLbitfield flags, GLuint64 timeout);
+        void (*deleteSync)(GLsync fence);
+    };
+
+    extern const StreamBufferGL streamBufferGL;
+
+    /**
+     * Ring buffer for data rewritten every frame (instance transforms, indirect commands).
+     *
+     * The buffer is split into regions, one per frame in flight. beginFrame() moves to the next region
+     * and waits on the fence placed when that region was last used, endFrame() places a new fence. With
+     * GL 4.4 / ARB_buffer_storage the whole buffer stays mapped (persistent and coherent), otherwise every
+     * map() is a glMapBufferRange with GL_MAP_UNSYNCHRONIZED_BIT, which is safe for the same reason.
+     * Either way the driver never has to orphan or synchronize the buffer behind our back.
+     */
+    class StreamBuffer {
+        static const int maxRegions = 4;
+
+        const StreamBufferGL &gl;
+        unsigned int buffer{};
+        GLsizeiptr regionSize;
+        int regionCount;
+        int region = 0;
+        GLsizeiptr used = 0;
+        GLsync fences[maxRegions]{};
+        char *persistent = nullptr;
+        bool mapped = false;
+
+    public:
+        // beginFrame() calls that found the GPU still reading the region and had to wait.
+        long long stalls = 0;
+        double stallMilliseconds = 0.0;
+        long long frames = 0;
+
+        StreamBuffer(GLsizeiptr regionSize, int regionCount = 3, const StreamBufferGL &gl = streamBufferGL);
+
+        void beginFrame();
+
+        void endFrame();
+
+        /**
+         * Reserve size bytes in the current region and return a write only pointer to them. offset is set
+         * to where they start in the buffer, for glVertexAttribPointer, indirect draws or glBindBufferRange.
+         * Must be followed by unmap() before the data is used.
+         */
+        void *map(GLsizeiptr size, GLsizeiptr alignment, GLintptr &offset);
+
+        void unmap();
+
+        unsigned int id() const;
+
+        bool isPersistent() const;
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_STREAMBUFFER_HPP
@@ -0,0 +1,22 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_SYSTEMS_HPP
+#define MATF_RG_PROJEKAT_SYSTEMS_HPP
+
+#include <rg/World.hpp>
+#include <rg/SceneGraph.hpp>
+
+namespace rg {
+
+    // Fixed step systems with no GL in them, shared by the demo and the headless tests.
+
+    // Moves every Orbit one fixed step to time, the previous position is kept for interpolation.
+    void orbitSystem(World &world, double time);
+
+    // Places the Motion entities between their last two steps, alpha as in SimulationClock::alpha().
+    void interpolationSystem(World &world, SceneGraph &scene, double alpha);
+}
+
+#endif //MATF_RG_PROJEKAT_SYSTEMS_HPP
@@ -0,0 +1,209 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_WORLD_HPP
+#define MATF_RG_PROJEKAT_WORLD_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <rg/JobSystem.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    using Entity = uint32_t;
+    using ComponentMask = uint64_t;
+
+    constexpr unsigned int maxComponentTypes = 64;
+
+    namespace detail {
+        inline unsigned int nextComponentId() {
+            static unsigned int next = 0;
+            return next++;
+        }
+
+        template<typename T>
+        unsigned int componentId() {
+            static const unsigned int id = nextComponentId();
+            return id;
+        }
+
+        template<typename... Ts>
+        ComponentMask maskOf() {
+            ComponentMask mask = 0;
+            using expand = int[];
+            (void) expand{0, (mask |= ComponentMask(1) << componentId<Ts>(), 0)...};
+            return mask;
+        }
+    }
+
+    /**
+     * Archetype based entity-component storage.
+     *
+     * Entities with the same set of components share an archetype, which keeps one tightly packed array
+     * per component type. Components have to be trivially copyable since rows are moved with memcpy when
+     * an entity changes archetype or a hole is filled by the last row.
+     */
+    class World {
+        struct Column {
+            unsigned int component;
+            size_t elementSize;
+            std::vector<unsigned char> data;
+        };
+
+        struct Archetype {
+            ComponentMask mask;
+            std::vector<Entity> entities;
+            std::vector<Column> columns;
+            int columnOf[maxComponentTypes];
+        };
+
+        struct Record {
+            int archetype;
+            size_t row;
+        };
+
+        std::vector<Record> records;
+        std::vector<Entity> freeEntities;
+        std::vector<std::unique_ptr<Archetype>> archetypes;
+        std::unordered_map<ComponentMask, int> archetypeLookup;
+        size_t componentSizes[maxComponentTypes]{};
+        size_t aliveCount = 0;
+
+        template<typename T>
+        unsigned int registerComponent() {
+            static_assert(std::is_trivially_copyable<T>::value, "Components must be trivially copyable.");
+            unsigned int id = detail::componentId<T>();
+            ASSERT(id < maxComponentTypes, "Too many component types.");
+            componentSizes[id] = sizeof(T);
+            return id;
+        }
+
+        int archetypeFor(ComponentMask mask);
+
+        // Append a zeroed row for e to archetype, copying the components e already has.
+        void moveEntity(Entity e, int archetype);
+
+        void removeRow(int archetype, size_t row);
+
+        void *component(Entity e, unsigned int id);
+
+        template<typename T>
+        static T *columnData(Archetype &archetype) {
+            Column &column = archetype.columns[archetype.columnOf[detail::componentId<T>()]];
+            return reinterpret_cast<T *>(column.data.data());
+        }
+
+        template<typename F, typename Tuple, size_t... Is>
+        static void eachRow(Archetype &archetype, size_t first, size_t last, F &f, Tuple &columns,
+                            std::index_sequence<Is...>) {
+            for (size_t row = first; row < last; ++row) {
+                f(archetype.entities[row], std::get<Is>(columns)[row]...);
+            }
+        }
+
+    public:
+        World() = default;
+
+        World(const World &) = delete;
+
+        World &operator=(const World &) = delete;
+
+        template<typename... Ts>
+        Entity create(const Ts &... components) {
+            using expand = int[];
+            (void) expand{0, ((void) registerComponent<Ts>(), 0)...};
+
+            Entity e;
+            if (!freeEntities.empty()) {
+                e = freeEntities.back();
+                freeEntities.pop_back();
+            } else {
+                e = (Entity) records.size();
+                records.push_back({-1, 0});
+            }
+            ++aliveCount;
+            moveEntity(e, archetypeFor(detail::maskOf<Ts...>()));
+            (void) expand{0, (*get<Ts>(e) = components, 0)...};
+            return e;
+        }
+
+        void destroy(Entity e);
+
+        bool alive(Entity e) const;
+
+        template<typename T>
+        void add(Entity e, const T &value) {
+            unsigned int id = registerComponent<T>();
+            ComponentMask mask = archetypes[records[e].archetype]->mask;
+            if (!(mask & (ComponentMask(1) << id))) {
+                moveEntity(e, archetypeFor(mask | (ComponentMask(1) << id)));
+            }
+            *get<T>(e) = value;
+        }
+
+        template<typename T>
+        void remove(Entity e) {
+            ComponentMask mask = archetypes[records[e].archetype]->mask;
+            ComponentMask bit = ComponentMask(1) << detail::componentId<T>();
+            if (mask & bit) {
+                moveEntity(e, archetypeFor(mask & ~bit));
+            }
+        }
+
+        template<typename T>
+        bool has(Entity e) const {
+            return archetypes[records[e].archetype]->mask & (ComponentMask(1) << detail::componentId<T>());
+        }
+
+        // nullptr if the entity doesn't have the component
+        template<typename T>
+        T *get(Entity e) {
+            return static_cast<T *>(component(e, detail::componentId<T>()));
+        }
+
+        size_t size() const;
+
+        /**
+         * Call f(Entity, Ts &...) for every entity that has all of Ts, walking each archetype's
+         * component arrays linearly.
+         */
+        template<typename... Ts, typename F>
+        void each(F &&f) {
+            ComponentMask required = detail::maskOf<Ts...>();
+            for (auto &archetype: archetypes) {
+                if ((archetype->mask & required) != required || archetype->entities.empty()) {
+                    continue;
+                }
+                auto columns = std::make_tuple(columnData<Ts>(*archetype)...);
+                eachRow(*archetype, 0, archetype->entities.size(), f, columns, std::index_sequence_for<Ts...>{});
+            }
+        }
+
+        // Same as each, with every archetype split across the job system. f must only touch its own row.
+        template<typename... Ts, typename F>
+        void each(JobSystem &jobs, size_t grain, F &&f) {
+            ComponentMask required = detail::maskOf<Ts...>();
+            for (auto &archetype: archetypes) {
+                if ((archetype->mask & required) != required || archetype->entities.empty()) {
+                    continue;
+                }
+                auto columns = std::make_tuple(columnData<Ts>(*archetype)...);
+                Archetype &a = *archetype;
+                jobs.parallelFor(0, a.entities.size(), grain, [&](size_t first, size_t last) {
+                    eachRow(a, first, last, f, columns, std::index_sequence_for<Ts...>{});
+                });
+            }
+        }
+    };
+}
+
+#endif //MATF_RG_PROJEKAT_WORLD_HPP
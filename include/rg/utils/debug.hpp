@@ -16,7 +16,8 @@ do{ rg::clearAllOpenGlErrors(); x; BREAK_IF_FALSE(rg::wasPreviousOpenGLCallSucce
 namespace rg {
     void clearAllOpenGlErrors();
 
-    const char *openGLErrorToString(GLenum error);
+    // error is a GLenum, spelled out so the logging and assert macros don't need glad
+    const char *openGLErrorToString(unsigned int error);
 
     bool wasPreviousOpenGLCallSuccessful(const char *file, int line, const char *call);
 }
@@ -0,0 +1,89 @@
+//
+// Created by aleksastevic on 10/19/26.
+//
+
+#ifndef MATF_RG_PROJEKAT_GLEXT_HPP
+#define MATF_RG_PROJEKAT_GLEXT_HPP
+
+#include <glad/glad.h>
+
+// glad is generated for GL 3.3 core without extensions, anything newer is declared and loaded here.
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+// GL_ARB_pipeline_statistics_query, core in 4.6 under the same value
+#ifndef GL_FRAGMENT_SHADER_INVOCATIONS
+#define GL_FRAGMENT_SHADER_INVOCATIONS 0x82F4
+#endif
+
+// GL 4.3 compute shaders and image load/store
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#endif
+
+#ifndef GL_SHADER_IMAGE_ACCESS_BARRIER_BIT
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#define GL_FRAMEBUFFER_BARRIER_BIT 0x00000400
+#endif
+
+namespace rg {
+
+    typedef void (APIENTRYP PFNRGMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect,
+                                                                 GLsizei drawCount, GLsizei stride);
+
+    typedef void (APIENTRYP PFNRGBUFFERSTORAGEPROC)(GLenum target, GLsizeiptr size, const void *data,
+                                                    GLbitfield flags);
+
+    typedef void (APIENTRYP PFNRGDISPATCHCOMPUTEPROC)(GLuint groupsX, GLuint groupsY, GLuint groupsZ);
+
+    typedef void (APIENTRYP PFNRGBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered,
+                                                       GLint layer, GLenum access, GLenum format);
+
+    typedef void (APIENTRYP PFNRGMEMORYBARRIERPROC)(GLbitfield barriers);
+
+    // Layout fixed by the GL spec for GL_DRAW_INDIRECT_BUFFER contents.
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    /**
+     * Optional entry points, null when the context doesn't provide them. Even though a 3.3 core context
+     * is requested, drivers usually hand out the newest core version they support.
+     */
+    struct GLExtensions {
+        int major = 3;
+        int minor = 3;
+        bool multiDrawIndirect = false;
+        PFNRGMULTIDRAWELEMENTSINDIRECTPROC multiDrawElementsIndirect = nullptr;
+        bool persistentMapping = false;
+        PFNRGBUFFERSTORAGEPROC bufferStorage = nullptr;
+        bool pipelineStatistics = false; // query targets only, no new entry points
+        bool computeShaders = false; // GL 4.3, with image load/store
+        PFNRGDISPATCHCOMPUTEPROC dispatchCompute = nullptr;
+        PFNRGBINDIMAGETEXTUREPROC bindImageTexture = nullptr;
+        PFNRGMEMORYBARRIERPROC memoryBarrier = nullptr;
+    };
+
+    extern GLExtensions glext;
+
+    bool hasGLVersion(int major, int minor);
+
+    bool hasGLExtension(const char *name);
+
+    // Called by loadGlad once the context is current.
+    void loadGLExtensions();
+}
+
+#endif //MATF_RG_PROJEKAT_GLEXT_HPP
@@ -33,6 +33,9 @@ namespace rg {
 
     float getDeltaTime();
 
+    // Same as getDeltaTime, without rounding to float.
+    double getDeltaTimeSeconds();
+
     glm::vec2 getMouseOffset(float mouseX, float mouseY);
 
     glm::vec3 randomVec3(float min, float max);
@@ -1,8 +1,11 @@
 #version 330 core
 
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 TexCoords;
-layout (location = 2) in vec3 aNormal;
+layout (location = 5) in mat4 model;
+layout (location = 9) in int aVariant;
+
+// every variant of rg::AsteroidMeshes, two texels per vertex: position.xyz uv.x, uv.y normal.xyz
+uniform samplerBuffer asteroidVertices;
+uniform int asteroidVertexCount;
 
 out VS_OUT {
     vec3 FragPos;
@@ -10,11 +13,19 @@ out VS_OUT {
     vec3 Normal;
 } vs_out;
 
-uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// depth pre-pass and colour pass must produce bit identical depth for GL_EQUAL
+invariant gl_Position;
+
 void main() {
+    int vertex = 2 * (aVariant * asteroidVertexCount + gl_VertexID);
+    vec4 first = texelFetch(asteroidVertices, vertex);
+    vec4 second = texelFetch(asteroidVertices, vertex + 1);
+    vec3 aPos = first.xyz;
+    vec2 TexCoords = vec2(first.w, second.x);
+    vec3 aNormal = second.yzw;
 
     vs_out.TexCoords = TexCoords;
     vs_out.Normal = normalize(mat3(transpose(inverse(model))) * aNormal);
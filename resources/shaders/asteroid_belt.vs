@@ -0,0 +1,56 @@
+#version 330 core
+
+layout (location = 3) in vec3 aOrbit;// radius, height, phase
+layout (location = 4) in vec3 aAxis;
+layout (location = 9) in int aVariant;
+
+// every variant of rg::AsteroidMeshes, two texels per vertex: position.xyz uv.x, uv.y normal.xyz
+uniform samplerBuffer asteroidVertices;
+uniform int asteroidVertexCount;
+
+out VS_OUT {
+    vec3 FragPos;
+    vec2 TexCoords;
+    vec3 Normal;
+} vs_out;
+
+uniform mat4 view;
+uniform mat4 projection;
+// wrapped on the CPU in double precision, see AsteroidBelt::angles
+uniform float orbitAngle;
+uniform float spinAngle;
+
+// same matrix as glm::rotate for a normalized axis
+mat3 axisAngle(vec3 axis, float angle) {
+    float c = cos(angle);
+    float s = sin(angle);
+    vec3 t = (1.0 - c) * axis;
+    return mat3(
+    t.x * axis.x + c, t.x * axis.y + s * axis.z, t.x * axis.z - s * axis.y,
+    t.y * axis.x - s * axis.z, t.y * axis.y + c, t.y * axis.z + s * axis.x,
+    t.z * axis.x + s * axis.y, t.z * axis.y - s * axis.x, t.z * axis.z + c
+    );
+}
+
+// depth pre-pass and colour pass must produce bit identical depth for GL_EQUAL
+invariant gl_Position;
+
+void main() {
+    int vertex = 2 * (aVariant * asteroidVertexCount + gl_VertexID);
+    vec4 first = texelFetch(asteroidVertices, vertex);
+    vec4 second = texelFetch(asteroidVertices, vertex + 1);
+    vec3 aPos = first.xyz;
+    vec2 TexCoords = vec2(first.w, second.x);
+    vec3 aNormal = second.yzw;
+
+    float angle = aOrbit.z + orbitAngle;
+    vec3 translation = vec3(aOrbit.x * sin(angle), aOrbit.y, aOrbit.x * cos(angle));
+    mat3 rotation = axisAngle(aAxis, spinAngle);
+
+    vs_out.TexCoords = TexCoords;
+    // rotation only, so the normal matrix is the rotation itself
+    vs_out.Normal = normalize(rotation * aNormal);
+    vs_out.FragPos = rotation * aPos + translation;
+
+    gl_Position = projection * view * vec4(vs_out.FragPos, 1.0);
+}
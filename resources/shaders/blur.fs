@@ -1,27 +1,32 @@
 #version 330 core
+// TAPS and HORIZONTAL are defined by rg::Blur, one program per direction and tap count.
 out vec4 FragColor;
 
 in vec2 TexCoords;
 
 uniform sampler2D image;
 
-uniform bool horizontal;
-uniform float weight[5] = float[] (0.2270270270, 0.1945945946, 0.1216216216, 0.0540540541, 0.0162162162);
+// tap 0 is the center, the others are mirrored, offsets in texels
+uniform float offsets[TAPS];
+uniform float weights[TAPS];
+// taps stop at the edge of the rendered region, past it are stale texels of a larger frame
+uniform vec2 uvMax;
+
+vec3 tap(vec2 uv) {
+    return texture(image, min(uv, uvMax)).rgb;
+}
 
 void main() {
-    vec2 tex_offset = 1.0 / textureSize(image, 0);
-    vec3 result = texture(image, TexCoords).rgb * weight[0];
-    if (horizontal) {
-        for (int i = 1; i < 5; ++i) {
-            result += texture(image, TexCoords + vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-            result += texture(image, TexCoords - vec2(tex_offset.x * i, 0.0)).rgb * weight[i];
-        }
-    } else {
-        for (int i = 1; i < 5; ++i) {
-            result += texture(image, TexCoords + vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-            result += texture(image, TexCoords - vec2(0.0, tex_offset.y * i)).rgb * weight[i];
-        }
+#if HORIZONTAL
+    vec2 texelStep = vec2(1.0 / float(textureSize(image, 0).x), 0.0);
+#else
+    vec2 texelStep = vec2(0.0, 1.0 / float(textureSize(image, 0).y));
+#endif
+    vec3 result = tap(TexCoords) * weights[0];
+    for (int i = 1; i < TAPS; ++i) {
+        result += tap(TexCoords + texelStep * offsets[i]) * weights[i];
+        result += tap(TexCoords - texelStep * offsets[i]) * weights[i];
     }
 
     FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+}
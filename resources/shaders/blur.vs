@@ -5,7 +5,10 @@ layout (location = 1) in vec2 aTexCoords;
 
 out vec2 TexCoords;
 
+// rendered region of the targets, rg::Blur::setRenderSize
+uniform vec2 uvScale;
+
 void main() {
-    TexCoords = aTexCoords;
+    TexCoords = aTexCoords * uvScale;
     gl_Position = vec4(aPos, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 330 core
+// Bright pass of the deferred path, lit.fs writes it per fragment but the lights are added up over several
+// passes, so the threshold is applied to the finished sum.
+layout (location = 0) out vec4 BrightColor;
+
+uniform sampler2D scene;
+
+void main() {
+    vec3 color = texelFetch(scene, ivec2(gl_FragCoord.xy), 0).rgb;
+    float brightness = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    if (brightness > 1.0) {
+        BrightColor = vec4(color, 1.0f);
+    } else {
+        BrightColor = vec4(0.0, 0.0, 0.0, 1.0f);
+    }
+}
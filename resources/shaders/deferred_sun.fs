@@ -0,0 +1,47 @@
+#version 330 core
+// Full-screen lighting pass of rg::DeferredRenderer, the lights lit.fs shades: the sun (and its ambient)
+// and the camera spot light. Features: SPOT_LIGHT and SHADOWS as in lit.fs.
+#include "lighting.glsl"
+#include "gbuffer.glsl"
+#ifdef SHADOWS
+#include "shadows.glsl"
+#endif
+
+layout (location = 0) out vec4 FragColor;
+
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform mat4 inverseViewProjection;
+uniform vec2 renderSize;
+
+uniform PointLight pointLight;
+#ifdef SPOT_LIGHT
+uniform SpotLight spotLight;
+#endif
+uniform vec3 viewPos;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, texel, 0).r;
+    if (depth == 1.0) {
+        // nothing lit here, the skybox fills it later
+        discard;
+    }
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, texel, 0);
+    vec3 albedo = albedoSpecular.rgb;
+    vec3 specularColor = vec3(albedoSpecular.a);
+    vec3 normal = DecodeNormal(texelFetch(gNormal, texel, 0).rg);
+    vec3 fragPos = WorldPosition(gl_FragCoord.xy, depth, renderSize, inverseViewProjection);
+
+#ifdef SHADOWS
+    float shadow = CalcPointShadow(pointLight.position, fragPos, normal);
+#else
+    float shadow = 1.0;
+#endif
+    vec3 color = CalcPointLight(pointLight, pointLight.position, fragPos, viewPos, normal, albedo, specularColor, 32.0f, shadow);
+#ifdef SPOT_LIGHT
+    color += CalcSpotLight(spotLight, spotLight.position, fragPos, viewPos, normal, albedo, specularColor, 32.0f);
+#endif
+    FragColor = vec4(color, 1.0f);
+}
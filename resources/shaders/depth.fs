@@ -0,0 +1,5 @@
+#version 330 core
+
+// Depth pre-pass, colour writes are masked off so only the depth test matters.
+void main() {
+}
@@ -0,0 +1,31 @@
+#version 330 core
+// G-buffer pass of rg::DeferredRenderer for the lit.fs vertex shaders. Features: SPECULAR_MAP as in lit.fs,
+// the specular color is stored as its average.
+#include "gbuffer.glsl"
+
+in VS_OUT {
+    vec3 FragPos;
+    vec2 TexCoords;
+    vec3 Normal;
+} fs_in;
+
+layout (location = 0) out vec4 AlbedoSpecular;
+layout (location = 1) out vec2 Normal;
+
+// rg::MaterialLibrary, same as lit.fs
+uniform sampler2DArray diffuseArray;
+uniform sampler2DArray specularArray;
+uniform isamplerBuffer materials;
+uniform int materialIndex;
+
+void main() {
+    ivec4 material = texelFetch(materials, materialIndex);
+    vec3 albedo = material.x >= 0 ? texture(diffuseArray, vec3(fs_in.TexCoords, material.x)).rgb : vec3(1.0);
+#ifdef SPECULAR_MAP
+    vec3 specularColor = material.y >= 0 ? texture(specularArray, vec3(fs_in.TexCoords, material.y)).rgb : vec3(1.0);
+#else
+    vec3 specularColor = vec3(1.0);
+#endif
+    AlbedoSpecular = vec4(albedo, dot(specularColor, vec3(1.0 / 3.0)));
+    Normal = EncodeNormal(normalize(fs_in.Normal));
+}
@@ -0,0 +1,27 @@
+// rg::DeferredRenderer G-buffer layout: albedo.rgb + specular intensity (RGBA8), octahedral normal (RG16F)
+// and the scene depth, world positions are rebuilt from depth.
+
+vec2 signNotZero(vec2 v) {
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Unit vector folded onto an octahedron and flattened to [-1, 1]^2.
+vec2 EncodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    return n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * signNotZero(n.xy);
+}
+
+vec3 DecodeNormal(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * signNotZero(n.xy);
+    }
+    return normalize(n);
+}
+
+// fragCoord in the rendered region of renderSize pixels, depth as stored in the depth buffer
+vec3 WorldPosition(vec2 fragCoord, float depth, vec2 renderSize, mat4 inverseViewProjection) {
+    vec4 ndc = vec4(fragCoord / renderSize * 2.0 - 1.0, depth * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * ndc;
+    return world.xyz / world.w;
+}
@@ -1,4 +1,10 @@
 #version 330 core
+// Features (rg::Compositor): HDR - exposure tonemapping, BLOOM - add the blurred bright pass,
+// EFFECT - 0 none, 1 grayscale, both applied here. Kernel effects need tonemapped neighbours, they resolve
+// with EFFECT 0 into a target and screen.fs runs the kernel.
+#ifndef EFFECT
+#define EFFECT 0
+#endif
 
 out vec4 FragColor;
 
@@ -6,24 +12,25 @@ in vec2 TexCoords;
 
 uniform sampler2D scene;
 uniform sampler2D bloomBlur;
-uniform bool bloom;
-uniform bool hdr;
 uniform float exposure;
 
 void main() {
     const float gamma = 2.2f;
     vec3 hdrColor = texture(scene, TexCoords).rgb;
-    vec3 bloomColor = texture(bloomBlur, TexCoords).rgb;
-
-    if (bloom) {
-        hdrColor += bloomColor;
-    }
+#ifdef BLOOM
+    hdrColor += texture(bloomBlur, TexCoords).rgb;
+#endif
 
+#ifdef HDR
+    vec3 result = vec3(1.0) - exp(-hdrColor * exposure);
+#else
     vec3 result = hdrColor;
-    if (hdr) {
-        result = vec3(1.0) - exp(-hdrColor * exposure);
-    }
+#endif
 
     result = pow(result, vec3(1.0 / gamma));
+#if EFFECT == 1
+    float avg = (dot(result, vec3(0.2126, 0.7152, 0.0722))) / 3;
+    result = vec3(avg, avg, avg);
+#endif
     FragColor = vec4(result, 1.0);
-}
\ No newline at end of file
+}
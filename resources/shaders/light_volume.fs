@@ -0,0 +1,34 @@
+#version 330 core
+// rg::DeferredRenderer: one light's contribution to the pixels its volume covers, added to the scene.
+#include "lighting.glsl"
+#include "gbuffer.glsl"
+
+flat in int LightIndex;
+
+layout (location = 0) out vec4 FragColor;
+
+uniform sampler2D gAlbedoSpecular;
+uniform sampler2D gNormal;
+uniform sampler2D gDepth;
+uniform samplerBuffer localLights;
+uniform mat4 inverseViewProjection;
+uniform vec2 renderSize;
+uniform vec3 viewPos;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, texel, 0).r;
+    vec3 fragPos = WorldPosition(gl_FragCoord.xy, depth, renderSize, inverseViewProjection);
+    vec4 positionRadius = texelFetch(localLights, 2 * LightIndex);
+    vec3 toLight = positionRadius.xyz - fragPos;
+    // background or out of range, the volume only bounds the light on screen
+    if (depth == 1.0 || dot(toLight, toLight) >= positionRadius.w * positionRadius.w) {
+        discard;
+    }
+    vec4 albedoSpecular = texelFetch(gAlbedoSpecular, texel, 0);
+    vec3 normal = DecodeNormal(texelFetch(gNormal, texel, 0).rg);
+    vec3 lightColor = texelFetch(localLights, 2 * LightIndex + 1).rgb;
+    vec3 color = CalcLocalLight(positionRadius.xyz, positionRadius.w, lightColor, fragPos, viewPos, normal,
+                                albedoSpecular.rgb, vec3(albedoSpecular.a), 32.0f);
+    FragColor = vec4(color, 1.0f);
+}
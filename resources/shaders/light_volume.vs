@@ -0,0 +1,16 @@
+#version 330 core
+// rg::DeferredRenderer: one instance per rg::LocalLights light, the unit sphere scaled to its range.
+layout (location = 0) in vec3 aPos;
+
+// two texels per light: position.xyz radius, color.rgb
+uniform samplerBuffer localLights;
+uniform mat4 view;
+uniform mat4 projection;
+
+flat out int LightIndex;
+
+void main() {
+    vec4 positionRadius = texelFetch(localLights, 2 * gl_InstanceID);
+    LightIndex = gl_InstanceID;
+    gl_Position = projection * view * vec4(positionRadius.xyz + aPos * positionRadius.w, 1.0);
+}
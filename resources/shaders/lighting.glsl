@@ -1,4 +1,4 @@
-#version 330 core
+// Blinn-Phong point and spot lights shared by the lit shaders, matches rg::PointLight and rg::SpotLight.
 
 struct PointLight {
     vec3 position;
@@ -27,45 +27,10 @@ struct SpotLight {
     vec3 specular;
 };
 
-
-vec3 CalcPointLight(PointLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, vec3 normal, vec2 texCoords, sampler2D diffuseMap, float shininess);
-vec3 CalcSpotLight(SpotLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, vec3 normal, vec2 texCoords, sampler2D diffuseMap, float shininess);
-
-in VS_OUT {
-    vec3 FragPos;
-    vec2 TexCoords;
-    vec3 Normal;
-} fs_in;
-
-layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 BrightColor;
-
-
-uniform PointLight pointLight;
-uniform SpotLight spotLight;
-uniform sampler2D texture_diffuse1;
-uniform vec3 viewPos;
-
-void main()
-{
-    vec3 result = CalcPointLight(pointLight, pointLight.position, fs_in.FragPos, viewPos, fs_in.Normal, fs_in.TexCoords, texture_diffuse1, 32.0f);
-    result += CalcSpotLight(spotLight, spotLight.position, fs_in.FragPos, viewPos, fs_in.Normal, fs_in.TexCoords, texture_diffuse1, 32.0f);
-    //    vec3 result = vec3(10.0, 0.0, 10.0);
-    FragColor = vec4(result, 1.0);
-
-    float brightness = dot(result, vec3(0.2126, 0.7152, 0.0722));
-    if (brightness > 1.0) {
-        BrightColor = vec4(result, 1.0f);
-    } else {
-        BrightColor = vec4(0.0, 0.0, 0.0, 1.0f);
-    }
-}
-
-// calculates the color when using a point light.
-vec3 CalcPointLight(PointLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, vec3 normal, vec2 texCoords, sampler2D diffuseMap, float shininess)
+// calculates the color when using a point light, shadow (0 - 1) scales everything but ambient.
+vec3 CalcPointLight(PointLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, vec3 normal, vec3 albedo, vec3 specularColor, float shininess, float shadow)
 {
     vec3 lightDir = normalize(lightPos - fragPos);
-    //    vec3 reflectDir = reflect(-lightDir, normal);
     vec3 viewDir = normalize(viewPos - fragPos);
     vec3 halfwayDir = normalize(lightDir + viewDir);
     float distance = length(lightPos - fragPos);
@@ -77,26 +42,23 @@ vec3 CalcPointLight(PointLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos,
     float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
 
     // Ambient component
-    vec3 ambient = light.ambient * vec3(texture(diffuseMap, texCoords).rgb);
+    vec3 ambient = light.ambient * albedo;
 
     // Diffuse Component
-    vec3 diffuse = light.diffuse * diff * vec3(texture(diffuseMap, texCoords).rgb);
+    vec3 diffuse = light.diffuse * diff * albedo;
 
     // Specular Component
-    vec3 specular = light.specular * spec;
-    //    if (specularMap >= 0) {
-    //        specular *= vec3(texture(specularMap, TexCoords).xxx);
-    //    }
+    vec3 specular = light.specular * spec * specularColor;
 
     // Attenuation
     ambient *= attenuation;
-    diffuse *= attenuation;
-    specular *= attenuation;
+    diffuse *= attenuation * shadow;
+    specular *= attenuation * shadow;
 
     return (ambient + diffuse + specular);
 }
 
-vec3 CalcSpotLight(SpotLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, vec3 normal, vec2 texCoords, sampler2D diffuseMap, float shininess)
+vec3 CalcSpotLight(SpotLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, vec3 normal, vec3 albedo, vec3 specularColor, float shininess)
 {
     vec3 viewDir = normalize(viewPos - fragPos);
     vec3 lightDir = normalize(lightPos - fragPos);
@@ -113,11 +75,32 @@ vec3 CalcSpotLight(SpotLight light, vec3 lightPos, vec3 fragPos, vec3 viewPos, v
     // specular shading
     float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
     // combine results
-    vec3 ambient = light.ambient * vec3(texture(diffuseMap, texCoords).rgb);
-    vec3 diffuse = light.diffuse * diff * vec3(texture(diffuseMap, texCoords).rgb);
-    vec3 specular = light.specular * spec;
+    vec3 ambient = light.ambient * albedo;
+    vec3 diffuse = light.diffuse * diff * albedo;
+    vec3 specular = light.specular * spec * specularColor;
     ambient *= attenuation * intensity;
     diffuse *= attenuation * intensity;
     specular *= attenuation * intensity;
     return (ambient + diffuse + specular);
-}
\ No newline at end of file
+}
+
+// rg::LocalLights: inverse square falloff windowed to reach zero at radius, no ambient.
+vec3 CalcLocalLight(vec3 lightPos, float radius, vec3 lightColor, vec3 fragPos, vec3 viewPos, vec3 normal, vec3 albedo, vec3 specularColor, float shininess)
+{
+    vec3 toLight = lightPos - fragPos;
+    float distance = length(toLight);
+    if (distance >= radius) {
+        return vec3(0.0);
+    }
+    vec3 lightDir = toLight / distance;
+    vec3 viewDir = normalize(viewPos - fragPos);
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+
+    float ratio = distance / radius;
+    float window = clamp(1.0 - ratio * ratio * ratio * ratio, 0.0, 1.0);
+    float attenuation = window * window / (distance * distance + 1.0);
+
+    float diff = max(dot(normal, lightDir), 0.0);
+    float spec = pow(max(dot(normal, halfwayDir), 0.0), shininess);
+    return lightColor * attenuation * (diff * albedo + spec * specularColor);
+}
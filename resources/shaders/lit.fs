@@ -0,0 +1,68 @@
+#version 330 core
+// Planets and asteroids. Features (rg::ShaderLibrary): SPOT_LIGHT - the camera spot light is on,
+// SPECULAR_MAP - specular is scaled by the material's specular layer, SHADOWS - the sun casts shadows
+// (rg::ShadowMap), LOCAL_LIGHTS - every fragment loops over all rg::LocalLights.
+#include "lighting.glsl"
+#ifdef SHADOWS
+#include "shadows.glsl"
+#endif
+
+in VS_OUT {
+    vec3 FragPos;
+    vec2 TexCoords;
+    vec3 Normal;
+} fs_in;
+
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+uniform PointLight pointLight;
+#ifdef SPOT_LIGHT
+uniform SpotLight spotLight;
+#endif
+// rg::MaterialLibrary: layers per material, x - diffuse, y - specular (-1 if missing)
+uniform sampler2DArray diffuseArray;
+uniform sampler2DArray specularArray;
+uniform isamplerBuffer materials;
+uniform int materialIndex;
+uniform vec3 viewPos;
+#ifdef LOCAL_LIGHTS
+// two texels per light: position.xyz radius, color.rgb
+uniform samplerBuffer localLights;
+uniform int localLightCount;
+#endif
+
+void main() {
+    ivec4 material = texelFetch(materials, materialIndex);
+    vec3 albedo = material.x >= 0 ? texture(diffuseArray, vec3(fs_in.TexCoords, material.x)).rgb : vec3(1.0);
+#ifdef SPECULAR_MAP
+    vec3 specularColor = material.y >= 0 ? texture(specularArray, vec3(fs_in.TexCoords, material.y)).rgb : vec3(1.0);
+#else
+    vec3 specularColor = vec3(1.0);
+#endif
+#ifdef SHADOWS
+    float shadow = CalcPointShadow(pointLight.position, fs_in.FragPos, fs_in.Normal);
+#else
+    float shadow = 1.0;
+#endif
+    vec3 color = CalcPointLight(pointLight, pointLight.position, fs_in.FragPos, viewPos, fs_in.Normal, albedo, specularColor, 32.0f, shadow);
+#ifdef SPOT_LIGHT
+    // the spot light has always taken only the red channel of the specular map
+    color += CalcSpotLight(spotLight, spotLight.position, fs_in.FragPos, viewPos, fs_in.Normal, albedo, specularColor.rrr, 32.0f);
+#endif
+#ifdef LOCAL_LIGHTS
+    for (int i = 0; i < localLightCount; ++i) {
+        vec4 positionRadius = texelFetch(localLights, 2 * i);
+        vec3 lightColor = texelFetch(localLights, 2 * i + 1).rgb;
+        color += CalcLocalLight(positionRadius.xyz, positionRadius.w, lightColor, fs_in.FragPos, viewPos, fs_in.Normal, albedo, specularColor, 32.0f);
+    }
+#endif
+    FragColor = vec4(color, 1.0f);
+
+    float brightness = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    if (brightness > 1.0) {
+        BrightColor = vec4(color, 1.0f);
+    } else {
+        BrightColor = vec4(0.0, 0.0, 0.0, 1.0f);
+    }
+}
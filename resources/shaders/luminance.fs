@@ -0,0 +1,23 @@
+#version 330 core
+// rg::AutoExposure metering: x - log luminance of lit pixels, y - 1 for lit pixels. Averaged by the mip chain,
+// x / y is the log average of what is actually lit, the black of space doesn't drag it down.
+out vec2 Metering;
+
+in vec2 TexCoords;
+
+uniform sampler2D scene;
+uniform vec2 texelSize; // of the scene
+uniform float minLuminance;
+uniform float maxLuminance;
+
+void main() {
+    // four bilinear taps cover a 4x4 block of the scene
+    vec3 color = texture(scene, TexCoords + texelSize * vec2(-1.0, -1.0)).rgb;
+    color += texture(scene, TexCoords + texelSize * vec2(1.0, -1.0)).rgb;
+    color += texture(scene, TexCoords + texelSize * vec2(-1.0, 1.0)).rgb;
+    color += texture(scene, TexCoords + texelSize * vec2(1.0, 1.0)).rgb;
+    float luminance = dot(color * 0.25, vec3(0.2126, 0.7152, 0.0722));
+
+    float lit = step(minLuminance, luminance);
+    Metering = vec2(log(clamp(luminance, minLuminance, maxLuminance)) * lit, lit);
+}
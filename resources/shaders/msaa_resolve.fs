@@ -0,0 +1,26 @@
+#version 330 core
+// rg::AntiAliasing MSAA resolve of both scene targets, SAMPLES per pixel. Colour samples are weighted by
+// 1 / (1 + luminance), a plain average of a sun edge sample and space would come out bright enough to
+// tonemap to a hard, aliased line again.
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 BrightColor;
+
+uniform sampler2DMS scene;
+uniform sampler2DMS brightPass;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec3 color = vec3(0.0);
+    vec3 bright = vec3(0.0);
+    float weights = 0.0;
+    for (int i = 0; i < SAMPLES; ++i) {
+        vec3 sampleColor = texelFetch(scene, pixel, i).rgb;
+        float weight = 1.0 / (1.0 + dot(sampleColor, vec3(0.2126, 0.7152, 0.0722)));
+        color += sampleColor * weight;
+        weights += weight;
+        // the bright pass only feeds the blur, a plain average keeps bloom energy right
+        bright += texelFetch(brightPass, pixel, i).rgb;
+    }
+    FragColor = vec4(color / weights, 1.0);
+    BrightColor = vec4(bright / float(SAMPLES), 1.0);
+}
@@ -1,68 +1,81 @@
 #version 330 core
+// EFFECT is defined by rg::Compositor: 0 - none, only stretch the rendered region to the window (SHARPEN
+// sharpens while doing it), 2 - edge detection, 3 - sharpen
+#ifndef EFFECT
+#define EFFECT 2
+#endif
+
 out vec4 FragColor;
 
 in vec2 TexCoords;
 
 uniform sampler2D screenTexture;
-uniform int effect;// 0 - none, 1 - grayscale, 2 - edge detection, 3 - sharpen
+// rendered region of screenTexture, texel centers past uvMax belong to a larger, older frame
+uniform vec2 uvScale;
+uniform vec2 uvMax;
 
-const float offset = 1.0 / 300.0;
+vec3 fetch(vec2 uv) {
+    return texture(screenTexture, min(uv, uvMax)).rgb;
+}
 
-void main() {
-
-    if (effect == 0) {
-        FragColor = texture(screenTexture, TexCoords);
-        return;
-    }
+#if EFFECT == 0
+#ifdef SHARPEN
+uniform float sharpness;
+#endif
 
-    if (effect == 1) {
-        vec3 color = texture(screenTexture, TexCoords).rgb;
-        float avg = (dot(color, vec3(0.2126, 0.7152, 0.0722))) / 3;
-        FragColor = vec4(avg, avg, avg, 1.0f);
-        return;
-    }
-
-    vec2 offsets[9] = vec2[](
-    vec2(-offset, offset),
-    vec2(0.0, offset),
-    vec2(offset, offset),
-    vec2(-offset, 0.0),
-    vec2(0.0, 0.0),
-    vec2(0.0, offset),
-    vec2(-offset, -offset),
-    vec2(0.0, -offset),
-    vec2(offset, -offset)
-    );
-
-    float kernel[9];
-    if (effect == 2) {
-        kernel = float[](
-        -1, -1, -1,
-        -1, 8, -1,
-        -1, -1, -1
-        );
-    }
-
-    if (effect == 3) {
-        kernel = float[](
-        0, -1, 0,
-        -1, 5, -1,
-        0, -1, 0
-        );
-    }
+void main() {
+#ifdef SHARPEN
+    // unsharp mask over the rendered texels, clamped to the neighbours so edges don't get halos
+    vec2 texel = 1.0 / vec2(textureSize(screenTexture, 0));
+    vec3 center = fetch(TexCoords);
+    vec3 north = fetch(TexCoords + vec2(0.0, texel.y));
+    vec3 south = fetch(TexCoords - vec2(0.0, texel.y));
+    vec3 east = fetch(TexCoords + vec2(texel.x, 0.0));
+    vec3 west = fetch(TexCoords - vec2(texel.x, 0.0));
+    vec3 low = min(center, min(min(north, south), min(east, west)));
+    vec3 high = max(center, max(max(north, south), max(east, west)));
+    vec3 sharpened = center + sharpness * (center - 0.25 * (north + south + east + west));
+    FragColor = vec4(clamp(sharpened, low, high), 1.0);
+#else
+    FragColor = vec4(fetch(TexCoords), 1.0);
+#endif
+}
+#else
+// in screen units, 1/300 of it, whatever part of the texture was rendered
+const float offset = 1.0 / 300.0;
 
+const vec2 offsets[9] = vec2[](
+vec2(-offset, offset),
+vec2(0.0, offset),
+vec2(offset, offset),
+vec2(-offset, 0.0),
+vec2(0.0, 0.0),
+vec2(offset, 0.0),
+vec2(-offset, -offset),
+vec2(0.0, -offset),
+vec2(offset, -offset)
+);
 
-    vec3 sampleTex[9];
-    for (int i = 0; i < 9; ++i) {
-        sampleTex[i] = vec3(texture(screenTexture, TexCoords.st + offsets[i]));
-    }
+#if EFFECT == 2
+const float kernel[9] = float[](
+-1.0, -1.0, -1.0,
+-1.0, 8.0, -1.0,
+-1.0, -1.0, -1.0
+);
+#else
+const float kernel[9] = float[](
+0.0, -1.0, 0.0,
+-1.0, 5.0, -1.0,
+0.0, -1.0, 0.0
+);
+#endif
 
+void main() {
     vec3 color = vec3(0.0);
     for (int i = 0; i < 9; ++i) {
-        color += sampleTex[i] * kernel[i];
+        color += fetch(TexCoords.st + offsets[i] * uvScale) * kernel[i];
     }
 
     FragColor = vec4(color, 1.0f);
-
-    //    FragColor = vec4(average, average, average, 1.0f);
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,10 @@
+#version 330 core
+// Linear distance to the light, so receivers compare distances instead of per face perspective depth.
+in vec3 WorldPos;
+
+uniform vec3 lightPos;
+uniform float farPlane;
+
+void main() {
+    gl_FragDepth = length(WorldPos - lightPos) / farPlane;
+}
@@ -0,0 +1,21 @@
+#version 330 core
+// rg::ShadowMap: every caster triangle once per cube face. The vertex shader ran with identity view and
+// projection, so gl_Position is the world position.
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 18) out;
+
+uniform mat4 faceMatrices[6];
+
+out vec3 WorldPos;
+
+void main() {
+    for (int face = 0; face < 6; ++face) {
+        gl_Layer = face;
+        for (int i = 0; i < 3; ++i) {
+            WorldPos = gl_in[i].gl_Position.xyz;
+            gl_Position = faceMatrices[face] * gl_in[i].gl_Position;
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+}
@@ -0,0 +1,39 @@
+// Point light shadows from rg::ShadowMap, included by lit shaders built with SHADOWS.
+
+// distance to the nearest caster over shadowFarPlane, compared with GL_LEQUAL
+uniform samplerCubeShadow shadowMap;
+uniform float shadowFarPlane;
+// PCF radius at distance 1 from the light, in world units
+uniform float shadowFilterSize;
+
+// 20 directions spread over a sphere, every tap is also a 2x2 bilinear comparison
+const vec3 shadowTaps[20] = vec3[](
+vec3(1, 1, 1), vec3(1, -1, 1), vec3(-1, -1, 1), vec3(-1, 1, 1),
+vec3(1, 1, -1), vec3(1, -1, -1), vec3(-1, -1, -1), vec3(-1, 1, -1),
+vec3(1, 1, 0), vec3(1, -1, 0), vec3(-1, -1, 0), vec3(-1, 1, 0),
+vec3(1, 0, 1), vec3(-1, 0, 1), vec3(1, 0, -1), vec3(-1, 0, -1),
+vec3(0, 1, 1), vec3(0, -1, 1), vec3(0, -1, -1), vec3(0, 1, -1)
+);
+
+// 1 - fully lit, 0 - in shadow
+float CalcPointShadow(vec3 lightPos, vec3 fragPos, vec3 normal) {
+    vec3 toFragment = fragPos - lightPos;
+    float distance = length(toFragment);
+    if (distance >= shadowFarPlane) {
+        return 1.0;
+    }
+    normal = normalize(normal);
+    float radius = shadowFilterSize * distance;
+    // Normal offset against acne, more at grazing angles where a texel covers a longer stretch of surface,
+    // and a texel of constant bias for what's left.
+    float cosTheta = clamp(dot(normal, -toFragment / distance), 0.05, 1.0);
+    vec3 position = fragPos + normal * radius * min(1.0 / cosTheta, 4.0);
+    vec3 direction = position - lightPos;
+    float reference = (length(direction) - radius) / shadowFarPlane;
+
+    float lit = 0.0;
+    for (int i = 0; i < 20; ++i) {
+        lit += texture(shadowMap, vec4(direction + shadowTaps[i] * radius, reference));
+    }
+    return lit / 20.0;
+}
@@ -0,0 +1,76 @@
+#version 330 core
+// rg::AntiAliasing TAA resolve: blend the jittered scene into the history reprojected with camera motion.
+out vec4 FragColor;
+
+uniform sampler2D scene;
+uniform sampler2D depthTexture;
+uniform sampler2D history;
+// rendered region of all three, rg::DynamicResolution
+uniform ivec2 renderSize;
+uniform vec2 uvScale;
+// this frame's NDC to last frame's clip space, both without jitter
+uniform mat4 reprojection;
+// weight of the current frame, 1 starts the history over
+uniform float blendFactor;
+
+vec3 toYCoCg(vec3 c) {
+    return vec3(dot(c, vec3(0.25, 0.5, 0.25)), dot(c, vec3(0.5, 0.0, -0.5)), dot(c, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 fromYCoCg(vec3 c) {
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+// Tonemapped space for blending and clamping, so a few very bright samples can't dominate the average.
+vec3 compress(vec3 c) {
+    return c / (1.0 + dot(c, vec3(0.2126, 0.7152, 0.0722)));
+}
+
+vec3 uncompress(vec3 c) {
+    return c / max(1.0 - dot(c, vec3(0.2126, 0.7152, 0.0722)), 1.0e-4);
+}
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 last = renderSize - 1;
+
+    // neighbourhood bounds, and the nearest depth around the pixel so edges move with the closer surface
+    vec3 current = vec3(0.0);
+    vec3 minColor = vec3(1.0e9);
+    vec3 maxColor = vec3(-1.0e9);
+    float depth = 1.0;
+    ivec2 nearest = pixel;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            ivec2 p = clamp(pixel + ivec2(x, y), ivec2(0), last);
+            vec3 c = toYCoCg(compress(texelFetch(scene, p, 0).rgb));
+            if (x == 0 && y == 0) {
+                current = c;
+            }
+            minColor = min(minColor, c);
+            maxColor = max(maxColor, c);
+            float d = texelFetch(depthTexture, p, 0).r;
+            if (d < depth) {
+                depth = d;
+                nearest = p;
+            }
+        }
+    }
+
+    // camera motion vector of the nearest surface, in [0, 1] across the rendered region
+    vec2 uv = (vec2(nearest) + 0.5) / vec2(renderSize);
+    vec4 previous = reprojection * vec4(vec3(uv, depth) * 2.0 - 1.0, 1.0);
+    vec2 motion = (previous.xy / previous.w * 0.5 + 0.5) - uv;
+    vec2 previousUV = (vec2(pixel) + 0.5) / vec2(renderSize) + motion;
+
+    float weight = blendFactor;
+    if (any(lessThan(previousUV, vec2(0.0))) || any(greaterThan(previousUV, vec2(1.0)))) {
+        weight = 1.0; // came from outside the last frame
+    }
+    vec3 previousColor = toYCoCg(compress(texture(history, previousUV * uvScale).rgb));
+    // history the current neighbourhood can't explain belongs to something that moved or got uncovered
+    previousColor = clamp(previousColor, minColor, maxColor);
+
+    vec3 result = mix(previousColor, current, weight);
+    FragColor = vec4(uncompress(max(fromYCoCg(result), vec3(0.0))), 1.0);
+}
@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <string>
+
+#include <rg/AntiAliasing.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+        // Radical inverse of index in the given base, in [0, 1).
+        float halton(int index, int base) {
+            float result = 0.0f;
+            float fraction = 1.0f / (float) base;
+            while (index > 0) {
+                result += fraction * (float) (index % base);
+                index /= base;
+                fraction /= (float) base;
+            }
+            return result;
+        }
+    }
+
+    AntiAliasing::AntiAliasing(int width, int height, unsigned int sceneFBO, unsigned int sceneTexture,
+                               unsigned int depthTexture, unsigned int quadVAO, ShaderLibrary &shaders)
+            : width(width), height(height), renderWidth(width), renderHeight(height), sceneFBO(sceneFBO), sceneTexture(sceneTexture),
+              depthTexture(depthTexture), quadVAO(quadVAO), shaders(shaders), timer(GL_TIME_ELAPSED) {
+    }
+
+    const char *AntiAliasing::name(Mode mode) {
+        switch (mode) {
+            case Mode::MSAA:
+                return "MSAA";
+            case Mode::TAA:
+                return "TAA";
+            default:
+                return "off";
+        }
+    }
+
+    void AntiAliasing::setRenderSize(int width, int height) {
+        width = std::min(width, this->width);
+        height = std::min(height, this->height);
+        if (width != renderWidth || height != renderHeight) {
+            resetHistory();
+        }
+        renderWidth = width;
+        renderHeight = height;
+    }
+
+    void AntiAliasing::createMultisampled() {
+        if (msaaSamples) {
+            return;
+        }
+        GLint maxSamples = 0;
+        glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+        msaaSamples = std::max(1, std::min(samples, (int) maxSamples));
+        glGenFramebuffers(1, &msaaFBO);
+        glGenTextures(2, msaaTextures);
+        glGenRenderbuffers(1, &msaaDepth);
+        glBindFramebuffer(GL_FRAMEBUFFER, msaaFBO);
+        for (unsigned int i = 0; i < 2; ++i) {
+            glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, msaaTextures[i]);
+            glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, msaaSamples, packedHdrFormat.internalFormat, width,
+                                    height, GL_TRUE);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D_MULTISAMPLE,
+                                   msaaTextures[i], 0);
+        }
+        glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+        glBindRenderbuffer(GL_RENDERBUFFER, msaaDepth);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, msaaSamples, depthFormat.internalFormat, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, msaaDepth);
+        unsigned int attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, attachments);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "MSAA framebuffer not complete!");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // written by the scene, each sample read once by the resolve
+        renderTargets.track("msaa scene", width, height, packedHdrFormat, 2.0f, 1, msaaSamples);
+        renderTargets.track("msaa bright pass", width, height, packedHdrFormat, 2.0f, 1, msaaSamples);
+        renderTargets.track("msaa depth", width, height, depthFormat, 2.0f, 1, msaaSamples);
+    }
+
+    void AntiAliasing::createHistory() {
+        if (historyTextures[0]) {
+            return;
+        }
+        glGenFramebuffers(2, historyFBOs);
+        for (unsigned int i = 0; i < 2; ++i) {
+            // written by the resolve, read back by the next one, the composite and metering
+            historyTextures[i] = renderTargets.createTexture("taa history " + std::to_string(i), width, height,
+                                                             packedHdrFormat, 2.0f);
+            glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0);
+            ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "TAA framebuffer not complete!");
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        historyValid = false;
+    }
+
+    glm::mat4 AntiAliasing::beginFrame(const Camera &camera, float aspect) {
+        if (mode != lastMode) {
+            resetHistory();
+            lastMode = mode;
+        }
+        if (mode == Mode::MSAA) {
+            createMultisampled();
+        } else if (mode == Mode::TAA) {
+            createHistory();
+        }
+
+        ++frame;
+        offset = glm::vec2(0.0f);
+        if (mode == Mode::TAA) {
+            // Halton from index 1, index 0 would put a sample on the pixel corner every cycle
+            int index = (int) (frame % jitterPhases) + 1;
+            offset = glm::vec2(halton(index, 2), halton(index, 3)) - glm::vec2(0.5f);
+        }
+        glm::mat4 view = camera.getViewMatrix();
+        glm::mat4 projection = camera.getPerspectiveMatrix(aspect, offset,
+                                                           glm::vec2((float) renderWidth, (float) renderHeight));
+        previousViewProjection = unjitteredViewProjection;
+        unjitteredViewProjection = camera.getPerspectiveMatrix(aspect) * view;
+        return projection;
+    }
+
+    unsigned int AntiAliasing::framebuffer() const {
+        return mode == Mode::MSAA ? msaaFBO : sceneFBO;
+    }
+
+    void AntiAliasing::resetHistory() {
+        historyValid = false;
+    }
+
+    glm::vec2 AntiAliasing::jitter() const {
+        return offset;
+    }
+
+    void AntiAliasing::drawQuad() const {
+        glBindVertexArray(quadVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+        frameStats.drawCalls++;
+    }
+
+    unsigned int AntiAliasing::resolve() {
+        if (mode == Mode::None) {
+            return sceneTexture;
+        }
+
+        timer.begin();
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, renderWidth, renderHeight);
+        glm::vec2 uvScale((float) renderWidth / width, (float) renderHeight / height);
+        // full-screen passes, neither target's depth may reject them
+        glDisable(GL_DEPTH_TEST);
+        unsigned int result = sceneTexture;
+        if (mode == Mode::MSAA) {
+            auto setup = [](const Shader &shader) {
+                shader.setInt("scene", 0);
+                shader.setInt("brightPass", 1);
+            };
+            const Shader &shader = shaders.get("resources/shaders/hdr.vs", "resources/shaders/msaa_resolve.fs",
+                                               {"SAMPLES " + std::to_string(msaaSamples)}, setup);
+            glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+            shader.use();
+            shader.setVec2("uvScale", uvScale);
+            for (unsigned int i = 0; i < 2; ++i) {
+                glActiveTexture(GL_TEXTURE0 + i);
+                glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, msaaTextures[i]);
+            }
+            glActiveTexture(GL_TEXTURE0);
+            drawQuad();
+        } else {
+            auto setup = [](const Shader &shader) {
+                shader.setInt("scene", 0);
+                shader.setInt("depthTexture", 1);
+                shader.setInt("history", 2);
+            };
+            const Shader &shader = shaders.get("resources/shaders/hdr.vs", "resources/shaders/taa.fs", {}, setup);
+            glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[current]);
+            shader.use();
+            shader.setVec2("uvScale", uvScale);
+            shader.setIVec2("renderSize", renderWidth, renderHeight);
+            // Both without jitter: with a still camera the motion is zero and the jittered samples land on the
+            // same history pixels, that is what accumulates them into a supersampled image.
+            shader.setMat4("reprojection", previousViewProjection * glm::inverse(unjitteredViewProjection));
+            shader.setFloat("blendFactor", historyValid ? blendFactor : 1.0f);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, sceneTexture);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, depthTexture);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, historyTextures[1 - current]);
+            glActiveTexture(GL_TEXTURE0);
+            drawQuad();
+            result = historyTextures[current];
+            current = 1 - current;
+            historyValid = true;
+        }
+        glEnable(GL_DEPTH_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        timer.end();
+        return result;
+    }
+
+    double AntiAliasing::resolveMilliseconds() const {
+        return mode == Mode::None ? 0.0 : timer.milliseconds();
+    }
+
+    size_t AntiAliasing::memoryUsage() const {
+        size_t pixels = (size_t) width * height;
+        if (mode == Mode::MSAA) {
+            return pixels * msaaSamples * (2 * packedHdrFormat.bytesPerPixel + depthFormat.bytesPerPixel);
+        }
+        if (mode == Mode::TAA) {
+            return pixels * 2 * packedHdrFormat.bytesPerPixel;
+        }
+        return 0;
+    }
+}
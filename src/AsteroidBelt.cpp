@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/AsteroidBelt.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/utils/utils.hpp>
+
+namespace rg {
+
+    AsteroidBelt::AsteroidBelt(int count, float radius, float spread)
+            : visibleInstances(count), orbits(count), axes(count) {
+        float interval = glm::radians(360.0f) / count;
+        for (int i = 0; i < count; ++i) {
+            orbits[i] = glm::vec3(rg::random(-spread, spread) + radius, rg::random(-spread, spread), i * interval);
+            axes[i] = glm::normalize(rg::randomVec3(-1.0f, 1.0f));
+            batch.add(orbits[i].x, orbits[i].y, orbits[i].z, axes[i]);
+        }
+    }
+
+    int AsteroidBelt::size() const {
+        return (int) orbits.size();
+    }
+
+    int AsteroidBelt::visibleCount() const {
+        return visibleInstances;
+    }
+
+    size_t AsteroidBelt::frameBytes(int count) {
+        return (size_t) count * (std::max(sizeof(glm::mat4), sizeof(CulledInstance)) + sizeof(glm::mat4));
+    }
+
+    glm::vec2 AsteroidBelt::angles(double time) const {
+        const double turn = 2.0 * M_PI;
+        return {(float) std::fmod(time * orbitSpeed, turn), (float) std::fmod(glm::radians(time * spinSpeed), turn)};
+    }
+
+    glm::mat4 AsteroidBelt::modelMatrix(int i, double time) const {
+        glm::vec2 a = angles(time);
+        float angle = orbits[i].z + a.x;
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(orbits[i].x * std::sin(angle), orbits[i].y,
+                                                orbits[i].x * std::cos(angle)));
+        model = glm::rotate(model, a.y, axes[i]);
+        return model;
+    }
+
+    void AsteroidBelt::setupInstancing(unsigned int meshVAO, int variantCount) {
+        VAO = meshVAO;
+        std::vector<glm::vec3> instanceData;
+        instanceData.reserve(orbits.size() * 2);
+        for (int i = 0; i < size(); ++i) {
+            instanceData.push_back(orbits[i]);
+            instanceData.push_back(axes[i]);
+        }
+
+        glGenBuffers(1, &instanceVBO);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(glm::vec3), &instanceData[0], GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) 0);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) sizeof(glm::vec3));
+        glVertexAttribDivisor(4, 1);
+
+        variants.resize(orbits.size());
+        for (int &variant: variants) {
+            variant = std::min((int) rg::random(0.0f, (float) variantCount), variantCount - 1);
+        }
+        glGenBuffers(1, &variantVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, variantVBO);
+        glBufferData(GL_ARRAY_BUFFER, variants.size() * sizeof(int), &variants[0], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(9);
+        glVertexAttribIPointer(9, 1, GL_INT, sizeof(int), (void *) 0);
+        glVertexAttribDivisor(9, 1);
+
+        // asteroid_belt.vs fetches its vertices, a pass over the whole belt only needs the indices and the
+        // static attributes, in a VAO of its own so culling never rebinds them
+        GLint elementBuffer = 0;
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer);
+        glGenVertexArrays(1, &allInstancesVAO);
+        glBindVertexArray(allInstancesVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) 0);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) sizeof(glm::vec3));
+        glVertexAttribDivisor(4, 1);
+        glBindBuffer(GL_ARRAY_BUFFER, variantVBO);
+        glEnableVertexAttribArray(9);
+        glVertexAttribIPointer(9, 1, GL_INT, sizeof(int), (void *) 0);
+        glVertexAttribDivisor(9, 1);
+
+        // the same for asteroid.vs, matrices (attributes 5-8) are pointed at the stream when drawn
+        glGenVertexArrays(1, &allMatricesVAO);
+        glBindVertexArray(allMatricesVAO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, variantVBO);
+        glEnableVertexAttribArray(9);
+        glVertexAttribIPointer(9, 1, GL_INT, sizeof(int), (void *) 0);
+        glVertexAttribDivisor(9, 1);
+        for (unsigned int i = 0; i < 4; ++i) {
+            glEnableVertexAttribArray(5 + i);
+            glVertexAttribDivisor(5 + i, 1);
+        }
+
+        glBindVertexArray(0);
+    }
+
+    glm::mat4 *AsteroidBelt::mapMatrices(StreamBuffer &stream, GLintptr &offset) const {
+        return (glm::mat4 *) stream.map(size() * sizeof(glm::mat4), sizeof(glm::vec4), offset);
+    }
+
+    void AsteroidBelt::bindMatrices(const StreamBuffer &stream, GLintptr offset) {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.id());
+        for (unsigned int i = 0; i < 4; ++i) {
+            glEnableVertexAttribArray(5 + i);
+            glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void *) (offset + i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(5 + i, 1);
+        }
+        glBindVertexArray(0);
+        useStaticInstances();
+    }
+
+    void AsteroidBelt::useStaticInstances() {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) 0);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) sizeof(glm::vec3));
+        glBindBuffer(GL_ARRAY_BUFFER, variantVBO);
+        glVertexAttribIPointer(9, 1, GL_INT, sizeof(int), (void *) 0);
+        glBindVertexArray(0);
+        visibleInstances = size();
+    }
+
+    void AsteroidBelt::bindCulled(const StreamBuffer &stream, GLintptr offset) const {
+        const GLsizei stride = sizeof(CulledInstance);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.id());
+        for (unsigned int i = 0; i < 4; ++i) {
+            glEnableVertexAttribArray(5 + i);
+            glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, stride,
+                                  (void *) (offset + offsetof(CulledInstance, model) + i * sizeof(glm::vec4)));
+            glVertexAttribDivisor(5 + i, 1);
+        }
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void *) (offset + offsetof(CulledInstance, orbit)));
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void *) (offset + offsetof(CulledInstance, axis)));
+        glVertexAttribIPointer(9, 1, GL_INT, stride, (void *) (offset + offsetof(CulledInstance, variant)));
+        glBindVertexArray(0);
+    }
+
+    void AsteroidBelt::bindOrbits(const StreamBuffer &stream, GLintptr offset) const {
+        const GLsizei stride = sizeof(OrbitInstance);
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.id());
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride, (void *) (offset + offsetof(OrbitInstance, orbit)));
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, stride, (void *) (offset + offsetof(OrbitInstance, axis)));
+        glVertexAttribIPointer(9, 1, GL_INT, stride, (void *) (offset + offsetof(OrbitInstance, variant)));
+        glBindVertexArray(0);
+    }
+
+    void AsteroidBelt::streamVisible(const OcclusionBuffer &culler, JobSystem &jobs, StreamBuffer &stream) {
+        visible.resize(orbits.size());
+        jobs.parallelFor(0, orbits.size(), 1024, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                visible[i] = culler.isVisible(glm::vec3(matrices[i][3]), boundingRadius);
+            }
+        });
+
+        auto count = (int) std::count(visible.begin(), visible.end(), 1);
+        GLintptr offset;
+        auto *out = (CulledInstance *) stream.map(std::max(count, 1) * sizeof(CulledInstance), sizeof(glm::vec4),
+                                                  offset);
+        int written = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (visible[i]) {
+                out[written++] = {matrices[i], orbits[i], variants[i], axes[i], 0.0f};
+            }
+        }
+        stream.unmap();
+        bindCulled(stream, offset);
+        visibleInstances = written;
+    }
+
+    void AsteroidBelt::updateMatrices(double time, JobSystem &jobs, StreamBuffer &stream,
+                                      const OcclusionBuffer *culler) {
+        matricesCulled = culler != nullptr;
+        if (culler) {
+            matrices.resize(orbits.size());
+            glm::vec2 a = angles(time);
+            auto *out = (float *) matrices.data();
+            jobs.parallelFor(0, batch.size(), 1024, [&](size_t first, size_t last) {
+                buildOrbitTransforms(batch, a.x, a.y, out + first * 16, first, last - first);
+            });
+            streamVisible(*culler, jobs, stream);
+            return;
+        }
+
+        GLintptr offset;
+        auto *out = (float *) mapMatrices(stream, offset);
+        glm::vec2 a = angles(time);
+        float orbitAngle = a.x;
+        float spinAngle = a.y;
+        jobs.parallelFor(0, batch.size(), 1024, [&](size_t first, size_t last) {
+            buildOrbitTransforms(batch, orbitAngle, spinAngle, out + first * 16, first, last - first);
+        });
+        stream.unmap();
+        bindMatrices(stream, offset);
+    }
+
+    int AsteroidBelt::cullOrbits(double time, JobSystem &jobs, const OcclusionBuffer &culler) {
+        float orbitAngle = angles(time).x;
+        float sinAngle = std::sin(orbitAngle);
+        float cosAngle = std::cos(orbitAngle);
+        visible.resize(orbits.size());
+        jobs.parallelFor(0, batch.size(), 1024, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                // translation column of buildOrbitTransforms, from the same sine/cosine pairs
+                float s = batch.sinPhase[i] * cosAngle + batch.cosPhase[i] * sinAngle;
+                float c = batch.cosPhase[i] * cosAngle - batch.sinPhase[i] * sinAngle;
+                glm::vec3 center(batch.radius[i] * s, batch.height[i], batch.radius[i] * c);
+                visible[i] = culler.isVisible(center, boundingRadius);
+            }
+        });
+        return (int) std::count(visible.begin(), visible.end(), 1);
+    }
+
+    const std::vector<unsigned char> &AsteroidBelt::visibility() const {
+        return visible;
+    }
+
+    void AsteroidBelt::updateVisible(double time, JobSystem &jobs, StreamBuffer &stream,
+                                     const OcclusionBuffer &culler) {
+        int count = cullOrbits(time, jobs, culler);
+        GLintptr offset;
+        auto *out = (OrbitInstance *) stream.map(std::max(count, 1) * sizeof(OrbitInstance), sizeof(glm::vec4),
+                                                 offset);
+        int written = 0;
+        for (int i = 0; i < size(); ++i) {
+            if (visible[i]) {
+                out[written++] = {orbits[i], variants[i], axes[i], 0.0f};
+            }
+        }
+        stream.unmap();
+        bindOrbits(stream, offset);
+        visibleInstances = written;
+    }
+
+    void AsteroidBelt::seedBodies(NBody &bodies, double time, float centralMass, float particleMass) const {
+        bodies.clear();
+        float orbitAngle = angles(time).x;
+        for (int i = 0; i < size(); ++i) {
+            float angle = orbits[i].z + orbitAngle;
+            float speed = std::sqrt(bodies.gravity * centralMass / orbits[i].x);
+            glm::vec3 position(orbits[i].x * std::sin(angle), orbits[i].y, orbits[i].x * std::cos(angle));
+            glm::vec3 velocity(speed * std::cos(angle), 0.0f, -speed * std::sin(angle));
+            bodies.addParticle(position, velocity, particleMass);
+        }
+    }
+
+    void AsteroidBelt::updateMatrices(const NBody &bodies, double time, JobSystem &jobs, StreamBuffer &stream,
+                                      const OcclusionBuffer *culler) {
+        ASSERT(bodies.size() == orbits.size(), "N-body particles don't match the asteroid belt.");
+        matricesCulled = culler != nullptr;
+        GLintptr offset = 0;
+        if (culler) {
+            matrices.resize(orbits.size());
+        }
+        glm::mat4 *out = culler ? matrices.data() : mapMatrices(stream, offset);
+        float spinAngle = angles(time).y;
+        jobs.parallelFor(0, bodies.size(), 1024, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                out[i] = glm::rotate(glm::translate(glm::mat4(1.0f), bodies.position(i)), spinAngle, axes[i]);
+            }
+        });
+        if (culler) {
+            streamVisible(*culler, jobs, stream);
+            return;
+        }
+        stream.unmap();
+        bindMatrices(stream, offset);
+    }
+
+    void AsteroidBelt::drawInstanced(GLsizei indexCount) const {
+        glBindVertexArray(VAO);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, visibleInstances);
+        frameStats.drawCalls++;
+        frameStats.meshes += visibleInstances;
+        glBindVertexArray(0);
+    }
+
+    void AsteroidBelt::drawAllMatrices(StreamBuffer &stream, GLsizei indexCount) {
+        if (!matricesCulled) {
+            // the last update streamed every matrix already
+            drawInstanced(indexCount);
+            return;
+        }
+        GLintptr offset;
+        glm::mat4 *out = mapMatrices(stream, offset);
+        std::copy(matrices.begin(), matrices.end(), out);
+        stream.unmap();
+
+        glBindVertexArray(allMatricesVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, stream.id());
+        for (unsigned int i = 0; i < 4; ++i) {
+            glVertexAttribPointer(5 + i, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void *) (offset + i * sizeof(glm::vec4)));
+        }
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, size());
+        frameStats.drawCalls++;
+        frameStats.meshes += size();
+        glBindVertexArray(0);
+    }
+
+    void AsteroidBelt::drawAllInstanced(GLsizei indexCount) const {
+        glBindVertexArray(allInstancesVAO);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, size());
+        frameStats.drawCalls++;
+        frameStats.meshes += size();
+        glBindVertexArray(0);
+    }
+}
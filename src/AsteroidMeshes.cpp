@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <random>
+#include <utility>
+
+#include <rg/AsteroidMeshes.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+
+        struct Icosphere {
+            std::vector<glm::vec3> directions;
+            std::vector<glm::vec2> texCoords;
+            // vertex whose normal this one shares, itself except for the copies on the uv seam and the poles
+            std::vector<unsigned int> welded;
+            std::vector<unsigned int> indices;
+        };
+
+        Icosphere icosphere(int subdivisions) {
+            const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+            Icosphere sphere;
+            sphere.directions = {
+                    {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0},
+                    {0, -1, t}, {0, 1, t}, {0, -1, -t}, {0, 1, -t},
+                    {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+            };
+            sphere.indices = {
+                    0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+                    1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+                    3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+                    4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+            };
+            for (glm::vec3 &d: sphere.directions) {
+                d = glm::normalize(d);
+            }
+
+            for (int s = 0; s < subdivisions; ++s) {
+                std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+                auto midpoint = [&](unsigned int a, unsigned int b) {
+                    auto key = std::make_pair(std::min(a, b), std::max(a, b));
+                    auto it = midpoints.find(key);
+                    if (it != midpoints.end()) {
+                        return it->second;
+                    }
+                    auto index = (unsigned int) sphere.directions.size();
+                    sphere.directions.push_back(glm::normalize(sphere.directions[a] + sphere.directions[b]));
+                    midpoints.emplace(key, index);
+                    return index;
+                };
+
+                std::vector<unsigned int> next;
+                next.reserve(sphere.indices.size() * 4);
+                for (size_t i = 0; i < sphere.indices.size(); i += 3) {
+                    unsigned int a = sphere.indices[i], b = sphere.indices[i + 1], c = sphere.indices[i + 2];
+                    unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+                    next.insert(next.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+                }
+                sphere.indices = std::move(next);
+            }
+
+            // Spherical u wraps from 1 back to 0 where atan2 crosses pi. Triangles across that line get
+            // copies of their low u vertices with u + 1, otherwise the whole texture is squeezed into them.
+            // The poles have no u of their own, every triangle there gets a copy halfway between its others.
+            sphere.texCoords.resize(sphere.directions.size());
+            sphere.welded.resize(sphere.directions.size());
+            for (size_t i = 0; i < sphere.directions.size(); ++i) {
+                const glm::vec3 &d = sphere.directions[i];
+                sphere.texCoords[i] = glm::vec2(0.5f + std::atan2(d.z, d.x) / (2.0f * (float) M_PI),
+                                                0.5f - std::asin(d.y) / (float) M_PI);
+                sphere.welded[i] = (unsigned int) i;
+            }
+            auto copyVertex = [&](unsigned int vertex, float u) {
+                auto copy = (unsigned int) sphere.directions.size();
+                glm::vec3 direction = sphere.directions[vertex];
+                sphere.directions.push_back(direction);
+                sphere.texCoords.emplace_back(u, sphere.texCoords[vertex].y);
+                sphere.welded.push_back(vertex);
+                return copy;
+            };
+            auto isPole = [&](unsigned int vertex) {
+                return std::abs(sphere.directions[vertex].y) > 0.9999f;
+            };
+            std::map<unsigned int, unsigned int> seamCopies;
+            for (size_t i = 0; i < sphere.indices.size(); i += 3) {
+                // across the seam when moving the low half over by one turn makes the triangle narrower
+                float lo = 2.0f, hi = -1.0f, shiftedLo = 2.0f, shiftedHi = -1.0f;
+                for (size_t k = i; k < i + 3; ++k) {
+                    if (isPole(sphere.indices[k])) {
+                        continue;
+                    }
+                    float u = sphere.texCoords[sphere.indices[k]].x;
+                    float shifted = u < 0.5f ? u + 1.0f : u;
+                    lo = std::min(lo, u);
+                    hi = std::max(hi, u);
+                    shiftedLo = std::min(shiftedLo, shifted);
+                    shiftedHi = std::max(shiftedHi, shifted);
+                }
+                if (shiftedHi - shiftedLo < hi - lo) {
+                    for (size_t k = i; k < i + 3; ++k) {
+                        unsigned int vertex = sphere.indices[k];
+                        if (isPole(vertex) || sphere.texCoords[vertex].x >= 0.5f) {
+                            continue;
+                        }
+                        auto it = seamCopies.find(vertex);
+                        if (it == seamCopies.end()) {
+                            unsigned int copy = copyVertex(vertex, sphere.texCoords[vertex].x + 1.0f);
+                            it = seamCopies.emplace(vertex, copy).first;
+                        }
+                        sphere.indices[k] = it->second;
+                    }
+                }
+                for (size_t k = i; k < i + 3; ++k) {
+                    if (isPole(sphere.indices[k])) {
+                        float u = (sphere.texCoords[sphere.indices[i + (k - i + 1) % 3]].x +
+                                   sphere.texCoords[sphere.indices[i + (k - i + 2) % 3]].x) / 2.0f;
+                        sphere.indices[k] = copyVertex(sphere.indices[k], u);
+                    }
+                }
+            }
+            return sphere;
+        }
+
+        float hash(int x, int y, int z, unsigned int seed) {
+            unsigned int h = seed;
+            h ^= (unsigned int) x * 0x8da6b343u;
+            h ^= (unsigned int) y * 0xd8163841u;
+            h ^= (unsigned int) z * 0xcb1ab31fu;
+            h ^= h >> 13;
+            h *= 0x5bd1e995u;
+            h ^= h >> 15;
+            return (float) (h & 0xffffffu) / (float) 0xffffff * 2.0f - 1.0f;
+        }
+
+        // Trilinear value noise with smoothstep fade, in [-1, 1].
+        float valueNoise(const glm::vec3 &p, unsigned int seed) {
+            glm::vec3 cell(std::floor(p.x), std::floor(p.y), std::floor(p.z));
+            glm::vec3 f = p - cell;
+            glm::vec3 u(f.x * f.x * (3.0f - 2.0f * f.x), f.y * f.y * (3.0f - 2.0f * f.y),
+                        f.z * f.z * (3.0f - 2.0f * f.z));
+            int x = (int) cell.x, y = (int) cell.y, z = (int) cell.z;
+
+            float result = 0.0f;
+            for (int corner = 0; corner < 8; ++corner) {
+                int dx = corner & 1, dy = (corner >> 1) & 1, dz = (corner >> 2) & 1;
+                float weight = (dx ? u.x : 1.0f - u.x) * (dy ? u.y : 1.0f - u.y) * (dz ? u.z : 1.0f - u.z);
+                result += weight * hash(x + dx, y + dy, z + dz, seed);
+            }
+            return result;
+        }
+
+        float fractalNoise(glm::vec3 p, unsigned int seed) {
+            float sum = 0.0f;
+            float amplitude = 0.5f;
+            for (int octave = 0; octave < 4; ++octave) {
+                sum += amplitude * valueNoise(p, seed + octave);
+                p *= 2.0f;
+                amplitude *= 0.5f;
+            }
+            return sum;
+        }
+
+        void generateVariant(const Icosphere &sphere, unsigned int seed, AsteroidVertex *out) {
+            std::mt19937 engine(seed);
+            std::uniform_real_distribution<float> stretch(0.7f, 1.2f);
+            glm::vec3 shape(stretch(engine), stretch(engine), stretch(engine));
+
+            for (size_t i = 0; i < sphere.directions.size(); ++i) {
+                const glm::vec3 &d = sphere.directions[i];
+                float radius = 0.5f * (1.0f + 0.6f * fractalNoise(d * 1.5f, seed));
+                out[i].position = d * shape * radius;
+                out[i].texCoords = sphere.texCoords[i];
+                out[i].normal = glm::vec3(0.0f);
+            }
+
+            // smooth normals of the displaced surface, area weighted, seam copies summed with their originals
+            for (size_t i = 0; i < sphere.indices.size(); i += 3) {
+                const AsteroidVertex &a = out[sphere.indices[i]];
+                const AsteroidVertex &b = out[sphere.indices[i + 1]];
+                const AsteroidVertex &c = out[sphere.indices[i + 2]];
+                glm::vec3 n = glm::cross(b.position - a.position, c.position - a.position);
+                for (size_t k = i; k < i + 3; ++k) {
+                    out[sphere.welded[sphere.indices[k]]].normal += n;
+                }
+            }
+            for (size_t i = 0; i < sphere.directions.size(); ++i) {
+                out[i].normal = glm::normalize(out[sphere.welded[i]].normal);
+            }
+        }
+    }
+
+    AsteroidMeshes::AsteroidMeshes(int variants, int subdivisions, unsigned int seed, JobSystem &jobs)
+            : variantCount(variants) {
+        Icosphere sphere = icosphere(subdivisions);
+        verticesPerVariant = (int) sphere.directions.size();
+
+        vertices.resize((size_t) variantCount * verticesPerVariant);
+        jobs.parallelFor(0, (size_t) variantCount, 1, [&](size_t first, size_t last) {
+            for (size_t v = first; v < last; ++v) {
+                generateVariant(sphere, seed + (unsigned int) v * 7919u, &vertices[v * verticesPerVariant]);
+            }
+        });
+        indices = std::move(sphere.indices);
+    }
+
+    int AsteroidMeshes::variants() const {
+        return variantCount;
+    }
+
+    int AsteroidMeshes::vertexCount() const {
+        return verticesPerVariant;
+    }
+
+    GLsizei AsteroidMeshes::indexCount() const {
+        return (GLsizei) indices.size();
+    }
+
+    GLint AsteroidMeshes::baseVertex(int variant) const {
+        return variant * verticesPerVariant;
+    }
+
+    float AsteroidMeshes::boundingRadius() const {
+        float radius = 0.0f;
+        for (const AsteroidVertex &vertex: vertices) {
+            radius = std::max(radius, glm::length(vertex.position));
+        }
+        return radius;
+    }
+
+    size_t AsteroidMeshes::memoryUsage() const {
+        return vertices.size() * sizeof(AsteroidVertex) + indices.size() * sizeof(unsigned int);
+    }
+
+    void AsteroidMeshes::setupMesh() {
+        static_assert(sizeof(AsteroidVertex) == 2 * 4 * sizeof(float), "Vertex must be two RGBA32F texels.");
+        GLint maxTexels = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+        // GL 3.3 only guarantees 65536 texels, fewer variants beat not starting at all
+        int fitting = maxTexels / (2 * verticesPerVariant);
+        if (variantCount > fitting) {
+            LOG(std::cerr) << variantCount << " asteroid variants need " << vertices.size() * 2
+                           << " texels, the buffer texture holds " << maxTexels << ", keeping " << fitting << '\n';
+            ASSERT(fitting > 0, "Not even one asteroid variant fits in a buffer texture.");
+            variantCount = fitting;
+            vertices.resize((size_t) variantCount * verticesPerVariant);
+        }
+
+        glGenVertexArrays(1, &VAO);
+        glGenBuffers(1, &VBO);
+        glGenBuffers(1, &EBO);
+
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(AsteroidVertex), &vertices[0], GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(indices[0]), &indices[0], GL_STATIC_DRAW);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(AsteroidVertex),
+                              (void *) (offsetof(AsteroidVertex, position)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(AsteroidVertex),
+                              (void *) (offsetof(AsteroidVertex, texCoords)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(AsteroidVertex),
+                              (void *) (offsetof(AsteroidVertex, normal)));
+        glBindVertexArray(0);
+
+        glGenTextures(1, &TBO);
+        glBindTexture(GL_TEXTURE_BUFFER, TBO);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, VBO);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    unsigned int AsteroidMeshes::vao() const {
+        return VAO;
+    }
+
+    unsigned int AsteroidMeshes::vertexTexture() const {
+        return TBO;
+    }
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <rg/AutoExposure.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    AutoExposure::AutoExposure(int sceneWidth, int sceneHeight, unsigned int quadVAO, ShaderLibrary &shaders)
+            : width(std::max(1, sceneWidth / 5)), height(std::max(1, sceneHeight / 5)), quadVAO(quadVAO),
+              timer(GL_TIME_ELAPSED), shaders(shaders) {
+        levels = 1 + (int) std::floor(std::log2((float) std::max(width, height)));
+
+        glGenTextures(1, &meteringTexture);
+        glBindTexture(GL_TEXTURE_2D, meteringTexture);
+        glTexImage2D(GL_TEXTURE_2D, 0, meteringFormat.internalFormat, width, height, 0, meteringFormat.format,
+                     meteringFormat.type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        renderTargets.track("luminance", width, height, meteringFormat, 1.0f, levels);
+
+        glGenFramebuffers(1, &meteringFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, meteringFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, meteringTexture, 0);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Metering framebuffer not complete!");
+        glGenFramebuffers(1, &readFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, readFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, meteringTexture, levels - 1);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Metering framebuffer not complete!");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        glGenBuffers(ringSize, pixelBuffers);
+        for (unsigned int pixelBuffer: pixelBuffers) {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffer);
+            glBufferData(GL_PIXEL_PACK_BUFFER, 4 * sizeof(float), nullptr, GL_STREAM_READ);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+
+    void AutoExposure::setRenderSize(int sceneWidth, int sceneHeight) {
+        // the metering target is a fifth of the full scene size
+        uvScale = glm::vec2(std::min((float) sceneWidth / (width * 5.0f), 1.0f),
+                            std::min((float) sceneHeight / (height * 5.0f), 1.0f));
+    }
+
+    void AutoExposure::meter(unsigned int scene) {
+        ++frame;
+        if (fences[next]) {
+            // the GPU is more than ringSize frames behind, rather skip a measurement than wait for it
+            ++stats.skipped;
+            return;
+        }
+
+        auto setup = [](const Shader &shader) {
+            shader.setInt("scene", 0);
+        };
+        const Shader &shader = shaders.get("resources/shaders/hdr.vs", "resources/shaders/luminance.fs", {}, setup);
+
+        timer.begin();
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glBindFramebuffer(GL_FRAMEBUFFER, meteringFBO);
+        glViewport(0, 0, width, height);
+        shader.use();
+        shader.setVec2("uvScale", uvScale);
+        shader.setVec2("texelSize", glm::vec2(1.0f / (width * 5.0f), 1.0f / (height * 5.0f)));
+        shader.setFloat("minLuminance", minLuminance);
+        shader.setFloat("maxLuminance", maxLuminance);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene);
+        glBindVertexArray(quadVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+        frameStats.drawCalls++;
+
+        glBindTexture(GL_TEXTURE_2D, meteringTexture);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        // into the pixel buffer, glReadPixels returns right away
+        auto start = std::chrono::steady_clock::now();
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[next]);
+        glReadPixels(0, 0, 1, 1, GL_RGBA, GL_FLOAT, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        stats.maxReadbackMilliseconds = std::max(stats.maxReadbackMilliseconds, elapsed.count());
+        fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        issuedFrame[next] = frame;
+        next = (next + 1) % ringSize;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        timer.end();
+    }
+
+    void AutoExposure::poll() {
+        // oldest first, stop at the first one that isn't done
+        for (int i = 0; i < ringSize; ++i) {
+            int slot = (next + i) % ringSize;
+            if (!fences[slot]) {
+                continue;
+            }
+            GLenum status = glClientWaitSync(fences[slot], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                ++stats.notReady;
+                return;
+            }
+            glDeleteSync(fences[slot]);
+            fences[slot] = nullptr;
+
+            auto start = std::chrono::steady_clock::now();
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pixelBuffers[slot]);
+            auto *texel = (const float *) glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, 4 * sizeof(float),
+                                                           GL_MAP_READ_BIT);
+            if (texel) {
+                // x is the average of log luminance * lit, y the lit fraction
+                if (texel[1] > 0.0f) {
+                    averageLuminance = std::exp(texel[0] / texel[1]);
+                }
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            stats.maxReadbackMilliseconds = std::max(stats.maxReadbackMilliseconds, elapsed.count());
+            stats.latencyFrames = frame - issuedFrame[slot];
+            ++stats.readbacks;
+        }
+    }
+
+    float AutoExposure::update(float exposure, float deltaTime) {
+        poll();
+        if (averageLuminance <= 0.0f) {
+            return exposure;
+        }
+        float target = glm::clamp(key / averageLuminance, minExposure, maxExposure);
+        // adapt in log space so brightening and darkening feel the same
+        float blend = 1.0f - std::exp(-deltaTime * adaptationSpeed);
+        return std::exp(glm::mix(std::log(exposure), std::log(target), blend));
+    }
+
+    float AutoExposure::luminance() const {
+        return averageLuminance;
+    }
+
+    double AutoExposure::meteringMilliseconds() const {
+        return timer.milliseconds();
+    }
+}
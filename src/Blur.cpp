@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <rg/Blur.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+#include <rg/utils/glext.hpp>
+
+namespace rg {
+
+    int Blur::Kernel::fetches() const {
+        return 2 * (int) offsets.size() - 1;
+    }
+
+    Blur::Blur(int width, int height, unsigned int quadVAO, ShaderLibrary &shaders)
+            : targetWidth(width), targetHeight(height), renderWidth(width), renderHeight(height), quadVAO(quadVAO),
+              shaders(shaders) {
+        glGenFramebuffers(2, framebuffers);
+        for (unsigned int i = 0; i < 2; ++i) {
+            // linear filtering is what lets one fetch cover two taps, createTexture sets it
+            textures[i] = renderTargets.createTexture("blur " + std::to_string(i), width, height, packedHdrFormat,
+                                                      2.0f);
+            glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, textures[i], 0);
+            ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Blur framebuffer not complete!");
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void Blur::setRenderSize(int width, int height) {
+        renderWidth = std::min(width, targetWidth);
+        renderHeight = std::min(height, targetHeight);
+    }
+
+    Blur::Kernel Blur::gaussianKernel(float sigma, int radius, bool linearSampling) {
+        ASSERT(sigma > 0.0f && radius >= 0, "Invalid blur kernel.");
+        std::vector<float> weights(radius + 1);
+        float sum = 0.0f;
+        for (int k = 0; k <= radius; ++k) {
+            weights[k] = std::exp(-(float) (k * k) / (2.0f * sigma * sigma));
+            sum += k == 0 ? weights[k] : 2.0f * weights[k];
+        }
+        for (float &weight: weights) {
+            weight /= sum;
+        }
+
+        Kernel kernel;
+        kernel.offsets.push_back(0.0f);
+        kernel.weights.push_back(weights[0]);
+        if (!linearSampling) {
+            for (int k = 1; k <= radius; ++k) {
+                kernel.offsets.push_back((float) k);
+                kernel.weights.push_back(weights[k]);
+            }
+            return kernel;
+        }
+        for (int k = 1; k <= radius; k += 2) {
+            float a = weights[k];
+            float b = k + 1 <= radius ? weights[k + 1] : 0.0f;
+            // sampling between texels k and k + 1 at this offset returns (a * t_k + b * t_k+1) / (a + b)
+            kernel.offsets.push_back(((float) k * a + (float) (k + 1) * b) / (a + b));
+            kernel.weights.push_back(a + b);
+        }
+        return kernel;
+    }
+
+    std::pair<int, float> Blur::iterationsFor(float radius) const {
+        float sigma = std::max(radius, 1.0f) / 3.0f;
+        float passSigma = (float) maxPassRadius / 3.0f;
+        int iterations = std::max(1, (int) std::ceil((sigma / passSigma) * (sigma / passSigma)));
+        return {iterations, sigma / std::sqrt((float) iterations)};
+    }
+
+    const Shader &Blur::program(int taps, bool horizontal, bool computeShader) {
+        std::vector<std::string> features{"TAPS " + std::to_string(taps), horizontal ? "HORIZONTAL 1" : "HORIZONTAL 0"};
+        auto setup = [](const Shader &shader) {
+            shader.setInt("image", 0);
+        };
+        if (computeShader) {
+            features.push_back(std::string("IMAGE_FORMAT ") + packedHdrFormat.imageFormat);
+            return shaders.getCompute("resources/shaders/blur.comp", features, setup);
+        }
+        return shaders.get("resources/shaders/blur.vs", "resources/shaders/blur.fs", features, setup);
+    }
+
+    void Blur::pass(const Shader &shader, const std::vector<float> &offsets, const std::vector<float> &weights,
+                    unsigned int source, int target) {
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[target]);
+        shader.use();
+        shader.setFloats("offsets", offsets.data(), (int) offsets.size());
+        shader.setFloats("weights", weights.data(), (int) weights.size());
+        shader.setVec2("uvScale", (float) renderWidth / targetWidth, (float) renderHeight / targetHeight);
+        // center of the last texel in the region
+        shader.setVec2("uvMax", (renderWidth - 0.5f) / targetWidth, (renderHeight - 0.5f) / targetHeight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glBindVertexArray(quadVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        frameStats.drawCalls++;
+    }
+
+    void Blur::computePass(const Shader &shader, const std::vector<float> &weights, unsigned int source, int target,
+                           bool horizontal) {
+        // matches TILE in blur.comp
+        const int tile = 128;
+        shader.use();
+        shader.setFloats("weights", weights.data(), (int) weights.size());
+        shader.setIVec2("size", renderWidth, renderHeight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glext.bindImageTexture(0, textures[target], 0, GL_FALSE, 0, GL_WRITE_ONLY, packedHdrFormat.internalFormat);
+        if (horizontal) {
+            glext.dispatchCompute((renderWidth + tile - 1) / tile, renderHeight, 1);
+        } else {
+            glext.dispatchCompute(renderWidth, (renderHeight + tile - 1) / tile, 1);
+        }
+        // the next pass samples what this one stored
+        glext.memoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        frameStats.drawCalls++;
+    }
+
+    unsigned int Blur::apply(unsigned int source, float radius) {
+        std::pair<int, float> iterations = iterationsFor(radius);
+        float sigma = iterations.second;
+        if (compute) {
+            ASSERT(glext.computeShaders, "Compute blur needs GL 4.3.");
+            // every tap is a shared memory read, folding would only cost precision
+            Kernel kernel = gaussianKernel(sigma, std::max(1, (int) std::ceil(3.0f * sigma)), false);
+            int taps = (int) kernel.weights.size();
+            for (int i = 0; i < iterations.first; ++i) {
+                computePass(program(taps, true, true), kernel.weights, i == 0 ? source : textures[1], 0, true);
+                computePass(program(taps, false, true), kernel.weights, textures[0], 1, false);
+            }
+            return textures[1];
+        }
+
+        Kernel kernel = gaussianKernel(sigma, std::max(1, (int) std::ceil(3.0f * sigma)), linearSampling);
+        int taps = (int) kernel.offsets.size();
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glViewport(0, 0, renderWidth, renderHeight);
+        for (int i = 0; i < iterations.first; ++i) {
+            pass(program(taps, true, false), kernel.offsets, kernel.weights, i == 0 ? source : textures[1], 0);
+            pass(program(taps, false, false), kernel.offsets, kernel.weights, textures[0], 1);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        return textures[1];
+    }
+
+    void Blur::benchmark(unsigned int source, const std::vector<float> &radii) {
+        const char *modeNames[] = {"naive", "linear", "compute"};
+        bool linear = linearSampling;
+        bool computeEnabled = compute;
+        int modes = glext.computeShaders ? 3 : 2;
+        unsigned int query;
+        glGenQueries(1, &query);
+        LOG(std::cout) << "blur " << renderWidth << "x" << renderHeight << ", max pass radius " << maxPassRadius << '\n';
+        for (float radius: radii) {
+            std::pair<int, float> iterations = iterationsFor(radius);
+            int passRadius = std::max(1, (int) std::ceil(3.0f * iterations.second));
+            LOG(std::cout) << "radius " << radius << ": " << iterations.first << " x (H + V), "
+                           << gaussianKernel(iterations.second, passRadius, false).fetches() << " -> "
+                           << gaussianKernel(iterations.second, passRadius, true).fetches()
+                           << " fetches per pass\n";
+            for (int mode = 0; mode < modes; ++mode) {
+                linearSampling = mode == 1;
+                compute = mode == 2;
+                apply(source, radius); // compile and warm up outside the timed run
+                glBeginQuery(GL_TIME_ELAPSED, query);
+                apply(source, radius);
+                glEndQuery(GL_TIME_ELAPSED);
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+                double passMilliseconds = (double) elapsed / 1.0e6 / (2 * iterations.first);
+                double bytes = (double) renderWidth * renderHeight * 2 * packedHdrFormat.bytesPerPixel;
+                LOG(std::cout) << "  " << modeNames[mode] << ": " << passMilliseconds << " ms per pass, "
+                               << bytes / (passMilliseconds * 1.0e6) << " GB/s effective\n";
+            }
+        }
+        glDeleteQueries(1, &query);
+        linearSampling = linear;
+        compute = computeEnabled;
+    }
+}
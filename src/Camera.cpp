@@ -30,6 +30,14 @@ namespace rg {
         return glm::perspective(glm::radians(fov), aspect, zNear, zFar);
     }
 
+    glm::mat4 Camera::getPerspectiveMatrix(float aspect, const glm::vec2 &jitter, const glm::vec2 &viewportSize) const {
+        glm::mat4 projection = getPerspectiveMatrix(aspect);
+        // clip w is -z, so these terms move NDC by exactly 2 * jitter / viewportSize at every depth
+        projection[2][0] -= 2.0f * jitter.x / viewportSize.x;
+        projection[2][1] -= 2.0f * jitter.y / viewportSize.y;
+        return projection;
+    }
+
     void Camera::move(Direction direction, float deltaTime) {
         float velocity = movementSpeed * deltaTime;
         switch (direction) {
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <string>
+
+#include <rg/Compositor.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    Compositor::Compositor(int width, int height, unsigned int quadVAO, ShaderLibrary &shaders)
+            : width(width), height(height), renderWidth(width), renderHeight(height), quadVAO(quadVAO),
+              shaders(shaders) {
+        // hdr.fs already tonemapped and gamma encoded what lands here, 8 bits hold it as well as the window does
+        intermediateTexture = renderTargets.createTexture("composite intermediate", width, height, ldrFormat, 2.0f);
+        glGenFramebuffers(1, &intermediateFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, intermediateFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, intermediateTexture, 0);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Compositor framebuffer not complete!");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void Compositor::setRenderSize(int width, int height) {
+        renderWidth = std::min(width, this->width);
+        renderHeight = std::min(height, this->height);
+    }
+
+    bool Compositor::needsNeighbours(int effect) {
+        return effect == 2 || effect == 3;
+    }
+
+    int Compositor::passes(int effect) const {
+        bool upscaling = renderWidth != width || renderHeight != height;
+        return needsNeighbours(effect) || (sharpen && upscaling) ? 2 : 1;
+    }
+
+    size_t Compositor::bytesPerFrame(int effect) const {
+        // packed scene and bloom in, RGBA8 window out (taken as target sized), plus an RGBA8 write and read
+        // of the rendered region for a second pass
+        size_t region = (size_t) renderWidth * renderHeight;
+        size_t in = region * 2 * packedHdrFormat.bytesPerPixel;
+        size_t out = (size_t) width * height * ldrFormat.bytesPerPixel;
+        return passes(effect) == 2 ? in + 2 * region * ldrFormat.bytesPerPixel + out : in + out;
+    }
+
+    std::vector<std::string> Compositor::features(int effect, bool hdr, bool bloom) {
+        std::vector<std::string> keys{"EFFECT " + std::to_string(effect)};
+        if (hdr) {
+            keys.emplace_back("HDR");
+        }
+        if (bloom) {
+            keys.emplace_back("BLOOM");
+        }
+        return keys;
+    }
+
+    void Compositor::drawQuad() const {
+        glBindVertexArray(quadVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+        frameStats.drawCalls++;
+    }
+
+    void Compositor::apply(unsigned int scene, unsigned int bloomTexture, bool hdr, bool bloom, float exposure,
+                           int effect) {
+        bool kernel = needsNeighbours(effect);
+        bool secondPass = passes(effect) == 2;
+        glm::vec2 uvScale((float) renderWidth / width, (float) renderHeight / height);
+        auto setupResolve = [](const Shader &shader) {
+            shader.setInt("scene", 0);
+            shader.setInt("bloomBlur", 1);
+        };
+        const Shader &resolve = shaders.get("resources/shaders/hdr.vs", "resources/shaders/hdr.fs",
+                                            features(kernel ? 0 : effect, hdr, bloom), setupResolve);
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        if (secondPass) {
+            glBindFramebuffer(GL_FRAMEBUFFER, intermediateFBO);
+            glViewport(0, 0, renderWidth, renderHeight);
+        } else {
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            // depth test is still on, the quad would fail against last frame's depth
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        }
+        resolve.use();
+        resolve.setVec2("uvScale", uvScale);
+        resolve.setFloat("exposure", exposure);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, bloomTexture);
+        glActiveTexture(GL_TEXTURE0);
+        drawQuad();
+        if (!secondPass) {
+            return;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        auto setupEffect = [](const Shader &shader) {
+            shader.setInt("screenTexture", 0);
+        };
+        // grayscale already happened in the resolve, without a kernel this pass only upscales
+        std::vector<std::string> screenFeatures{"EFFECT " + std::to_string(kernel ? effect : 0)};
+        if (sharpen && !kernel) {
+            screenFeatures.emplace_back("SHARPEN");
+        }
+        const Shader &kernelEffect = shaders.get("resources/shaders/screen.vs", "resources/shaders/screen.fs",
+                                                 screenFeatures, setupEffect);
+        kernelEffect.use();
+        kernelEffect.setVec2("uvScale", uvScale);
+        kernelEffect.setVec2("uvMax", (renderWidth - 0.5f) / width, (renderHeight - 0.5f) / height);
+        kernelEffect.setFloat("sharpness", sharpness);
+        glBindTexture(GL_TEXTURE_2D, intermediateTexture);
+        drawQuad();
+    }
+}
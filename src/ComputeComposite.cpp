@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include <rg/ComputeComposite.hpp>
+#include <rg/Compositor.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+#include <rg/utils/glext.hpp>
+
+namespace rg {
+
+    ComputeComposite::ComputeComposite(int width, int height, ShaderLibrary &shaders)
+            : width(width), height(height), renderWidth(width), renderHeight(height), shaders(shaders) {
+        // screen.fs offsets its kernel taps by 1/300 of the screen
+        haloX = "HALO_X " + std::to_string(std::max(1, (int) std::lround(width / 300.0)));
+        haloY = "HALO_Y " + std::to_string(std::max(1, (int) std::lround(height / 300.0)));
+
+        outputTexture = renderTargets.createTexture("compute composite", width, height, ldrFormat, 2.0f);
+
+        glGenFramebuffers(1, &outputFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, outputTexture, 0);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Composite framebuffer not complete!");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void ComputeComposite::setRenderSize(int width, int height) {
+        renderWidth = std::min(width, this->width);
+        renderHeight = std::min(height, this->height);
+    }
+
+    void ComputeComposite::apply(unsigned int scene, unsigned int bloomTexture, bool hdr, bool bloom, float exposure,
+                                 int effect) {
+        const int group = 16; // GROUP in post.comp
+        std::vector<std::string> features = Compositor::features(effect, hdr, bloom);
+        features.push_back(haloX);
+        features.push_back(haloY);
+        auto setup = [](const Shader &program) {
+            program.setInt("scene", 0);
+            program.setInt("bloomBlur", 1);
+        };
+        const Shader &shader = shaders.getCompute("resources/shaders/post.comp", features, setup);
+        shader.use();
+        shader.setFloat("exposure", exposure);
+        shader.setIVec2("size", renderWidth, renderHeight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, scene);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, bloomTexture);
+        glActiveTexture(GL_TEXTURE0);
+        glext.bindImageTexture(0, outputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, ldrFormat.internalFormat);
+        glext.dispatchCompute((renderWidth + group - 1) / group, (renderHeight + group - 1) / group, 1);
+        // present reads the image through a blit
+        glext.memoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+        frameStats.drawCalls++;
+    }
+
+    void ComputeComposite::present() const {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, outputFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+        bool scaled = viewport[2] != renderWidth || viewport[3] != renderHeight;
+        glBlitFramebuffer(0, 0, renderWidth, renderHeight, viewport[0], viewport[1], viewport[0] + viewport[2],
+                          viewport[1] + viewport[3], GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    size_t ComputeComposite::bytesPerFrame() const {
+        // packed scene and bloom in, RGBA8 out
+        return (size_t) renderWidth * renderHeight * (2 * packedHdrFormat.bytesPerPixel + ldrFormat.bytesPerPixel);
+    }
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <rg/DeferredRenderer.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+        const int sphereSlices = 16;
+        const int sphereStacks = 8;
+    }
+
+    DeferredRenderer::DeferredRenderer(int width, int height, unsigned int depthTexture, unsigned int sceneTexture,
+                                       unsigned int brightTexture, unsigned int quadVAO, ShaderLibrary &shaders)
+            : width(width), height(height), renderWidth(width), renderHeight(height), depthTexture(depthTexture),
+              sceneTexture(sceneTexture), brightTexture(brightTexture), quadVAO(quadVAO), timer(GL_TIME_ELAPSED),
+              shaders(shaders) {
+    }
+
+    void DeferredRenderer::setRenderSize(int width, int height) {
+        renderWidth = std::min(width, this->width);
+        renderHeight = std::min(height, this->height);
+    }
+
+    void DeferredRenderer::create() {
+        if (gBufferFBO) {
+            return;
+        }
+        // written by the geometry pass, read by the sun pass and wherever light volumes cover
+        gBufferTextures[0] = renderTargets.createTexture("g-buffer albedo specular", width, height, ldrFormat, 2.0f);
+        gBufferTextures[1] = renderTargets.createTexture("g-buffer normal", width, height, normalFormat, 2.0f);
+        glGenFramebuffers(1, &gBufferFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, gBufferFBO);
+        for (unsigned int i = 0; i < 2; ++i) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, gBufferTextures[i], 0);
+        }
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+        unsigned int attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, attachments);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "G-buffer not complete!");
+
+        // Lighting reads the depth texture, so it must not be attached: the scene colour alone. Volumes
+        // can't be depth tested then, pixels out of a light's range are discarded in the shader instead.
+        glGenFramebuffers(1, &lightFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneTexture, 0);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Light framebuffer not complete!");
+
+        glGenFramebuffers(1, &brightFBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, brightFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, brightTexture, 0);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Bright framebuffer not complete!");
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        createSphere();
+    }
+
+    void DeferredRenderer::createSphere() {
+        // Faces of a UV sphere dip below the unit sphere by up to cos of half a step in each direction,
+        // scaled out so the volume covers the light's whole range.
+        const float PI = glm::radians(180.0f);
+        float cover = std::cos(PI / (float) sphereSlices) * std::cos(PI / (float) (2 * sphereStacks));
+        std::vector<glm::vec3> vertices;
+        for (int stack = 0; stack <= sphereStacks; ++stack) {
+            float theta = PI * (float) stack / (float) sphereStacks;
+            for (int slice = 0; slice <= sphereSlices; ++slice) {
+                float phi = 2.0f * PI * (float) slice / (float) sphereSlices;
+                vertices.push_back(glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                             std::sin(theta) * std::sin(phi)) / cover);
+            }
+        }
+        // counter-clockwise seen from outside
+        std::vector<unsigned int> indices;
+        for (int stack = 0; stack < sphereStacks; ++stack) {
+            for (int slice = 0; slice < sphereSlices; ++slice) {
+                unsigned int a = stack * (sphereSlices + 1) + slice;
+                unsigned int b = a + 1;
+                unsigned int c = a + sphereSlices + 1;
+                unsigned int d = c + 1;
+                indices.insert(indices.end(), {a, b, c, b, d, c});
+            }
+        }
+        sphereIndexCount = (GLsizei) indices.size();
+
+        glGenVertexArrays(1, &sphereVAO);
+        glGenBuffers(2, sphereBuffers);
+        glBindVertexArray(sphereVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, sphereBuffers[0]);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), &vertices[0], GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void *) 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereBuffers[1]);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBindVertexArray(0);
+    }
+
+    unsigned int DeferredRenderer::framebuffer() {
+        create();
+        return gBufferFBO;
+    }
+
+    void DeferredRenderer::drawQuad() const {
+        glBindVertexArray(quadVAO);
+        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        glBindVertexArray(0);
+        frameStats.drawCalls++;
+    }
+
+    void DeferredRenderer::light(const glm::mat4 &view, const glm::mat4 &projection, const glm::vec3 &viewPos,
+                                 const PointLight &sun, const SpotLight *spotLight, const ShadowMap *shadowMap,
+                                 const LocalLights &localLights) {
+        create();
+        timer.begin();
+        glm::mat4 inverseViewProjection = glm::inverse(projection * view);
+        glm::vec2 renderSize((float) renderWidth, (float) renderHeight);
+        glm::vec2 uvScale(renderSize.x / (float) width, renderSize.y / (float) height);
+        auto setupGBuffer = [](const Shader &shader) {
+            shader.setInt("gAlbedoSpecular", 0);
+            shader.setInt("gNormal", 1);
+            shader.setInt("gDepth", 2);
+        };
+        for (unsigned int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, i < 2 ? gBufferTextures[i] : depthTexture);
+        }
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+        glViewport(0, 0, renderWidth, renderHeight);
+        glDisable(GL_DEPTH_TEST);
+
+        // sun, its ambient and the spot light cover every lit pixel
+        std::vector<std::string> features;
+        if (spotLight) {
+            features.emplace_back("SPOT_LIGHT");
+        }
+        if (shadowMap) {
+            features.emplace_back("SHADOWS");
+        }
+        const Shader &sunShader = shaders.get("resources/shaders/hdr.vs", "resources/shaders/deferred_sun.fs",
+                                              features, setupGBuffer);
+        sunShader.use();
+        sunShader.setVec2("uvScale", uvScale);
+        sunShader.setVec2("renderSize", renderSize);
+        sunShader.setMat4("inverseViewProjection", inverseViewProjection);
+        sunShader.setVec3("viewPos", viewPos);
+        sunShader.setLight("pointLight", sun);
+        if (spotLight) {
+            sunShader.setLight("spotLight", *spotLight);
+        }
+        if (shadowMap) {
+            shadowMap->bind(sunShader);
+        }
+        drawQuad();
+
+        if (localLights.count > 0) {
+            const Shader &volumeShader = shaders.get("resources/shaders/light_volume.vs",
+                                                     "resources/shaders/light_volume.fs", {}, setupGBuffer);
+            volumeShader.use();
+            volumeShader.setMat4("view", view);
+            volumeShader.setMat4("projection", projection);
+            volumeShader.setVec2("renderSize", renderSize);
+            volumeShader.setMat4("inverseViewProjection", inverseViewProjection);
+            volumeShader.setVec3("viewPos", viewPos);
+            localLights.bind(volumeShader);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_ONE, GL_ONE);
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_FRONT);
+            glBindVertexArray(sphereVAO);
+            glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, localLights.count);
+            glBindVertexArray(0);
+            frameStats.drawCalls++;
+            glCullFace(GL_BACK);
+            glDisable(GL_CULL_FACE);
+            glDisable(GL_BLEND);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, brightFBO);
+        const Shader &brightShader = shaders.get("resources/shaders/hdr.vs", "resources/shaders/bright.fs", {},
+                                                 [](const Shader &shader) {
+                                                     shader.setInt("scene", 0);
+                                                 });
+        brightShader.use();
+        brightShader.setVec2("uvScale", uvScale);
+        glBindTexture(GL_TEXTURE_2D, sceneTexture);
+        drawQuad();
+
+        glEnable(GL_DEPTH_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        timer.end();
+    }
+
+    double DeferredRenderer::lightingMilliseconds() const {
+        return timer.milliseconds();
+    }
+
+    size_t DeferredRenderer::memoryUsage() const {
+        if (!gBufferFBO) {
+            return 0;
+        }
+        return (size_t) width * height * (ldrFormat.bytesPerPixel + normalFormat.bytesPerPixel);
+    }
+}
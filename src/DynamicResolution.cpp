@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rg/DynamicResolution.hpp>
+
+namespace rg {
+
+    DynamicResolution::DynamicResolution(int maxWidth, int maxHeight) : maxWidth(maxWidth), maxHeight(maxHeight) {
+    }
+
+    void DynamicResolution::beginFrame() {
+        if (!queries[0][0]) {
+            // created on first use, so a controller driven only through update() never needs a context
+            glGenQueries(2 * ringSize, &queries[0][0]);
+        }
+        measuring = false;
+        int slot = frame % ringSize;
+        if (pending[slot]) {
+            // issued ringSize frames ago, normally long finished
+            GLuint beginAvailable = GL_FALSE;
+            GLuint endAvailable = GL_FALSE;
+            glGetQueryObjectuiv(queries[slot][0], GL_QUERY_RESULT_AVAILABLE, &beginAvailable);
+            glGetQueryObjectuiv(queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &endAvailable);
+            if (!beginAvailable || !endAvailable) {
+                // the GPU is that far behind, skip this frame's sample rather than wait for it
+                return;
+            }
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(queries[slot][0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(queries[slot][1], GL_QUERY_RESULT, &end);
+            pending[slot] = false;
+            update((double) (end - begin) / 1.0e6);
+        }
+        glQueryCounter(queries[slot][0], GL_TIMESTAMP);
+        measuring = true;
+    }
+
+    void DynamicResolution::endFrame() {
+        if (!measuring) {
+            return;
+        }
+        int slot = frame % ringSize;
+        glQueryCounter(queries[slot][1], GL_TIMESTAMP);
+        pending[slot] = true;
+        ++frame;
+    }
+
+    float DynamicResolution::update(double gpuMilliseconds) {
+        if (spikeFrames > 0) {
+            gpuMilliseconds += spikeMilliseconds * currentScale * currentScale;
+            --spikeFrames;
+        }
+        filteredMilliseconds = filteredMilliseconds < 0.0 ? gpuMilliseconds
+                                                          : filteredMilliseconds +
+                                                            smoothing * (gpuMilliseconds - filteredMilliseconds);
+        if (settleFrames > 0) {
+            --settleFrames;
+        } else if (enabled) {
+            // cost ~ pixels ~ scale^2
+            float ideal = currentScale * (float) std::sqrt(targetMilliseconds * headroom / filteredMilliseconds);
+            ideal = std::min(std::max(ideal, minScale), maxScale);
+            float step = std::min(std::max(ideal - currentScale, -maxStep), maxStep);
+            if (std::abs(step) >= deadband) {
+                currentScale += step;
+                // the queries in flight still measure the old scale
+                settleFrames = ringSize;
+            }
+        } else {
+            currentScale = maxScale;
+        }
+        if (traceFrames > 0) {
+            trace.push_back({(long long) trace.size(), gpuMilliseconds, filteredMilliseconds, currentScale});
+            --traceFrames;
+        }
+        return currentScale;
+    }
+
+    void DynamicResolution::injectSpike(double milliseconds, int frames, int tracedFrames) {
+        spikeMilliseconds = milliseconds;
+        spikeFrames = frames;
+        traceFrames = tracedFrames;
+        trace.clear();
+    }
+
+    bool DynamicResolution::traceReady() const {
+        return traceFrames == 0 && !trace.empty();
+    }
+
+    void DynamicResolution::writeTrace(std::ostream &out) const {
+        out << "frame, GPU ms, smoothed ms, scale\n";
+        for (const Sample &sample: trace) {
+            out << sample.frame << ", " << sample.gpuMilliseconds << ", " << sample.filteredMilliseconds << ", "
+                << sample.scale << '\n';
+        }
+    }
+
+    float DynamicResolution::scale() const {
+        return currentScale;
+    }
+
+    int DynamicResolution::width() const {
+        return std::max(1, (int) std::lround(maxWidth * currentScale));
+    }
+
+    int DynamicResolution::height() const {
+        return std::max(1, (int) std::lround(maxHeight * currentScale));
+    }
+
+    glm::vec2 DynamicResolution::uvScale() const {
+        return {(float) width() / (float) maxWidth, (float) height() / (float) maxHeight};
+    }
+
+    double DynamicResolution::milliseconds() const {
+        return filteredMilliseconds;
+    }
+}
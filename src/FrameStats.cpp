@@ -0,0 +1,15 @@
+#include <rg/FrameStats.hpp>
+
+namespace rg {
+
+    FrameStats frameStats;
+
+    void FrameStats::reset() {
+        *this = FrameStats();
+    }
+
+    std::ostream &operator<<(std::ostream &os, const FrameStats &stats) {
+        return os << "draw calls: " << stats.drawCalls << ", meshes: " << stats.meshes << ", texture binds: "
+                  << stats.textureBinds << ", culled asteroids: " << stats.culledInstances;
+    }
+}
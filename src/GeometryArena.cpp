@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+#include <rg/GeometryArena.hpp>
+#include <rg/FrameStats.hpp>
+
+namespace rg {
+
+    namespace {
+        // New buffer of the given size holding the first used bytes of the old one, which is deleted.
+        unsigned int resizeBuffer(unsigned int old, GLsizeiptr used, GLsizeiptr size) {
+            unsigned int buffer;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+            if (old) {
+                glBindBuffer(GL_COPY_READ_BUFFER, old);
+                glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, used);
+                glDeleteBuffers(1, &old);
+            }
+            return buffer;
+        }
+    }
+
+    GeometryArena::GeometryArena(StreamBuffer &frameData, GLsizeiptr vertexCapacity, GLsizeiptr indexCapacity)
+            : frameData(frameData), vertexCapacity(vertexCapacity), indexCapacity(indexCapacity) {
+        glGenVertexArrays(1, &VAO);
+        VBO = resizeBuffer(0, 0, vertexCapacity * sizeof(Vertex));
+        EBO = resizeBuffer(0, 0, indexCapacity * sizeof(unsigned int));
+        setupAttributes();
+    }
+
+    void GeometryArena::setupAttributes() const {
+        glBindVertexArray(VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, VBO);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) (offsetof(Vertex, Position)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) (offsetof(Vertex, Normal)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) (offsetof(Vertex, TexCoords)));
+        glEnableVertexAttribArray(3);
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) (offsetof(Vertex, Tangent)));
+        glEnableVertexAttribArray(4);
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void *) (offsetof(Vertex, Bitangent)));
+
+        glBindVertexArray(0);
+    }
+
+    void GeometryArena::grow(GLsizeiptr minVertices, GLsizeiptr minIndices) {
+        if (minVertices > vertexCapacity) {
+            vertexCapacity = std::max(minVertices, vertexCapacity * 2);
+            VBO = resizeBuffer(VBO, vertexCount * sizeof(Vertex), vertexCapacity * sizeof(Vertex));
+        }
+        if (minIndices > indexCapacity) {
+            indexCapacity = std::max(minIndices, indexCapacity * 2);
+            EBO = resizeBuffer(EBO, indexCount * sizeof(unsigned int), indexCapacity * sizeof(unsigned int));
+        }
+        setupAttributes();
+    }
+
+    GeometryArena::Range GeometryArena::allocate(const std::vector<Vertex> &vertices,
+                                                 const std::vector<unsigned int> &indices) {
+        if (vertexCount + (GLsizeiptr) vertices.size() > vertexCapacity ||
+            indexCount + (GLsizeiptr) indices.size() > indexCapacity) {
+            grow(vertexCount + vertices.size(), indexCount + indices.size());
+        }
+
+        Range range{(GLuint) indexCount, (GLsizei) indices.size(), (GLint) vertexCount};
+        glBindBuffer(GL_COPY_WRITE_BUFFER, VBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, vertexCount * sizeof(Vertex), vertices.size() * sizeof(Vertex),
+                        vertices.data());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, EBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, indexCount * sizeof(unsigned int),
+                        indices.size() * sizeof(unsigned int), indices.data());
+        vertexCount += vertices.size();
+        indexCount += indices.size();
+        return range;
+    }
+
+    DrawElementsIndirectCommand GeometryArena::command(const Range &range) {
+        return {(GLuint) range.indexCount, 1, range.firstIndex, range.baseVertex, 0};
+    }
+
+    void GeometryArena::bind() const {
+        glBindVertexArray(VAO);
+    }
+
+    void GeometryArena::draw(const std::vector<DrawElementsIndirectCommand> &commands) {
+        if (commands.empty()) {
+            return;
+        }
+        frameStats.meshes += (int) commands.size();
+
+        if (!glext.multiDrawIndirect) {
+            for (const DrawElementsIndirectCommand &c: commands) {
+                glDrawElementsBaseVertex(GL_TRIANGLES, c.count, GL_UNSIGNED_INT,
+                                         (void *) (c.firstIndex * sizeof(unsigned int)), c.baseVertex);
+            }
+            frameStats.drawCalls += (int) commands.size();
+            return;
+        }
+
+        auto size = (GLsizeiptr) (commands.size() * sizeof(DrawElementsIndirectCommand));
+        GLintptr offset;
+        void *data = frameData.map(size, sizeof(GLuint), offset);
+        std::memcpy(data, commands.data(), size);
+        frameData.unmap();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, frameData.id());
+        glext.multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void *) offset, (GLsizei) commands.size(),
+                                        0);
+        frameStats.drawCalls += 1;
+    }
+
+    size_t GeometryArena::memoryUsage() const {
+        return vertexCapacity * sizeof(Vertex) + indexCapacity * sizeof(unsigned int);
+    }
+}
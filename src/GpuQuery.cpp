@@ -0,0 +1,52 @@
+#include <rg/GpuQuery.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    GpuQuery::GpuQuery(GLenum target) : queryTarget(target) {
+        glGenQueries(ringSize, ids);
+    }
+
+    void GpuQuery::begin() {
+        ASSERT(!active, "Query already active.");
+        active = true;
+        measuring = false;
+        int slot = frame % ringSize;
+        if (pending[slot]) {
+            // issued ringSize frames ago, normally long finished
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(ids[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                // the GPU is that far behind, skip this frame rather than wait, the slot is tried again next
+                return;
+            }
+            glGetQueryObjectui64v(ids[slot], GL_QUERY_RESULT, &latest);
+            pending[slot] = false;
+        }
+        glBeginQuery(queryTarget, ids[slot]);
+        measuring = true;
+    }
+
+    void GpuQuery::end() {
+        ASSERT(active, "Query not active.");
+        active = false;
+        if (!measuring) {
+            return;
+        }
+        glEndQuery(queryTarget);
+        pending[frame % ringSize] = true;
+        ++frame;
+    }
+
+    GLuint64 GpuQuery::result() const {
+        return latest;
+    }
+
+    double GpuQuery::milliseconds() const {
+        return (double) latest / 1.0e6;
+    }
+
+    GLenum GpuQuery::target() const {
+        return queryTarget;
+    }
+}
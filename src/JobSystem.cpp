@@ -0,0 +1,106 @@
+#include <rg/JobSystem.hpp>
+
+namespace rg {
+
+    namespace {
+        // Index of the deque owned by the current thread, 0 for the thread that created the JobSystem.
+        thread_local unsigned int currentQueue = 0;
+    }
+
+    JobSystem::JobSystem(int workerCount) {
+        if (workerCount < 0) {
+            workerCount = std::max(0, (int) std::thread::hardware_concurrency() - 1);
+        }
+        for (int i = 0; i <= workerCount; ++i) {
+            queues.emplace_back(new Queue());
+        }
+        for (int i = 1; i <= workerCount; ++i) {
+            workers.emplace_back(&JobSystem::workerLoop, this, i);
+        }
+    }
+
+    JobSystem::~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running = false;
+        }
+        wakeUp.notify_all();
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    }
+
+    unsigned int JobSystem::threadCount() const {
+        return (unsigned int) queues.size();
+    }
+
+    void JobSystem::submit(std::function<void()> job, JobCounter &counter) {
+        counter.fetch_add(1);
+        auto wrapped = [job, &counter]() {
+            job();
+            counter.fetch_sub(1);
+        };
+
+        // Spread jobs submitted from outside the pool, keep the ones spawned by workers local.
+        unsigned int index = currentQueue;
+        if (index == 0 && !workers.empty()) {
+            index = 1 + nextQueue.fetch_add(1) % (unsigned int) workers.size();
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->jobs.push_back(std::move(wrapped));
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            pending.fetch_add(1);
+        }
+        wakeUp.notify_one();
+    }
+
+    bool JobSystem::runOne(unsigned int index) {
+        std::function<void()> job;
+        {
+            Queue &own = *queues[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = std::move(own.jobs.back());
+                own.jobs.pop_back();
+            }
+        }
+
+        for (unsigned int i = 1; !job && i < queues.size(); ++i) {
+            Queue &victim = *queues[(index + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+            }
+        }
+
+        if (!job) {
+            return false;
+        }
+        pending.fetch_sub(1);
+        job();
+        return true;
+    }
+
+    void JobSystem::wait(JobCounter &counter) {
+        while (counter.load() > 0) {
+            if (!runOne(currentQueue)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::workerLoop(unsigned int index) {
+        currentQueue = index;
+        while (running) {
+            if (runOne(index)) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeUp.wait(lock, [this]() { return !running || pending.load() > 0; });
+        }
+    }
+}
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rg/LocalLights.hpp>
+#include <rg/utils/utils.hpp>
+
+namespace rg {
+
+    LocalLights::LocalLights(int capacity, float innerRadius, float outerRadius)
+            : orbits(capacity), colors(capacity), texels(2 * capacity) {
+        for (int i = 0; i < capacity; ++i) {
+            float radius = rg::random(innerRadius, outerRadius);
+            // roughly the speed of a circular orbit, the belt at radius 30 does 0.1 rad/s
+            float speed = 0.1f * std::pow(30.0f / radius, 1.5f) * (rg::random(0.0f, 1.0f) < 0.5f ? -1.0f : 1.0f);
+            orbits[i] = glm::vec4(radius, rg::random(-4.0f, 4.0f), rg::random(0.0f, glm::radians(360.0f)), speed);
+            // saturated colours, no channel dominated by the others on average
+            glm::vec3 color = rg::randomVec3(0.0f, 1.0f);
+            color /= std::max(color.x, std::max(color.y, color.z));
+            colors[i] = glm::vec4(color * rg::random(10.0f, 30.0f), rg::random(4.0f, 10.0f));
+        }
+
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        glBufferData(GL_TEXTURE_BUFFER, texels.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    int LocalLights::capacity() const {
+        return (int) orbits.size();
+    }
+
+    void LocalLights::update(double time) {
+        count = std::min(std::max(count, 0), capacity());
+        if (count == 0) {
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            const glm::vec4 &orbit = orbits[i];
+            // wrapped in double, float angles lose precision after long sessions
+            float angle = (float) std::fmod(orbit.z + time * orbit.w, 2.0 * glm::radians(180.0));
+            texels[2 * i] = glm::vec4(orbit.x * std::sin(angle), orbit.y, orbit.x * std::cos(angle), colors[i].w);
+            texels[2 * i + 1] = glm::vec4(glm::vec3(colors[i]), 0.0f);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, buffer);
+        // orphan, last frame's draws may still read the old storage
+        glBufferData(GL_TEXTURE_BUFFER, texels.size() * sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, 2 * count * sizeof(glm::vec4), &texels[0]);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void LocalLights::bind(const Shader &shader) const {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("localLights", textureUnit);
+        shader.setInt("localLightCount", count);
+    }
+}
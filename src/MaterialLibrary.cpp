@@ -0,0 +1,148 @@
+#include <algorithm>
+
+#include <stb_image.h>
+
+#include <rg/MaterialLibrary.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    MaterialLibrary::Location MaterialLibrary::addImage(const std::string &path, bool gammaCorrection, bool flip) {
+        if (path.empty()) {
+            return {-1, -1};
+        }
+        std::string key = path + (gammaCorrection ? "#srgb" : "#linear");
+        auto it = images.find(key);
+        if (it != images.end()) {
+            return it->second;
+        }
+
+        ASSERT(!built, "Material library is already built.");
+        int width, height, nrComponents;
+        stbi_set_flip_vertically_on_load(flip);
+        // everything is expanded to RGBA so only size and color space decide the array
+        unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrComponents, 4);
+        ASSERT(data != nullptr, "Texture failed to load at path: " << path);
+
+        int array = -1;
+        for (int i = 0; i < (int) arrays.size(); ++i) {
+            if (arrays[i].width == width && arrays[i].height == height && arrays[i].srgb == gammaCorrection) {
+                array = i;
+                break;
+            }
+        }
+        if (array < 0) {
+            array = (int) arrays.size();
+            arrays.push_back({0, width, height, gammaCorrection, {}});
+        }
+        arrays[array].layers.push_back(data);
+
+        Location location{array, (int) arrays[array].layers.size() - 1};
+        images[key] = location;
+        return location;
+    }
+
+    int MaterialLibrary::addMaterial(const std::string &diffusePath, const std::string &specularPath,
+                                     bool gammaCorrection, bool flip) {
+        std::string key = diffusePath + '|' + specularPath + (gammaCorrection ? "|srgb" : "|linear");
+        auto it = materialIds.find(key);
+        if (it != materialIds.end()) {
+            return it->second;
+        }
+
+        Location diffuse = addImage(diffusePath, gammaCorrection, flip);
+        Location specular = addImage(specularPath, gammaCorrection, flip);
+        materials.push_back({diffuse.array, diffuse.layer, specular.array, specular.layer});
+        int id = (int) materials.size() - 1;
+        materialIds[key] = id;
+        return id;
+    }
+
+    void MaterialLibrary::build() {
+        for (Array &array: arrays) {
+            glGenTextures(1, &array.id);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, array.id);
+            glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, array.srgb ? GL_SRGB8_ALPHA8 : GL_RGBA8, array.width, array.height,
+                         (GLsizei) array.layers.size(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            for (size_t layer = 0; layer < array.layers.size(); ++layer) {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, (GLint) layer, array.width, array.height, 1, GL_RGBA,
+                                GL_UNSIGNED_BYTE, array.layers[layer]);
+                stbi_image_free(array.layers[layer]);
+            }
+            glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            // keep the layer count, memoryUsage still needs it
+            std::fill(array.layers.begin(), array.layers.end(), nullptr);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        // x - diffuse layer, y - specular layer, -1 when the material has no such texture
+        std::vector<GLint> table;
+        for (const Material &material: materials) {
+            table.insert(table.end(), {material.diffuseLayer, material.specularLayer, 0, 0});
+        }
+        if (table.empty()) {
+            table.assign(4, -1);
+        }
+        glGenBuffers(1, &materialBuffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, materialBuffer);
+        glBufferData(GL_TEXTURE_BUFFER, table.size() * sizeof(GLint), table.data(), GL_STATIC_DRAW);
+        glGenTextures(1, &materialTexture);
+        glBindTexture(GL_TEXTURE_BUFFER, materialTexture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32I, materialBuffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+        // the table never changes, it stays bound for the rest of the run
+        glActiveTexture(GL_TEXTURE0 + materialUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, materialTexture);
+        glActiveTexture(GL_TEXTURE0);
+        built = true;
+    }
+
+    void MaterialLibrary::setupShader(const Shader &shader) const {
+        shader.use();
+        shader.setInt("diffuseArray", diffuseUnit);
+        shader.setInt("specularArray", specularUnit);
+        shader.setInt("materials", materialUnit);
+    }
+
+    void MaterialLibrary::bind(int material, const Shader &shader) {
+        ASSERT(built && material >= 0 && material < (int) materials.size(), "Invalid material.");
+        const Material &m = materials[material];
+        unsigned int diffuse = m.diffuseArray >= 0 ? arrays[m.diffuseArray].id : boundDiffuse;
+        unsigned int specular = m.specularArray >= 0 ? arrays[m.specularArray].id : boundSpecular;
+
+        if (diffuse != boundDiffuse) {
+            glActiveTexture(GL_TEXTURE0 + diffuseUnit);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, diffuse);
+            boundDiffuse = diffuse;
+            frameStats.textureBinds++;
+        }
+        if (specular != boundSpecular) {
+            glActiveTexture(GL_TEXTURE0 + specularUnit);
+            glBindTexture(GL_TEXTURE_2D_ARRAY, specular);
+            boundSpecular = specular;
+            frameStats.textureBinds++;
+        }
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("materialIndex", material);
+    }
+
+    int MaterialLibrary::size() const {
+        return (int) materials.size();
+    }
+
+    size_t MaterialLibrary::memoryUsage() const {
+        size_t bytes = 0;
+        for (const Array &array: arrays) {
+            // full mip chain is about a third on top of the base level
+            bytes += (size_t) array.width * array.height * 4 * array.layers.size() * 4 / 3;
+        }
+        return bytes;
+    }
+}
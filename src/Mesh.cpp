@@ -1,5 +1,6 @@
 #include <rg/Mesh.hpp>
 #include <rg/utils/debug.hpp>
+#include <rg/FrameStats.hpp>
 #include <utility>
 
 namespace rg {
@@ -9,6 +10,20 @@ namespace rg {
     }
 
     void Mesh::draw(Shader &shader) {
+        bindTextures(shader);
+        drawElements();
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void Mesh::drawElements() const {
+        glBindVertexArray(VAO);
+        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        frameStats.drawCalls++;
+        frameStats.meshes++;
+        glBindVertexArray(0);
+    }
+
+    void Mesh::bindTextures(Shader &shader) const {
         unsigned int diffuseNr = 1;
         unsigned int specularNr = 1;
         unsigned int normalNr = 1;
@@ -35,13 +50,20 @@ namespace rg {
             name.append(number);
             shader.setInt(name, i); // texture_diffuse1
             glBindTexture(GL_TEXTURE_2D, textures[i].id);
+            frameStats.textureBinds++;
         }
+    }
 
-        glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
-
-        glBindVertexArray(0);
-        glActiveTexture(GL_TEXTURE0);
+    bool Mesh::sameTextures(const Mesh &other) const {
+        if (textures.size() != other.textures.size() || glslIdentifierPrefix != other.glslIdentifierPrefix) {
+            return false;
+        }
+        for (size_t i = 0; i < textures.size(); ++i) {
+            if (textures[i].id != other.textures[i].id || textures[i].type != other.textures[i].type) {
+                return false;
+            }
+        }
+        return true;
     }
 
     void Mesh::setupMesh() {
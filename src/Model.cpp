@@ -1,4 +1,5 @@
 #include <rg/Model.hpp>
+#include <rg/ObjLoader.hpp>
 #include <rg/utils/debug.hpp>
 #include <stb_image.h>
 
@@ -9,12 +10,95 @@ namespace rg {
     }
 
     void Model::draw(Shader &shader) {
-        for (Mesh &mesh: meshes) {
-            mesh.draw(shader);
+        if (!arena || !arena->enabled) {
+            for (size_t i = 0; i < meshes.size(); ++i) {
+                bindMaterial(i, shader);
+                meshes[i].drawElements();
+            }
+            glActiveTexture(GL_TEXTURE0);
+            return;
+        }
+
+        arena->bind();
+        commands.clear();
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            if (i == 0 || !sameMaterial(i, i - 1)) {
+                arena->draw(commands);
+                commands.clear();
+                bindMaterial(i, shader);
+            }
+            commands.push_back(GeometryArena::command(arenaRanges[i]));
+        }
+        arena->draw(commands);
+
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void Model::drawDepth() {
+        if (!arena || !arena->enabled) {
+            for (const Mesh &mesh: meshes) {
+                mesh.drawElements();
+            }
+            return;
+        }
+
+        arena->bind();
+        commands.clear();
+        for (const GeometryArena::Range &range: arenaRanges) {
+            commands.push_back(GeometryArena::command(range));
+        }
+        arena->draw(commands);
+        glBindVertexArray(0);
+    }
+
+    void Model::bindMaterial(size_t mesh, Shader &shader) {
+        if (materialLibrary) {
+            materialLibrary->bind(meshMaterials[mesh], shader);
+        } else {
+            meshes[mesh].bindTextures(shader);
+        }
+    }
+
+    bool Model::sameMaterial(size_t a, size_t b) const {
+        if (materialLibrary) {
+            return meshMaterials[a] == meshMaterials[b];
+        }
+        return meshes[a].sameTextures(meshes[b]);
+    }
+
+    void Model::addToMaterials(MaterialLibrary &library, bool flip) {
+        materialLibrary = &library;
+        meshMaterials.clear();
+        for (const Mesh &mesh: meshes) {
+            std::string diffuse, specular;
+            for (const Texture &texture: mesh.textures) {
+                std::string path = directory + "/" + texture.path;
+                if (texture.type == "texture_diffuse" && diffuse.empty()) {
+                    diffuse = path;
+                } else if (texture.type == "texture_specular" && specular.empty()) {
+                    specular = path;
+                }
+            }
+            meshMaterials.push_back(library.addMaterial(diffuse, specular, gammaCorrection, flip));
+        }
+    }
+
+    void Model::addToArena(GeometryArena &geometryArena) {
+        arena = &geometryArena;
+        arenaRanges.clear();
+        for (const Mesh &mesh: meshes) {
+            arenaRanges.push_back(arena->allocate(mesh.vertices, mesh.indices));
         }
     }
 
     void Model::loadModel(const std::string &path) {
+        this->directory = path.substr(0, path.find_last_of('/'));
+        if (path.size() > 4 && path.compare(path.size() - 4, 4, ".obj") == 0) {
+            loadObjModel(path);
+            return;
+        }
+
         Assimp::Importer importer;
         const aiScene *scene = importer.ReadFile(path, aiProcess_Triangulate |
                                                        aiProcess_GenSmoothNormals | aiProcess_FlipUVs |
@@ -23,7 +107,6 @@ namespace rg {
         if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
             ASSERT(false, "Failed to load a model!");
         }
-        this->directory = path.substr(0, path.find_last_of('/'));
         processNode(scene->mRootNode, scene);
     }
 
@@ -106,29 +189,52 @@ namespace rg {
         return {vertices, indices, textures};
     }
 
+    void Model::loadObjModel(const std::string &path) {
+        ObjData data;
+        ASSERT(loadObj(path, data), "Failed to load a model!");
+
+        for (ObjMesh &objMesh: data.meshes) {
+            std::vector<Texture> textures;
+            if (objMesh.material >= 0) {
+                const ObjMaterial &material = data.materials[objMesh.material];
+                loadTexture(material.diffuseMap, "texture_diffuse", textures);
+                loadTexture(material.specularMap, "texture_specular", textures);
+                loadTexture(material.normalMap, "texture_normal", textures);
+                loadTexture(material.heightMap, "texture_height", textures);
+                loadTexture(material.ambientMap, "texture_ambient", textures);
+                loadTexture(material.emissiveMap, "texture_emissive", textures);
+            }
+            meshes.emplace_back(std::move(objMesh.vertices), std::move(objMesh.indices), std::move(textures));
+        }
+    }
+
     void Model::loadTextureMaterial(aiMaterial *mat, aiTextureType type, const std::string &typeName,
                                     std::vector<Texture> &textures) {
         for (unsigned int i = 0; i < mat->GetTextureCount(type); ++i) {
             aiString str;
             mat->GetTexture(type, i, &str);
+            loadTexture(str.C_Str(), typeName, textures);
+        }
+    }
 
-            bool skip = false;
-            auto it = loaded_textures.find(std::string(str.C_Str()));
-            if (it != loaded_textures.end()) {
-                textures.push_back(it->second);
-                skip = true;
-            }
+    void Model::loadTexture(const std::string &filename, const std::string &typeName,
+                            std::vector<Texture> &textures) {
+        if (filename.empty()) {
+            return;
+        }
 
-            if (!skip) {
-                Texture texture;
-                texture.id = textureFromFile(str.C_Str());
-                texture.type = typeName;
-                texture.path = str.C_Str();
-                textures.push_back(texture);
-//                loaded_textures.push_back(texture);
-                loaded_textures[std::string(str.C_Str())] = texture;
-            }
+        auto it = loaded_textures.find(filename);
+        if (it != loaded_textures.end()) {
+            textures.push_back(it->second);
+            return;
         }
+
+        Texture texture;
+        texture.id = textureFromFile(filename.c_str());
+        texture.type = typeName;
+        texture.path = filename;
+        textures.push_back(texture);
+        loaded_textures[filename] = texture;
     }
 
     void Model::setTextureNamePrefix(const std::string &prefix) {
@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rg/NBody.hpp>
+
+namespace rg {
+
+    namespace {
+        // Particles closer than the float resolution of the tree bounds end up in one leaf.
+        const int maxTreeDepth = 24;
+        // Leaves are summed directly, small buckets beat descending to single particles.
+        const int leafSize = 8;
+    }
+
+    void NBody::addParticle(const glm::vec3 &position, const glm::vec3 &velocity, float m) {
+        px.push_back(position.x);
+        py.push_back(position.y);
+        pz.push_back(position.z);
+        vx.push_back(velocity.x);
+        vy.push_back(velocity.y);
+        vz.push_back(velocity.z);
+        ax.push_back(0.0f);
+        ay.push_back(0.0f);
+        az.push_back(0.0f);
+        mass.push_back(m);
+        accelerationsValid = false;
+    }
+
+    void NBody::clear() {
+        for (auto *v: {&px, &py, &pz, &vx, &vy, &vz, &ax, &ay, &az, &mass, &sortedX, &sortedY, &sortedZ,
+                       &sortedMass}) {
+            v->clear();
+        }
+        nodes.clear();
+        order.clear();
+        accelerationsValid = false;
+    }
+
+    size_t NBody::size() const {
+        return px.size();
+    }
+
+    glm::vec3 NBody::position(size_t i) const {
+        return {px[i], py[i], pz[i]};
+    }
+
+    void NBody::buildNode(int index, int begin, int end, const glm::vec3 &center, float halfSize, int depth) {
+        nodes[index] = {center, 0.0f, 2.0f * halfSize, -1, 0, begin, end};
+
+        if (end - begin <= leafSize || depth >= maxTreeDepth) {
+            glm::vec3 com(0.0f);
+            float m = 0.0f;
+            for (int k = begin; k < end; ++k) {
+                int i = order[k];
+                sortedX[k] = px[i];
+                sortedY[k] = py[i];
+                sortedZ[k] = pz[i];
+                sortedMass[k] = mass[i];
+                com += position(i) * mass[i];
+                m += mass[i];
+            }
+            nodes[index].com = m > 0.0f ? com / m : center;
+            nodes[index].mass = m;
+            return;
+        }
+
+        // Split the range into octants: by x, then each half by y, then each quarter by z. That makes
+        // x bit 2 of the octant, y bit 1 and z bit 0.
+        int bounds[9];
+        bounds[0] = begin;
+        bounds[8] = end;
+        auto split = [&](int from, int to, int axis) {
+            int *first = order.data() + from;
+            int *middle = std::partition(first, order.data() + to, [&](int i) {
+                return position(i)[axis] < center[axis];
+            });
+            return from + (int) (middle - first);
+        };
+        bounds[4] = split(begin, end, 0);
+        bounds[2] = split(begin, bounds[4], 1);
+        bounds[6] = split(bounds[4], end, 1);
+        for (int q = 0; q < 8; q += 2) {
+            bounds[q + 1] = split(bounds[q], bounds[q + 2], 2);
+        }
+
+        // Empty octants get no node, the rest are allocated together so they stay consecutive.
+        int octants[8];
+        int childCount = 0;
+        for (int octant = 0; octant < 8; ++octant) {
+            if (bounds[octant] != bounds[octant + 1]) {
+                octants[childCount++] = octant;
+            }
+        }
+        int firstChild = (int) nodes.size();
+        nodes.resize(nodes.size() + childCount);
+        nodes[index].firstChild = firstChild;
+        nodes[index].childCount = childCount;
+
+        glm::vec3 com(0.0f);
+        float m = 0.0f;
+        float childHalf = 0.5f * halfSize;
+        for (int c = 0; c < childCount; ++c) {
+            int octant = octants[c];
+            glm::vec3 offset((octant & 4) ? childHalf : -childHalf,
+                             (octant & 2) ? childHalf : -childHalf,
+                             (octant & 1) ? childHalf : -childHalf);
+            buildNode(firstChild + c, bounds[octant], bounds[octant + 1], center + offset, childHalf, depth + 1);
+            com += nodes[firstChild + c].com * nodes[firstChild + c].mass;
+            m += nodes[firstChild + c].mass;
+        }
+        nodes[index].com = m > 0.0f ? com / m : center;
+        nodes[index].mass = m;
+    }
+
+    void NBody::buildTree() {
+        nodes.clear();
+        if (size() == 0) {
+            return;
+        }
+
+        glm::vec3 lo(px[0], py[0], pz[0]), hi = lo;
+        for (size_t i = 1; i < size(); ++i) {
+            lo = glm::min(lo, position(i));
+            hi = glm::max(hi, position(i));
+        }
+        glm::vec3 extent = hi - lo;
+        float halfSize = 0.5f * std::max(std::max(extent.x, extent.y), std::max(extent.z, 1e-3f)) * 1.001f;
+
+        order.resize(size());
+        for (size_t i = 0; i < size(); ++i) {
+            order[i] = (int) i;
+        }
+        sortedX.resize(size());
+        sortedY.resize(size());
+        sortedZ.resize(size());
+        sortedMass.resize(size());
+        nodes.resize(1);
+        buildNode(0, 0, (int) size(), (lo + hi) * 0.5f, halfSize, 0);
+    }
+
+    glm::vec3 NBody::acceleration(size_t i, float *potential) const {
+        const glm::vec3 p = position(i);
+        const float eps2 = softening * softening;
+        const float theta2 = theta * theta;
+        glm::vec3 a(0.0f);
+        float phi = 0.0f;
+
+        int stack[8 * maxTreeDepth + 8];
+        int top = 0;
+        if (!nodes.empty()) {
+            stack[top++] = 0;
+        }
+        while (top > 0) {
+            const Node &n = nodes[stack[--top]];
+            glm::vec3 d = n.com - p;
+            float dist2 = glm::dot(d, d) + eps2;
+            if (n.firstChild >= 0 && n.size * n.size < theta2 * dist2) {
+                float invDist = 1.0f / std::sqrt(dist2);
+                a += d * (n.mass * invDist * invDist * invDist);
+                phi -= n.mass * invDist;
+            } else if (n.firstChild >= 0) {
+                for (int c = 0; c < n.childCount; ++c) {
+                    stack[top++] = n.firstChild + c;
+                }
+            } else {
+                for (int k = n.begin; k < n.end; ++k) {
+                    if (order[k] == (int) i) {
+                        continue;
+                    }
+                    glm::vec3 dk(sortedX[k] - p.x, sortedY[k] - p.y, sortedZ[k] - p.z);
+                    float invDist = 1.0f / std::sqrt(glm::dot(dk, dk) + eps2);
+                    a += dk * (sortedMass[k] * invDist * invDist * invDist);
+                    phi -= sortedMass[k] * invDist;
+                }
+            }
+        }
+
+        for (const Attractor &attractor: attractors) {
+            glm::vec3 d = attractor.position - p;
+            float dist2 = glm::dot(d, d) + eps2;
+            float invDist = 1.0f / std::sqrt(dist2);
+            a += d * (attractor.mass * invDist * invDist * invDist);
+            phi -= attractor.mass * invDist;
+        }
+
+        if (potential) {
+            *potential = gravity * phi;
+        }
+        return a * gravity;
+    }
+
+    void NBody::computeAccelerations(JobSystem &jobs) {
+        buildTree();
+        jobs.parallelFor(0, size(), 256, [this](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                glm::vec3 a = acceleration(i, nullptr);
+                ax[i] = a.x;
+                ay[i] = a.y;
+                az[i] = a.z;
+            }
+        });
+        accelerationsValid = true;
+    }
+
+    void NBody::step(float dt, JobSystem &jobs) {
+        if (!accelerationsValid) {
+            computeAccelerations(jobs);
+        }
+
+        const float halfDt = 0.5f * dt;
+        auto kick = [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                vx[i] += ax[i] * halfDt;
+                vy[i] += ay[i] * halfDt;
+                vz[i] += az[i] * halfDt;
+            }
+        };
+
+        jobs.parallelFor(0, size(), 4096, [&](size_t first, size_t last) {
+            kick(first, last);
+            for (size_t i = first; i < last; ++i) {
+                px[i] += vx[i] * dt;
+                py[i] += vy[i] * dt;
+                pz[i] += vz[i] * dt;
+            }
+        });
+        computeAccelerations(jobs);
+        jobs.parallelFor(0, size(), 4096, kick);
+    }
+
+    double NBody::energy(JobSystem &jobs) {
+        buildTree();
+        std::vector<double> partial(size());
+        jobs.parallelFor(0, size(), 256, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                float phi;
+                acceleration(i, &phi);
+                // particle pairs are seen from both sides, attractors only once
+                float phiAttractors = 0.0f;
+                for (const Attractor &attractor: attractors) {
+                    glm::vec3 d = attractor.position - position(i);
+                    phiAttractors -= gravity * attractor.mass / std::sqrt(glm::dot(d, d) + softening * softening);
+                }
+                double v2 = (double) vx[i] * vx[i] + (double) vy[i] * vy[i] + (double) vz[i] * vz[i];
+                partial[i] = mass[i] * (0.5 * v2 + 0.5 * (phi - phiAttractors) + phiAttractors);
+            }
+        });
+
+        double total = 0.0;
+        for (double e: partial) {
+            total += e;
+        }
+        return total;
+    }
+}
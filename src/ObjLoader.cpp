@@ -0,0 +1,627 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <rg/ObjLoader.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+
+        class MappedFile {
+            int fd = -1;
+        public:
+            const char *data = nullptr;
+            size_t size = 0;
+
+            explicit MappedFile(const std::string &path) {
+                fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                struct stat st{};
+                if (fstat(fd, &st) != 0 || st.st_size == 0) {
+                    return;
+                }
+                void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    return;
+                }
+                madvise(p, st.st_size, MADV_SEQUENTIAL);
+                data = static_cast<const char *>(p);
+                size = st.st_size;
+            }
+
+            ~MappedFile() {
+                if (data) {
+                    munmap(const_cast<char *>(data), size);
+                }
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+
+            MappedFile(const MappedFile &) = delete;
+
+            MappedFile &operator=(const MappedFile &) = delete;
+        };
+
+        // Returns a pointer to the next '\n' or end. Scans 16 bytes at a time where SSE2 is available.
+        const char *findNewline(const char *p, const char *end) {
+#ifdef __SSE2__
+            const __m128i nl = _mm_set1_epi8('\n');
+            while (end - p >= 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, nl));
+                if (mask) {
+                    return p + __builtin_ctz(mask);
+                }
+                p += 16;
+            }
+#endif
+            while (p < end && *p != '\n') {
+                ++p;
+            }
+            return p;
+        }
+
+        inline bool isSpace(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        inline const char *skipSpace(const char *p, const char *end) {
+            while (p < end && isSpace(*p)) {
+                ++p;
+            }
+            return p;
+        }
+
+        const double powersOf10[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        // Parses [+-]digits[.digits][(e|E)[+-]digits]. Much faster than strtof because it never touches
+        // the locale and accumulates all significant digits in an integer.
+        const char *parseFloat(const char *p, const char *end, float &out) {
+            p = skipSpace(p, end);
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                ++p;
+            }
+
+            uint64_t mantissa = 0;
+            int exponent = 0;
+            int digits = 0;
+            while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                if (digits < 19) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                    ++digits;
+                } else {
+                    ++exponent;
+                }
+                ++p;
+            }
+            if (p < end && *p == '.') {
+                ++p;
+                while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                    if (digits < 19) {
+                        mantissa = mantissa * 10 + (*p - '0');
+                        ++digits;
+                        --exponent;
+                    }
+                    ++p;
+                }
+            }
+            if (p < end && (*p == 'e' || *p == 'E')) {
+                ++p;
+                bool negativeExp = false;
+                if (p < end && (*p == '-' || *p == '+')) {
+                    negativeExp = *p == '-';
+                    ++p;
+                }
+                int e = 0;
+                while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                    e = std::min(e * 10 + (*p - '0'), 1000);
+                    ++p;
+                }
+                exponent += negativeExp ? -e : e;
+            }
+
+            double value = static_cast<double>(mantissa);
+            while (exponent > 22) {
+                value *= 1e22;
+                exponent -= 22;
+            }
+            while (exponent < -22) {
+                value /= 1e22;
+                exponent += 22;
+            }
+            value = exponent >= 0 ? value * powersOf10[exponent] : value / powersOf10[-exponent];
+            out = static_cast<float>(negative ? -value : value);
+            return p;
+        }
+
+        const char *parseInt(const char *p, const char *end, long &out) {
+            bool negative = false;
+            if (p < end && (*p == '-' || *p == '+')) {
+                negative = *p == '-';
+                ++p;
+            }
+            long value = 0;
+            while (p < end && static_cast<unsigned>(*p - '0') < 10) {
+                value = value * 10 + (*p - '0');
+                ++p;
+            }
+            out = negative ? -value : value;
+            return p;
+        }
+
+        // Face corner as read from the file. Non negative values are already 0 based absolute indices,
+        // relative (negative) OBJ indices are stored as a chunk local index offset by relativeBias and are
+        // resolved once the element counts of all previous chunks are known. INT64_MIN marks a missing
+        // uv/normal.
+        const int64_t missingIndex = INT64_MIN;
+        const int64_t relativeBias = -(int64_t(1) << 62);
+
+        struct Corner {
+            int64_t v;
+            int64_t vt;
+            int64_t vn;
+        };
+
+        struct Chunk {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec2> texCoords;
+            std::vector<glm::vec3> normals;
+
+            std::vector<Corner> corners;
+            std::vector<uint32_t> faceSizes;
+
+            // (face index, material name) pairs, in file order
+            std::vector<std::pair<size_t, std::string>> materialSwitches;
+            std::vector<std::string> mtlLibs;
+        };
+
+        int64_t encodeIndex(long index, size_t localCount) {
+            if (index > 0) {
+                return index - 1;
+            }
+            // relative index, -1 is the last element defined so far (possibly in a previous chunk)
+            return relativeBias + static_cast<int64_t>(localCount) + index;
+        }
+
+        const char *parseCorner(const char *p, const char *end, const Chunk &chunk, Corner &corner) {
+            long index;
+            p = parseInt(p, end, index);
+            corner.v = encodeIndex(index, chunk.positions.size());
+            corner.vt = missingIndex;
+            corner.vn = missingIndex;
+            if (p < end && *p == '/') {
+                ++p;
+                if (p < end && *p != '/') {
+                    p = parseInt(p, end, index);
+                    corner.vt = encodeIndex(index, chunk.texCoords.size());
+                }
+                if (p < end && *p == '/') {
+                    ++p;
+                    p = parseInt(p, end, index);
+                    corner.vn = encodeIndex(index, chunk.normals.size());
+                }
+            }
+            return p;
+        }
+
+        std::string restOfLine(const char *p, const char *end) {
+            p = skipSpace(p, end);
+            while (end > p && isSpace(end[-1])) {
+                --end;
+            }
+            return {p, end};
+        }
+
+        void parseChunk(const char *p, const char *end, Chunk &chunk) {
+            while (p < end) {
+                const char *lineEnd = findNewline(p, end);
+                p = skipSpace(p, lineEnd);
+
+                if (lineEnd - p >= 2 && p[0] == 'v') {
+                    if (isSpace(p[1])) {
+                        glm::vec3 v;
+                        p = parseFloat(p + 2, lineEnd, v.x);
+                        p = parseFloat(p, lineEnd, v.y);
+                        parseFloat(p, lineEnd, v.z);
+                        chunk.positions.push_back(v);
+                    } else if (p[1] == 't') {
+                        glm::vec2 vt;
+                        p = parseFloat(p + 2, lineEnd, vt.x);
+                        parseFloat(p, lineEnd, vt.y);
+                        chunk.texCoords.push_back(vt);
+                    } else if (p[1] == 'n') {
+                        glm::vec3 vn;
+                        p = parseFloat(p + 2, lineEnd, vn.x);
+                        p = parseFloat(p, lineEnd, vn.y);
+                        parseFloat(p, lineEnd, vn.z);
+                        chunk.normals.push_back(vn);
+                    }
+                } else if (lineEnd - p >= 2 && p[0] == 'f' && isSpace(p[1])) {
+                    p += 2;
+                    uint32_t count = 0;
+                    while ((p = skipSpace(p, lineEnd)) < lineEnd) {
+                        Corner corner{};
+                        const char *next = parseCorner(p, lineEnd, chunk, corner);
+                        if (next == p) {
+                            break;
+                        }
+                        p = next;
+                        chunk.corners.push_back(corner);
+                        ++count;
+                    }
+                    chunk.faceSizes.push_back(count);
+                } else if (lineEnd - p > 7 && std::strncmp(p, "usemtl", 6) == 0 && isSpace(p[6])) {
+                    chunk.materialSwitches.emplace_back(chunk.faceSizes.size(), restOfLine(p + 7, lineEnd));
+                } else if (lineEnd - p > 7 && std::strncmp(p, "mtllib", 6) == 0 && isSpace(p[6])) {
+                    chunk.mtlLibs.push_back(restOfLine(p + 7, lineEnd));
+                }
+                // comments, groups, objects and smoothing groups don't affect the output
+
+                p = lineEnd + 1;
+            }
+        }
+
+        struct VertexKey {
+            int64_t v;
+            int64_t vt;
+            int64_t vn;
+
+            bool operator==(const VertexKey &other) const {
+                return v == other.v && vt == other.vt && vn == other.vn;
+            }
+        };
+
+        struct VertexKeyHash {
+            size_t operator()(const VertexKey &k) const {
+                uint64_t h = static_cast<uint64_t>(k.v) * 0x9E3779B97F4A7C15ull;
+                h ^= static_cast<uint64_t>(k.vt) * 0xC2B2AE3D27D4EB4Full + (h << 6) + (h >> 2);
+                h ^= static_cast<uint64_t>(k.vn) * 0x165667B19E3779F9ull + (h << 6) + (h >> 2);
+                return static_cast<size_t>(h);
+            }
+        };
+
+        void generateNormals(ObjMesh &mesh) {
+            for (Vertex &v: mesh.vertices) {
+                v.Normal = glm::vec3(0.0f);
+            }
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                Vertex &a = mesh.vertices[mesh.indices[i]];
+                Vertex &b = mesh.vertices[mesh.indices[i + 1]];
+                Vertex &c = mesh.vertices[mesh.indices[i + 2]];
+                glm::vec3 n = glm::cross(b.Position - a.Position, c.Position - a.Position);
+                a.Normal += n;
+                b.Normal += n;
+                c.Normal += n;
+            }
+            for (Vertex &v: mesh.vertices) {
+                float len = glm::length(v.Normal);
+                v.Normal = len > 0.0f ? v.Normal / len : glm::vec3(0.0f, 1.0f, 0.0f);
+            }
+        }
+
+        void generateTangents(ObjMesh &mesh) {
+            for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+                Vertex &a = mesh.vertices[mesh.indices[i]];
+                Vertex &b = mesh.vertices[mesh.indices[i + 1]];
+                Vertex &c = mesh.vertices[mesh.indices[i + 2]];
+                glm::vec3 e1 = b.Position - a.Position;
+                glm::vec3 e2 = c.Position - a.Position;
+                glm::vec2 d1 = b.TexCoords - a.TexCoords;
+                glm::vec2 d2 = c.TexCoords - a.TexCoords;
+                float det = d1.x * d2.y - d2.x * d1.y;
+                if (std::fabs(det) < 1e-12f) {
+                    continue;
+                }
+                float r = 1.0f / det;
+                glm::vec3 tangent = (e1 * d2.y - e2 * d1.y) * r;
+                glm::vec3 bitangent = (e2 * d1.x - e1 * d2.x) * r;
+                a.Tangent += tangent;
+                b.Tangent += tangent;
+                c.Tangent += tangent;
+                a.Bitangent += bitangent;
+                b.Bitangent += bitangent;
+                c.Bitangent += bitangent;
+            }
+            for (Vertex &v: mesh.vertices) {
+                // Gram-Schmidt against the normal, same as aiProcess_CalcTangentSpace
+                glm::vec3 t = v.Tangent - v.Normal * glm::dot(v.Normal, v.Tangent);
+                float len = glm::length(t);
+                v.Tangent = len > 0.0f ? t / len : glm::vec3(0.0f);
+                len = glm::length(v.Bitangent);
+                v.Bitangent = len > 0.0f ? v.Bitangent / len : glm::vec3(0.0f);
+            }
+        }
+
+        std::string directoryOf(const std::string &path) {
+            size_t slash = path.find_last_of('/');
+            return slash == std::string::npos ? std::string(".") : path.substr(0, slash);
+        }
+
+        // Texture map statements may carry options (-bm 1.0 file.png), the file name is the last token.
+        std::string mapFileName(const std::string &args) {
+            size_t pos = args.find_last_of(" \t");
+            return pos == std::string::npos ? args : args.substr(pos + 1);
+        }
+
+        glm::vec3 parseVec3(const char *p, const char *end) {
+            glm::vec3 v;
+            p = parseFloat(p, end, v.x);
+            p = parseFloat(p, end, v.y);
+            parseFloat(p, end, v.z);
+            return v;
+        }
+    }
+
+    bool loadMtl(const std::string &path, std::vector<ObjMaterial> &materials) {
+        MappedFile file(path);
+        if (!file.data) {
+            return false;
+        }
+
+        const char *p = file.data;
+        const char *end = file.data + file.size;
+        ObjMaterial *current = nullptr;
+        while (p < end) {
+            const char *lineEnd = findNewline(p, end);
+            p = skipSpace(p, lineEnd);
+            const char *keyEnd = p;
+            while (keyEnd < lineEnd && !isSpace(*keyEnd)) {
+                ++keyEnd;
+            }
+            std::string key(p, keyEnd);
+            const char *args = skipSpace(keyEnd, lineEnd);
+
+            if (key == "newmtl") {
+                materials.emplace_back();
+                current = &materials.back();
+                current->name = restOfLine(args, lineEnd);
+            } else if (current) {
+                if (key == "Ka") {
+                    current->ambient = parseVec3(args, lineEnd);
+                } else if (key == "Kd") {
+                    current->diffuse = parseVec3(args, lineEnd);
+                } else if (key == "Ks") {
+                    current->specular = parseVec3(args, lineEnd);
+                } else if (key == "Ns") {
+                    parseFloat(args, lineEnd, current->shininess);
+                } else if (key == "map_Kd") {
+                    current->diffuseMap = mapFileName(restOfLine(args, lineEnd));
+                } else if (key == "map_Ks") {
+                    current->specularMap = mapFileName(restOfLine(args, lineEnd));
+                } else if (key == "norm" || key == "map_Kn") {
+                    current->normalMap = mapFileName(restOfLine(args, lineEnd));
+                } else if (key == "bump" || key == "map_bump" || key == "map_Bump") {
+                    current->heightMap = mapFileName(restOfLine(args, lineEnd));
+                } else if (key == "map_Ka") {
+                    current->ambientMap = mapFileName(restOfLine(args, lineEnd));
+                } else if (key == "map_Ke") {
+                    current->emissiveMap = mapFileName(restOfLine(args, lineEnd));
+                }
+            }
+
+            p = lineEnd + 1;
+        }
+        return true;
+    }
+
+    bool loadObj(const std::string &path, ObjData &out, unsigned int threads) {
+        MappedFile file(path);
+        if (!file.data) {
+            return false;
+        }
+
+        // Small files aren't worth the thread start up cost.
+        const size_t minChunkSize = 1u << 20;
+        if (threads == 0) {
+            threads = std::max(1u, std::thread::hardware_concurrency());
+        }
+        threads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(threads,
+                                                                                   file.size / minChunkSize)));
+
+        // Split on line boundaries.
+        const char *end = file.data + file.size;
+        std::vector<const char *> bounds{file.data};
+        for (unsigned int i = 1; i < threads; ++i) {
+            const char *p = std::max(bounds.back(), file.data + file.size * i / threads);
+            p = findNewline(p, end);
+            bounds.push_back(p < end ? p + 1 : end);
+        }
+        bounds.push_back(end);
+
+        std::vector<Chunk> chunks(threads);
+        std::vector<std::thread> workers;
+        for (unsigned int i = 1; i < threads; ++i) {
+            workers.emplace_back(parseChunk, bounds[i], bounds[i + 1], std::ref(chunks[i]));
+        }
+        parseChunk(bounds[0], bounds[1], chunks[0]);
+        for (auto &worker: workers) {
+            worker.join();
+        }
+
+        // Merge attribute arrays and resolve chunk local indices.
+        std::vector<glm::vec3> positions;
+        std::vector<glm::vec2> texCoords;
+        std::vector<glm::vec3> normals;
+        size_t cornerCount = 0;
+        for (const Chunk &chunk: chunks) {
+            cornerCount += chunk.corners.size();
+        }
+        std::vector<Corner> corners;
+        corners.reserve(cornerCount);
+        std::vector<uint32_t> faceSizes;
+        std::vector<std::pair<size_t, std::string>> materialSwitches;
+        std::vector<std::string> mtlLibs;
+
+        for (Chunk &chunk: chunks) {
+            auto resolve = [](int64_t index, size_t base) {
+                if (index == missingIndex || index >= 0) {
+                    return index;
+                }
+                return static_cast<int64_t>(base) + (index - relativeBias);
+            };
+            for (const Corner &c: chunk.corners) {
+                corners.push_back({resolve(c.v, positions.size()),
+                                   resolve(c.vt, texCoords.size()),
+                                   resolve(c.vn, normals.size())});
+            }
+            for (auto &s: chunk.materialSwitches) {
+                materialSwitches.emplace_back(s.first + faceSizes.size(), std::move(s.second));
+            }
+            faceSizes.insert(faceSizes.end(), chunk.faceSizes.begin(), chunk.faceSizes.end());
+            positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+            texCoords.insert(texCoords.end(), chunk.texCoords.begin(), chunk.texCoords.end());
+            normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+            mtlLibs.insert(mtlLibs.end(), chunk.mtlLibs.begin(), chunk.mtlLibs.end());
+            chunk = Chunk();
+        }
+
+        std::string directory = directoryOf(path);
+        for (const std::string &lib: mtlLibs) {
+            if (!loadMtl(directory + "/" + lib, out.materials)) {
+                LOG(std::cerr) << "Failed to load material library: " << lib << '\n';
+            }
+        }
+
+        auto materialIndex = [&](const std::string &name) {
+            for (size_t i = 0; i < out.materials.size(); ++i) {
+                if (out.materials[i].name == name) {
+                    return static_cast<int>(i);
+                }
+            }
+            return -1;
+        };
+
+        // Build one indexed mesh per material run.
+        std::unordered_map<VertexKey, unsigned int, VertexKeyHash> vertexLookup;
+        ObjMesh *mesh = nullptr;
+        bool hasNormals = true;
+        bool hasTexCoords = true;
+        size_t corner = 0;
+        size_t nextSwitch = 0;
+        auto finishMesh = [&]() {
+            if (!mesh) {
+                return;
+            }
+            if (mesh->indices.empty()) {
+                out.meshes.pop_back();
+            } else {
+                if (!hasNormals) {
+                    generateNormals(*mesh);
+                }
+                if (hasTexCoords) {
+                    generateTangents(*mesh);
+                }
+                // the reserve is an estimate, give back what the run didn't use
+                mesh->vertices.shrink_to_fit();
+            }
+            mesh = nullptr;
+        };
+        auto startMesh = [&](int material, size_t firstFace) {
+            finishMesh();
+            out.meshes.emplace_back();
+            mesh = &out.meshes.back();
+            mesh->material = material;
+            // Sized from the run's own faces, up to the next material switch, so K runs don't each
+            // reserve for the whole file.
+            size_t lastFace = faceSizes.size();
+            for (size_t s = nextSwitch; s < materialSwitches.size(); ++s) {
+                if (materialSwitches[s].first > firstFace) {
+                    lastFace = materialSwitches[s].first;
+                    break;
+                }
+            }
+            size_t runCorners = 0;
+            size_t runTriangles = 0;
+            for (size_t face = firstFace; face < lastFace; ++face) {
+                runCorners += faceSizes[face];
+                runTriangles += faceSizes[face] >= 3 ? faceSizes[face] - 2 : 0;
+            }
+            // about one vertex per position, a run can't have more than one per corner
+            size_t expectedVertices = std::min(runCorners, positions.size());
+            mesh->vertices.reserve(expectedVertices);
+            mesh->indices.reserve(runTriangles * 3);
+            vertexLookup.clear();
+            vertexLookup.reserve(expectedVertices);
+            hasNormals = true;
+            hasTexCoords = true;
+        };
+
+        auto cornerVertex = [&](const Corner &c) {
+            VertexKey key{c.v, c.vt, c.vn};
+            auto it = vertexLookup.find(key);
+            if (it != vertexLookup.end()) {
+                return it->second;
+            }
+            Vertex vertex{};
+            if (c.v >= 0 && static_cast<size_t>(c.v) < positions.size()) {
+                vertex.Position = positions[c.v];
+            }
+            if (c.vt >= 0 && static_cast<size_t>(c.vt) < texCoords.size()) {
+                vertex.TexCoords = glm::vec2(texCoords[c.vt].x, 1.0f - texCoords[c.vt].y);
+            } else {
+                hasTexCoords = false;
+            }
+            if (c.vn >= 0 && static_cast<size_t>(c.vn) < normals.size()) {
+                vertex.Normal = normals[c.vn];
+            } else {
+                hasNormals = false;
+            }
+            auto index = static_cast<unsigned int>(mesh->vertices.size());
+            mesh->vertices.push_back(vertex);
+            vertexLookup.emplace(key, index);
+            return index;
+        };
+
+        for (size_t face = 0; face < faceSizes.size(); ++face) {
+            while (nextSwitch < materialSwitches.size() && materialSwitches[nextSwitch].first == face) {
+                int material = materialIndex(materialSwitches[nextSwitch].second);
+                if (!mesh || mesh->material != material) {
+                    startMesh(material, face);
+                }
+                ++nextSwitch;
+            }
+            if (!mesh) {
+                startMesh(-1, face);
+            }
+
+            uint32_t n = faceSizes[face];
+            if (n >= 3) {
+                unsigned int first = cornerVertex(corners[corner]);
+                unsigned int previous = cornerVertex(corners[corner + 1]);
+                for (uint32_t i = 2; i < n; ++i) {
+                    unsigned int current = cornerVertex(corners[corner + i]);
+                    mesh->indices.push_back(first);
+                    mesh->indices.push_back(previous);
+                    mesh->indices.push_back(current);
+                    previous = current;
+                }
+            }
+            corner += n;
+        }
+        finishMesh();
+
+        return true;
+    }
+}
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rg/OcclusionBuffer.hpp>
+
+namespace rg {
+
+    namespace {
+        const int sphereRings = 8;
+        const int sphereSegments = 12;
+    }
+
+    OcclusionBuffer::OcclusionBuffer(int width, int height) : bufferWidth(width), bufferHeight(height) {
+        glm::ivec2 size(width, height);
+        while (true) {
+            sizes.push_back(size);
+            levels.emplace_back((size_t) size.x * size.y, 1.0f);
+            if (size.x == 1 && size.y == 1) {
+                break;
+            }
+            size = glm::ivec2((size.x + 1) / 2, (size.y + 1) / 2);
+        }
+
+        // unit UV sphere, counter clockwise seen from outside
+        for (int i = 0; i <= sphereRings; ++i) {
+            float theta = (float) M_PI * (float) i / sphereRings;
+            for (int j = 0; j <= sphereSegments; ++j) {
+                float phi = 2.0f * (float) M_PI * (float) j / sphereSegments;
+                sphereVertices.emplace_back(std::sin(theta) * std::cos(phi), std::cos(theta),
+                                            std::sin(theta) * std::sin(phi));
+            }
+        }
+        for (int i = 0; i < sphereRings; ++i) {
+            for (int j = 0; j < sphereSegments; ++j) {
+                unsigned int a = i * (sphereSegments + 1) + j;
+                unsigned int b = a + sphereSegments + 1;
+                sphereIndices.insert(sphereIndices.end(), {a, a + 1, b, a + 1, b + 1, b});
+            }
+        }
+    }
+
+    void OcclusionBuffer::clear(const glm::mat4 &viewMatrix, const glm::mat4 &projectionMatrix) {
+        view = viewMatrix;
+        projection = projectionMatrix;
+        viewProjection = projection * view;
+        // glm::perspective: [2][2] = -(f + n) / (f - n), [3][2] = -2fn / (f - n)
+        nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+        std::fill(levels[0].begin(), levels[0].end(), 1.0f);
+        trianglesRasterized = 0;
+    }
+
+    void OcclusionBuffer::addOccluder(const glm::mat4 &model, const std::vector<glm::vec3> &positions,
+                                      const std::vector<unsigned int> &indices) {
+        glm::mat4 transform = viewProjection * model;
+        std::vector<glm::vec4> clip(positions.size());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            clip[i] = transform * glm::vec4(positions[i], 1.0f);
+        }
+        for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+            rasterize(clip[indices[i]], clip[indices[i + 1]], clip[indices[i + 2]]);
+        }
+    }
+
+    void OcclusionBuffer::addSphereOccluder(const glm::vec3 &center, float radius) {
+        glm::mat4 model(radius);
+        model[3] = glm::vec4(center, 1.0f);
+        addOccluder(model, sphereVertices, sphereIndices);
+    }
+
+    void OcclusionBuffer::rasterize(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c) {
+        if (a.z < -a.w || b.z < -b.w || c.z < -c.w) {
+            return;
+        }
+
+        auto toScreen = [&](const glm::vec4 &v) {
+            return glm::vec3((v.x / v.w * 0.5f + 0.5f) * (float) bufferWidth,
+                             (v.y / v.w * 0.5f + 0.5f) * (float) bufferHeight, v.z / v.w * 0.5f + 0.5f);
+        };
+        glm::vec3 p0 = toScreen(a), p1 = toScreen(b), p2 = toScreen(c);
+
+        float area = (p1.x - p0.x) * (p2.y - p0.y) - (p1.y - p0.y) * (p2.x - p0.x);
+        if (area <= 0.0f) {
+            return;
+        }
+
+        int minX = std::max(0, (int) std::floor(std::min({p0.x, p1.x, p2.x})));
+        int maxX = std::min(bufferWidth - 1, (int) std::ceil(std::max({p0.x, p1.x, p2.x})));
+        int minY = std::max(0, (int) std::floor(std::min({p0.y, p1.y, p2.y})));
+        int maxY = std::min(bufferHeight - 1, (int) std::ceil(std::max({p0.y, p1.y, p2.y})));
+        if (minX > maxX || minY > maxY) {
+            return;
+        }
+        ++trianglesRasterized;
+
+        // edge functions at the first pixel center, stepped incrementally along rows and columns
+        float invArea = 1.0f / area;
+        glm::vec2 start((float) minX + 0.5f, (float) minY + 0.5f);
+        auto edge = [&](const glm::vec3 &u, const glm::vec3 &v) {
+            return (v.x - u.x) * (start.y - u.y) - (v.y - u.y) * (start.x - u.x);
+        };
+        float row0 = edge(p1, p2), row1 = edge(p2, p0), row2 = edge(p0, p1);
+        float stepX0 = -(p2.y - p1.y), stepX1 = -(p0.y - p2.y), stepX2 = -(p1.y - p0.y);
+        float stepY0 = p2.x - p1.x, stepY1 = p0.x - p2.x, stepY2 = p1.x - p0.x;
+
+        std::vector<float> &depth = levels[0];
+        for (int y = minY; y <= maxY; ++y) {
+            float w0 = row0, w1 = row1, w2 = row2;
+            float *line = &depth[(size_t) y * bufferWidth];
+            for (int x = minX; x <= maxX; ++x) {
+                if (w0 >= 0.0f && w1 >= 0.0f && w2 >= 0.0f) {
+                    float z = (w0 * p0.z + w1 * p1.z + w2 * p2.z) * invArea;
+                    line[x] = std::min(line[x], z);
+                }
+                w0 += stepX0;
+                w1 += stepX1;
+                w2 += stepX2;
+            }
+            row0 += stepY0;
+            row1 += stepY1;
+            row2 += stepY2;
+        }
+    }
+
+    void OcclusionBuffer::buildPyramid() {
+        for (size_t level = 1; level < levels.size(); ++level) {
+            const std::vector<float> &below = levels[level - 1];
+            std::vector<float> &current = levels[level];
+            glm::ivec2 belowSize = sizes[level - 1];
+            glm::ivec2 size = sizes[level];
+            for (int y = 0; y < size.y; ++y) {
+                int y0 = 2 * y, y1 = std::min(2 * y + 1, belowSize.y - 1);
+                for (int x = 0; x < size.x; ++x) {
+                    int x0 = 2 * x, x1 = std::min(2 * x + 1, belowSize.x - 1);
+                    current[(size_t) y * size.x + x] = std::max(
+                            std::max(below[(size_t) y0 * belowSize.x + x0], below[(size_t) y0 * belowSize.x + x1]),
+                            std::max(below[(size_t) y1 * belowSize.x + x0], below[(size_t) y1 * belowSize.x + x1]));
+                }
+            }
+        }
+    }
+
+    bool OcclusionBuffer::isVisible(const glm::vec3 &center, float radius) const {
+        glm::vec4 viewCenter = view * glm::vec4(center, 1.0f);
+        if (-viewCenter.z + radius < nearPlane) {
+            return false;
+        }
+        if (-viewCenter.z - radius < nearPlane) {
+            // crosses the near plane, the projected bounds below would be wrong
+            return true;
+        }
+
+        // screen bounds from the corners of the view space box around the sphere
+        glm::vec2 minNdc(1e30f), maxNdc(-1e30f);
+        for (int corner = 0; corner < 8; ++corner) {
+            glm::vec4 p = viewCenter + glm::vec4(corner & 1 ? radius : -radius, corner & 2 ? radius : -radius,
+                                                 corner & 4 ? radius : -radius, 0.0f);
+            glm::vec4 clip = projection * p;
+            minNdc.x = std::min(minNdc.x, clip.x / clip.w);
+            minNdc.y = std::min(minNdc.y, clip.y / clip.w);
+            maxNdc.x = std::max(maxNdc.x, clip.x / clip.w);
+            maxNdc.y = std::max(maxNdc.y, clip.y / clip.w);
+        }
+        if (maxNdc.x < -1.0f || minNdc.x > 1.0f || maxNdc.y < -1.0f || minNdc.y > 1.0f) {
+            return false;
+        }
+
+        // perspective depth only depends on view z, the nearest point is straight towards the camera
+        glm::vec4 nearest = projection * glm::vec4(viewCenter.x, viewCenter.y, viewCenter.z + radius, 1.0f);
+        float nearestDepth = nearest.z / nearest.w * 0.5f + 0.5f;
+
+        int x0 = glm::clamp((int) std::floor((minNdc.x * 0.5f + 0.5f) * bufferWidth), 0, bufferWidth - 1);
+        int x1 = glm::clamp((int) std::floor((maxNdc.x * 0.5f + 0.5f) * bufferWidth), 0, bufferWidth - 1);
+        int y0 = glm::clamp((int) std::floor((minNdc.y * 0.5f + 0.5f) * bufferHeight), 0, bufferHeight - 1);
+        int y1 = glm::clamp((int) std::floor((maxNdc.y * 0.5f + 0.5f) * bufferHeight), 0, bufferHeight - 1);
+
+        // the coarsest level where the rectangle touches at most 2x2 texels
+        int extent = std::max(x1 - x0, y1 - y0) + 1;
+        int level = 0;
+        while ((1 << level) < extent && level + 1 < levelCount()) {
+            ++level;
+        }
+
+        float farthest = 0.0f;
+        for (int y = y0 >> level; y <= y1 >> level; ++y) {
+            for (int x = x0 >> level; x <= x1 >> level; ++x) {
+                farthest = std::max(farthest, depth(x, y, level));
+            }
+        }
+        return nearestDepth <= farthest;
+    }
+
+    int OcclusionBuffer::width() const {
+        return bufferWidth;
+    }
+
+    int OcclusionBuffer::height() const {
+        return bufferHeight;
+    }
+
+    int OcclusionBuffer::levelCount() const {
+        return (int) levels.size();
+    }
+
+    float OcclusionBuffer::depth(int x, int y, int level) const {
+        return levels[level][(size_t) y * sizes[level].x + x];
+    }
+}
@@ -0,0 +1,183 @@
+#include <cmath>
+
+#if defined(__x86_64__)
+#define RG_ORBIT_X86 1
+#include <immintrin.h>
+#endif
+
+#include <rg/OrbitTransforms.hpp>
+
+namespace rg {
+
+    void OrbitBatch::add(float orbitRadius, float orbitHeight, float phase, const glm::vec3 &axis) {
+        radius.push_back(orbitRadius);
+        height.push_back(orbitHeight);
+        sinPhase.push_back(std::sin(phase));
+        cosPhase.push_back(std::cos(phase));
+        axisX.push_back(axis.x);
+        axisY.push_back(axis.y);
+        axisZ.push_back(axis.z);
+    }
+
+    size_t OrbitBatch::size() const {
+        return radius.size();
+    }
+
+    // Rotation part is the glm::rotate axis-angle matrix:
+    //   R = c * I + (1 - c) * a * a^T + s * [a]x
+    // Translation uses sin(phase + angle) = sin(phase) * cos(angle) + cos(phase) * sin(angle).
+    void buildOrbitTransformsScalar(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                                    size_t first, size_t count) {
+        const float so = std::sin(orbitAngle), co = std::cos(orbitAngle);
+        const float s = std::sin(spinAngle), c = std::cos(spinAngle), t = 1.0f - c;
+
+        for (size_t i = first; i < first + count; ++i, out += 16) {
+            float ax = batch.axisX[i], ay = batch.axisY[i], az = batch.axisZ[i];
+            out[0] = t * ax * ax + c;
+            out[1] = t * ax * ay + s * az;
+            out[2] = t * ax * az - s * ay;
+            out[3] = 0.0f;
+            out[4] = t * ay * ax - s * az;
+            out[5] = t * ay * ay + c;
+            out[6] = t * ay * az + s * ax;
+            out[7] = 0.0f;
+            out[8] = t * az * ax + s * ay;
+            out[9] = t * az * ay - s * ax;
+            out[10] = t * az * az + c;
+            out[11] = 0.0f;
+            out[12] = batch.radius[i] * (batch.sinPhase[i] * co + batch.cosPhase[i] * so);
+            out[13] = batch.height[i];
+            out[14] = batch.radius[i] * (batch.cosPhase[i] * co - batch.sinPhase[i] * so);
+            out[15] = 1.0f;
+        }
+    }
+
+#ifdef RG_ORBIT_X86
+    namespace {
+
+        // Transposes the x/y/z/w component vectors of four instances into four matrix columns.
+        inline void storeColumns(__m128 x, __m128 y, __m128 z, __m128 w, float *out, int column) {
+            _MM_TRANSPOSE4_PS(x, y, z, w);
+            _mm_storeu_ps(out + column * 4, x);
+            _mm_storeu_ps(out + 16 + column * 4, y);
+            _mm_storeu_ps(out + 32 + column * 4, z);
+            _mm_storeu_ps(out + 48 + column * 4, w);
+        }
+
+        __attribute__((target("avx2,fma")))
+        inline void storeColumns8(__m256 x, __m256 y, __m256 z, __m256 w, float *out, int column) {
+            __m128 xl = _mm256_castps256_ps128(x), xh = _mm256_extractf128_ps(x, 1);
+            __m128 yl = _mm256_castps256_ps128(y), yh = _mm256_extractf128_ps(y, 1);
+            __m128 zl = _mm256_castps256_ps128(z), zh = _mm256_extractf128_ps(z, 1);
+            __m128 wl = _mm256_castps256_ps128(w), wh = _mm256_extractf128_ps(w, 1);
+            storeColumns(xl, yl, zl, wl, out, column);
+            storeColumns(xh, yh, zh, wh, out + 64, column);
+        }
+
+        bool hasAVX2() {
+            static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            return supported;
+        }
+    }
+
+    void buildOrbitTransformsSSE(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                                 size_t first, size_t count) {
+        const __m128 so = _mm_set1_ps(std::sin(orbitAngle)), co = _mm_set1_ps(std::cos(orbitAngle));
+        const __m128 s = _mm_set1_ps(std::sin(spinAngle)), c = _mm_set1_ps(std::cos(spinAngle));
+        const __m128 t = _mm_sub_ps(_mm_set1_ps(1.0f), c);
+        const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 4 <= first + count; i += 4, out += 64) {
+            __m128 ax = _mm_loadu_ps(&batch.axisX[i]);
+            __m128 ay = _mm_loadu_ps(&batch.axisY[i]);
+            __m128 az = _mm_loadu_ps(&batch.axisZ[i]);
+            __m128 tx = _mm_mul_ps(t, ax), ty = _mm_mul_ps(t, ay), tz = _mm_mul_ps(t, az);
+            __m128 sx = _mm_mul_ps(s, ax), sy = _mm_mul_ps(s, ay), sz = _mm_mul_ps(s, az);
+
+            storeColumns(_mm_add_ps(_mm_mul_ps(tx, ax), c),
+                         _mm_add_ps(_mm_mul_ps(tx, ay), sz),
+                         _mm_sub_ps(_mm_mul_ps(tx, az), sy),
+                         zero, out, 0);
+            storeColumns(_mm_sub_ps(_mm_mul_ps(ty, ax), sz),
+                         _mm_add_ps(_mm_mul_ps(ty, ay), c),
+                         _mm_add_ps(_mm_mul_ps(ty, az), sx),
+                         zero, out, 1);
+            storeColumns(_mm_add_ps(_mm_mul_ps(tz, ax), sy),
+                         _mm_sub_ps(_mm_mul_ps(tz, ay), sx),
+                         _mm_add_ps(_mm_mul_ps(tz, az), c),
+                         zero, out, 2);
+
+            __m128 r = _mm_loadu_ps(&batch.radius[i]);
+            __m128 sp = _mm_loadu_ps(&batch.sinPhase[i]);
+            __m128 cp = _mm_loadu_ps(&batch.cosPhase[i]);
+            storeColumns(_mm_mul_ps(r, _mm_add_ps(_mm_mul_ps(sp, co), _mm_mul_ps(cp, so))),
+                         _mm_loadu_ps(&batch.height[i]),
+                         _mm_mul_ps(r, _mm_sub_ps(_mm_mul_ps(cp, co), _mm_mul_ps(sp, so))),
+                         one, out, 3);
+        }
+        buildOrbitTransformsScalar(batch, orbitAngle, spinAngle, out, i, first + count - i);
+    }
+
+    __attribute__((target("avx2,fma")))
+    void buildOrbitTransformsAVX2(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                                  size_t first, size_t count) {
+        const __m256 so = _mm256_set1_ps(std::sin(orbitAngle)), co = _mm256_set1_ps(std::cos(orbitAngle));
+        const __m256 s = _mm256_set1_ps(std::sin(spinAngle)), c = _mm256_set1_ps(std::cos(spinAngle));
+        const __m256 t = _mm256_sub_ps(_mm256_set1_ps(1.0f), c);
+        const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+        size_t i = first;
+        for (; i + 8 <= first + count; i += 8, out += 128) {
+            __m256 ax = _mm256_loadu_ps(&batch.axisX[i]);
+            __m256 ay = _mm256_loadu_ps(&batch.axisY[i]);
+            __m256 az = _mm256_loadu_ps(&batch.axisZ[i]);
+            __m256 tx = _mm256_mul_ps(t, ax), ty = _mm256_mul_ps(t, ay), tz = _mm256_mul_ps(t, az);
+            __m256 sx = _mm256_mul_ps(s, ax), sy = _mm256_mul_ps(s, ay), sz = _mm256_mul_ps(s, az);
+
+            storeColumns8(_mm256_fmadd_ps(tx, ax, c),
+                          _mm256_fmadd_ps(tx, ay, sz),
+                          _mm256_fmsub_ps(tx, az, sy),
+                          zero, out, 0);
+            storeColumns8(_mm256_fmsub_ps(ty, ax, sz),
+                          _mm256_fmadd_ps(ty, ay, c),
+                          _mm256_fmadd_ps(ty, az, sx),
+                          zero, out, 1);
+            storeColumns8(_mm256_fmadd_ps(tz, ax, sy),
+                          _mm256_fmsub_ps(tz, ay, sx),
+                          _mm256_fmadd_ps(tz, az, c),
+                          zero, out, 2);
+
+            __m256 r = _mm256_loadu_ps(&batch.radius[i]);
+            __m256 sp = _mm256_loadu_ps(&batch.sinPhase[i]);
+            __m256 cp = _mm256_loadu_ps(&batch.cosPhase[i]);
+            storeColumns8(_mm256_mul_ps(r, _mm256_fmadd_ps(sp, co, _mm256_mul_ps(cp, so))),
+                          _mm256_loadu_ps(&batch.height[i]),
+                          _mm256_mul_ps(r, _mm256_fmsub_ps(cp, co, _mm256_mul_ps(sp, so))),
+                          one, out, 3);
+        }
+        buildOrbitTransformsSSE(batch, orbitAngle, spinAngle, out, i, first + count - i);
+    }
+#endif
+
+    void buildOrbitTransforms(const OrbitBatch &batch, float orbitAngle, float spinAngle, float *out,
+                              size_t first, size_t count) {
+#ifdef RG_ORBIT_X86
+        if (hasAVX2()) {
+            buildOrbitTransformsAVX2(batch, orbitAngle, spinAngle, out, first, count);
+        } else {
+            buildOrbitTransformsSSE(batch, orbitAngle, spinAngle, out, first, count);
+        }
+#else
+        buildOrbitTransformsScalar(batch, orbitAngle, spinAngle, out, first, count);
+#endif
+    }
+
+    const char *orbitTransformsBackend() {
+#ifdef RG_ORBIT_X86
+        return hasAVX2() ? "avx2" : "sse";
+#else
+        return "scalar";
+#endif
+    }
+}
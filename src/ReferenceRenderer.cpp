@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <utility>
+
+#if defined(__x86_64__)
+#define RG_RASTER_X86 1
+#include <immintrin.h>
+#endif
+
+#include <stb_image.h>
+
+#include <rg/ReferenceRenderer.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+
+        float srgbToLinear(float c) {
+            return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+
+        // Edge function through a and b, always computed from the same endpoint order so the two
+        // triangles sharing an edge get exactly negated values and the fill rule can't leave gaps.
+        void edgeFunction(float ax, float ay, float bx, float by, float &a, float &b, float &c) {
+            bool swapped = bx < ax || (bx == ax && by < ay);
+            if (swapped) {
+                std::swap(ax, bx);
+                std::swap(ay, by);
+            }
+            a = -(by - ay);
+            b = bx - ax;
+            c = -(a * ax + b * ay);
+            if (swapped) {
+                a = -a;
+                b = -b;
+                c = -c;
+            }
+        }
+
+        // Same terms as CalcPointLight/CalcSpotLight in lighting.glsl, normal not renormalized after interpolation.
+        glm::vec3 blinnPhong(const glm::vec3 &lightPos, const glm::vec3 &ambientColor, const glm::vec3 &diffuseColor,
+                             const glm::vec3 &specularColor, float constant, float linear, float quadratic,
+                             const glm::vec3 &fragPos, const glm::vec3 &viewPos, const glm::vec3 &normal,
+                             const glm::vec3 &albedo, float shininess, float intensity) {
+            glm::vec3 lightDir = glm::normalize(lightPos - fragPos);
+            glm::vec3 viewDir = glm::normalize(viewPos - fragPos);
+            glm::vec3 halfwayDir = glm::normalize(lightDir + viewDir);
+            float distance = glm::length(lightPos - fragPos);
+            float attenuation = 1.0f / (constant + linear * distance + quadratic * (distance * distance));
+
+            float diff = std::max(glm::dot(normal, lightDir), 0.0f);
+            float spec = std::pow(std::max(glm::dot(normal, halfwayDir), 0.0f), shininess);
+
+            glm::vec3 ambient = ambientColor * albedo;
+            glm::vec3 diffuse = diffuseColor * diff * albedo;
+            glm::vec3 specular = specularColor * spec;
+            return (ambient + diffuse + specular) * (attenuation * intensity);
+        }
+    }
+
+    glm::vec3 ReferenceRenderer::CpuTexture::sample(const glm::vec2 &uv) const {
+        // GL_REPEAT and GL_LINEAR, texel centers at half integers
+        float u = uv.x * (float) width - 0.5f;
+        float v = uv.y * (float) height - 0.5f;
+        float fu = std::floor(u), fv = std::floor(v);
+        float tu = u - fu, tv = v - fv;
+        auto wrap = [](int i, int n) {
+            i %= n;
+            return i < 0 ? i + n : i;
+        };
+        int x0 = wrap((int) fu, width), x1 = wrap((int) fu + 1, width);
+        int y0 = wrap((int) fv, height), y1 = wrap((int) fv + 1, height);
+
+        auto texel = [&](int x, int y) {
+            const unsigned char *p = &rgba[((size_t) y * width + x) * 4];
+            glm::vec3 c(p[0] / 255.0f, p[1] / 255.0f, p[2] / 255.0f);
+            return srgb ? glm::vec3(srgbToLinear(c.x), srgbToLinear(c.y), srgbToLinear(c.z)) : c;
+        };
+        glm::vec3 bottom = glm::mix(texel(x0, y0), texel(x1, y0), tu);
+        glm::vec3 top = glm::mix(texel(x0, y1), texel(x1, y1), tu);
+        return glm::mix(bottom, top, tv);
+    }
+
+    ReferenceRenderer::ReferenceRenderer(int width, int height)
+            : imageWidth(width), imageHeight(height), tilesX((width + tileSize - 1) / tileSize),
+              tilesY((height + tileSize - 1) / tileSize), color((size_t) width * height),
+              depth((size_t) width * height, 1.0f) {
+    }
+
+    void ReferenceRenderer::begin(const Camera &camera, const PointLight &pointLight, const SpotLight &spotLight) {
+        viewProjection = camera.getPerspectiveMatrix((float) imageWidth / (float) imageHeight) * camera.getViewMatrix();
+        viewPos = camera.position;
+        point = pointLight;
+        spot = spotLight;
+        std::fill(color.begin(), color.end(), glm::vec3(0.0f));
+        std::fill(depth.begin(), depth.end(), 1.0f);
+        vertices.clear();
+        triangles.clear();
+        materials.clear();
+        frameStats = Stats();
+    }
+
+    int ReferenceRenderer::loadTexture(const std::string &path, bool srgb, bool flip) {
+        std::string key = path + (srgb ? "#srgb" : "#linear") + (flip ? "#flip" : "");
+        auto it = textureIds.find(key);
+        if (it != textureIds.end()) {
+            return it->second;
+        }
+
+        int width, height, nrComponents;
+        stbi_set_flip_vertically_on_load(flip);
+        unsigned char *data = stbi_load(path.c_str(), &width, &height, &nrComponents, 4);
+        ASSERT(data != nullptr, "Texture failed to load at path: " << path);
+        textures.push_back({width, height, srgb, std::vector<unsigned char>(data, data + (size_t) width * height * 4)});
+        stbi_image_free(data);
+
+        int id = (int) textures.size() - 1;
+        textureIds[key] = id;
+        return id;
+    }
+
+    int ReferenceRenderer::addModel(ObjData data, const std::string &directory, bool gammaCorrection) {
+        models.push_back({std::move(data), directory, gammaCorrection});
+        return (int) models.size() - 1;
+    }
+
+    int ReferenceRenderer::loadModel(const std::string &path, bool gammaCorrection) {
+        ObjData data;
+        if (!loadObj(path, data)) {
+            return -1;
+        }
+        return addModel(std::move(data), path.substr(0, path.find_last_of('/')), gammaCorrection);
+    }
+
+    void ReferenceRenderer::drawLit(int model, const glm::mat4 &transform, bool flipTextures) {
+        auto start = std::chrono::steady_clock::now();
+        const CpuModel &m = models[model];
+        for (const ObjMesh &mesh: m.data.meshes) {
+            int texture = -1;
+            if (mesh.material >= 0 && !m.data.materials[mesh.material].diffuseMap.empty()) {
+                texture = loadTexture(m.directory + "/" + m.data.materials[mesh.material].diffuseMap,
+                                      m.gammaCorrection, flipTextures);
+            }
+            materials.push_back({true, glm::vec3(0.0f), texture});
+            draw(mesh, transform, (int) materials.size() - 1);
+        }
+        frameStats.setupMilliseconds += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    void ReferenceRenderer::drawEmissive(int model, const glm::mat4 &transform, const glm::vec3 &emissive) {
+        auto start = std::chrono::steady_clock::now();
+        materials.push_back({false, emissive, -1});
+        for (const ObjMesh &mesh: models[model].data.meshes) {
+            draw(mesh, transform, (int) materials.size() - 1);
+        }
+        frameStats.setupMilliseconds += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    void ReferenceRenderer::draw(const ObjMesh &mesh, const glm::mat4 &transform, int material) {
+        glm::mat3 normalMatrix = glm::mat3(glm::inverse(glm::transpose(transform)));
+        std::vector<ClipVertex> transformed(mesh.vertices.size());
+        for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+            const Vertex &v = mesh.vertices[i];
+            glm::vec4 world = transform * glm::vec4(v.Position, 1.0f);
+            transformed[i] = {viewProjection * world, glm::vec3(world), normalMatrix * v.Normal, v.TexCoords};
+        }
+
+        auto lerp = [](const ClipVertex &a, const ClipVertex &b, float t) {
+            return ClipVertex{a.clip + (b.clip - a.clip) * t, glm::mix(a.world, b.world, t),
+                              glm::mix(a.normal, b.normal, t), a.uv + (b.uv - a.uv) * t};
+        };
+
+        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+            const ClipVertex *in[3] = {&transformed[mesh.indices[i]], &transformed[mesh.indices[i + 1]],
+                                       &transformed[mesh.indices[i + 2]]};
+            // distance to the near plane, z = -w in clip space
+            float d[3] = {in[0]->clip.z + in[0]->clip.w, in[1]->clip.z + in[1]->clip.w,
+                          in[2]->clip.z + in[2]->clip.w};
+            if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f) {
+                addTriangle(*in[0], *in[1], *in[2], material);
+                continue;
+            }
+
+            // Sutherland-Hodgman against the near plane, at most a quad comes out
+            ClipVertex polygon[4];
+            int count = 0;
+            for (int j = 0; j < 3; ++j) {
+                int k = (j + 1) % 3;
+                if (d[j] >= 0.0f) {
+                    polygon[count++] = *in[j];
+                }
+                if ((d[j] >= 0.0f) != (d[k] >= 0.0f)) {
+                    polygon[count++] = lerp(*in[j], *in[k], d[j] / (d[j] - d[k]));
+                }
+            }
+            for (int j = 1; j + 1 < count; ++j) {
+                addTriangle(polygon[0], polygon[j], polygon[j + 1], material);
+            }
+        }
+    }
+
+    void ReferenceRenderer::addTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2,
+                                        int material) {
+        const ClipVertex *v[3] = {&v0, &v1, &v2};
+        float x[3], y[3];
+        Triangle t{};
+        for (int i = 0; i < 3; ++i) {
+            t.invW[i] = 1.0f / v[i]->clip.w;
+            x[i] = (v[i]->clip.x * t.invW[i] * 0.5f + 0.5f) * (float) imageWidth;
+            y[i] = (v[i]->clip.y * t.invW[i] * 0.5f + 0.5f) * (float) imageHeight;
+            t.z[i] = v[i]->clip.z * t.invW[i] * 0.5f + 0.5f;
+        }
+
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+        if (!(area != 0.0f) || std::isnan(area)) {
+            return;
+        }
+        if (area < 0.0f) {
+            // no face culling in the GL path either, back faces are turned around
+            std::swap(v[1], v[2]);
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+            std::swap(t.z[1], t.z[2]);
+            std::swap(t.invW[1], t.invW[2]);
+            area = -area;
+        }
+
+        t.minX = std::max(0, (int) std::floor(std::min({x[0], x[1], x[2]})));
+        t.maxX = std::min(imageWidth - 1, (int) std::ceil(std::max({x[0], x[1], x[2]})));
+        t.minY = std::max(0, (int) std::floor(std::min({y[0], y[1], y[2]})));
+        t.maxY = std::min(imageHeight - 1, (int) std::ceil(std::max({y[0], y[1], y[2]})));
+        if (t.minX > t.maxX || t.minY > t.maxY) {
+            return;
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            int from = (i + 1) % 3, to = (i + 2) % 3;
+            edgeFunction(x[from], y[from], x[to], y[to], t.a[i], t.b[i], t.c[i]);
+            float dx = x[to] - x[from], dy = y[to] - y[from];
+            t.topLeft[i] = dy < 0.0f || (dy == 0.0f && dx < 0.0f);
+        }
+        t.invArea = 1.0f / area;
+        t.firstVertex = (int) vertices.size();
+        t.material = material;
+        vertices.insert(vertices.end(), {*v[0], *v[1], *v[2]});
+        triangles.push_back(t);
+        frameStats.triangles++;
+    }
+
+    void ReferenceRenderer::render(JobSystem &jobs) {
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::vector<int>> bins((size_t) tilesX * tilesY);
+        for (int i = 0; i < (int) triangles.size(); ++i) {
+            const Triangle &t = triangles[i];
+            for (int ty = t.minY / tileSize; ty <= t.maxY / tileSize; ++ty) {
+                for (int tx = t.minX / tileSize; tx <= t.maxX / tileSize; ++tx) {
+                    bins[(size_t) ty * tilesX + tx].push_back(i);
+                    frameStats.tileBins++;
+                }
+            }
+        }
+
+        std::vector<size_t> fragments(bins.size(), 0);
+        jobs.parallelFor(0, bins.size(), 1, [&](size_t first, size_t last) {
+            for (size_t tile = first; tile < last; ++tile) {
+                if (!bins[tile].empty()) {
+                    fragments[tile] = rasterizeTile((int) (tile % tilesX), (int) (tile / tilesX), bins[tile]);
+                }
+            }
+        });
+        for (size_t count: fragments) {
+            frameStats.fragments += count;
+        }
+
+        triangles.clear();
+        vertices.clear();
+        frameStats.rasterMilliseconds += std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - start).count();
+    }
+
+    size_t ReferenceRenderer::rasterizeTile(int tileX, int tileY, const std::vector<int> &bin) {
+        const int x0 = tileX * tileSize, y0 = tileY * tileSize;
+        const int x1 = std::min(x0 + tileSize, imageWidth) - 1, y1 = std::min(y0 + tileSize, imageHeight) - 1;
+        // padded so four wide loads at the end of the last row stay inside
+        float tileDepth[tileSize * tileSize + 4];
+        for (int y = y0; y <= y1; ++y) {
+            std::copy(&depth[(size_t) y * imageWidth + x0], &depth[(size_t) y * imageWidth + x1] + 1,
+                      &tileDepth[(y - y0) * tileSize]);
+        }
+
+        size_t shaded = 0;
+        for (int index: bin) {
+            const Triangle &t = triangles[index];
+            int rx0 = std::max(t.minX, x0), rx1 = std::min(t.maxX, x1);
+            int ry0 = std::max(t.minY, y0), ry1 = std::min(t.maxY, y1);
+
+            for (int y = ry0; y <= ry1; ++y) {
+                float py = (float) y + 0.5f;
+                float row[3] = {t.b[0] * py + t.c[0], t.b[1] * py + t.c[1], t.b[2] * py + t.c[2]};
+                float *depthRow = &tileDepth[(y - y0) * tileSize];
+
+                for (int x = rx0; x <= rx1; x += 4) {
+                    float e[3][4], z[4];
+                    int mask;
+#ifdef RG_RASTER_X86
+                    __m128 px = _mm_add_ps(_mm_set1_ps((float) x), _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f));
+                    __m128 zero = _mm_setzero_ps();
+                    __m128 inside = _mm_cmpeq_ps(zero, zero);
+                    __m128 edge[3];
+                    for (int i = 0; i < 3; ++i) {
+                        edge[i] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(t.a[i]), px), _mm_set1_ps(row[i]));
+                        inside = _mm_and_ps(inside, t.topLeft[i] ? _mm_cmpge_ps(edge[i], zero)
+                                                                 : _mm_cmpgt_ps(edge[i], zero));
+                        _mm_storeu_ps(e[i], edge[i]);
+                    }
+                    __m128 fragmentDepth = _mm_mul_ps(
+                            _mm_add_ps(_mm_add_ps(_mm_mul_ps(edge[0], _mm_set1_ps(t.z[0])),
+                                                  _mm_mul_ps(edge[1], _mm_set1_ps(t.z[1]))),
+                                       _mm_mul_ps(edge[2], _mm_set1_ps(t.z[2]))), _mm_set1_ps(t.invArea));
+                    inside = _mm_and_ps(inside, _mm_cmplt_ps(fragmentDepth, _mm_loadu_ps(depthRow + (x - x0))));
+                    inside = _mm_and_ps(inside, _mm_cmple_ps(fragmentDepth, _mm_set1_ps(1.0f)));
+                    _mm_storeu_ps(z, fragmentDepth);
+                    mask = _mm_movemask_ps(inside);
+#else
+                    mask = 0;
+                    for (int lane = 0; lane < 4; ++lane) {
+                        float px = (float) (x + lane) + 0.5f;
+                        bool inside = true;
+                        for (int i = 0; i < 3; ++i) {
+                            e[i][lane] = t.a[i] * px + row[i];
+                            inside = inside && (t.topLeft[i] ? e[i][lane] >= 0.0f : e[i][lane] > 0.0f);
+                        }
+                        z[lane] = ((e[0][lane] * t.z[0] + e[1][lane] * t.z[1]) + e[2][lane] * t.z[2]) * t.invArea;
+                        if (inside && z[lane] < depthRow[x - x0 + lane] && z[lane] <= 1.0f) {
+                            mask |= 1 << lane;
+                        }
+                    }
+#endif
+                    mask &= (1 << std::min(4, rx1 - x + 1)) - 1;
+                    for (int lane = 0; mask != 0; ++lane, mask >>= 1) {
+                        if (mask & 1) {
+                            depthRow[x - x0 + lane] = z[lane];
+                            color[(size_t) y * imageWidth + x + lane] = shade(t, e[0][lane], e[1][lane], e[2][lane]);
+                            ++shaded;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int y = y0; y <= y1; ++y) {
+            std::copy(&tileDepth[(y - y0) * tileSize], &tileDepth[(y - y0) * tileSize] + (x1 - x0 + 1),
+                      &depth[(size_t) y * imageWidth + x0]);
+        }
+        return shaded;
+    }
+
+    glm::vec3 ReferenceRenderer::shade(const Triangle &triangle, float e0, float e1, float e2) const {
+        const Material &material = materials[triangle.material];
+        if (!material.lit) {
+            return material.emissive;
+        }
+
+        // perspective correct weights
+        float w0 = e0 * triangle.invW[0], w1 = e1 * triangle.invW[1], w2 = e2 * triangle.invW[2];
+        float invSum = 1.0f / (w0 + w1 + w2);
+        w0 *= invSum;
+        w1 *= invSum;
+        w2 *= invSum;
+        const ClipVertex &a = vertices[triangle.firstVertex];
+        const ClipVertex &b = vertices[triangle.firstVertex + 1];
+        const ClipVertex &c = vertices[triangle.firstVertex + 2];
+        glm::vec3 fragPos = a.world * w0 + b.world * w1 + c.world * w2;
+        glm::vec3 normal = a.normal * w0 + b.normal * w1 + c.normal * w2;
+        glm::vec2 uv = a.uv * w0 + b.uv * w1 + c.uv * w2;
+
+        glm::vec3 albedo = material.texture >= 0 ? textures[material.texture].sample(uv) : glm::vec3(1.0f);
+        glm::vec3 result = blinnPhong(point.position, point.ambient, point.diffuse, point.specular, point.constant,
+                                      point.linear, point.quadratic, fragPos, viewPos, normal, albedo, 32.0f, 1.0f);
+
+        glm::vec3 lightDir = glm::normalize(spot.position - fragPos);
+        float theta = glm::dot(lightDir, glm::normalize(-spot.direction));
+        float intensity = glm::clamp((theta - spot.outerCutOff) / (spot.cutOff - spot.outerCutOff), 0.0f, 1.0f);
+        result += blinnPhong(spot.position, spot.ambient, spot.diffuse, spot.specular, spot.constant, spot.linear,
+                             spot.quadratic, fragPos, viewPos, normal, albedo, 32.0f, intensity);
+        return result;
+    }
+
+    int ReferenceRenderer::width() const {
+        return imageWidth;
+    }
+
+    int ReferenceRenderer::height() const {
+        return imageHeight;
+    }
+
+    const glm::vec3 &ReferenceRenderer::pixel(int x, int y) const {
+        return color[(size_t) y * imageWidth + x];
+    }
+
+    std::vector<unsigned char> ReferenceRenderer::toneMapped(float exposure) const {
+        std::vector<unsigned char> image((size_t) imageWidth * imageHeight * 3);
+        for (int y = 0; y < imageHeight; ++y) {
+            unsigned char *line = &image[(size_t) (imageHeight - 1 - y) * imageWidth * 3];
+            for (int x = 0; x < imageWidth; ++x) {
+                const glm::vec3 &hdrColor = pixel(x, y);
+                for (int i = 0; i < 3; ++i) {
+                    float mapped = 1.0f - std::exp(-hdrColor[i] * exposure);
+                    float value = std::pow(mapped, 1.0f / 2.2f);
+                    line[(size_t) x * 3 + i] = (unsigned char) std::lround(glm::clamp(value, 0.0f, 1.0f) * 255.0f);
+                }
+            }
+        }
+        return image;
+    }
+
+    bool ReferenceRenderer::writePPM(const std::string &path, float exposure) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        std::vector<unsigned char> image = toneMapped(exposure);
+        file << "P6\n" << imageWidth << ' ' << imageHeight << "\n255\n";
+        file.write((const char *) image.data(), (std::streamsize) image.size());
+        return (bool) file;
+    }
+
+    const ReferenceRenderer::Stats &ReferenceRenderer::stats() const {
+        return frameStats;
+    }
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cmath>
+
+#include <rg/RenderTargets.hpp>
+
+namespace rg {
+
+    const TargetFormat packedHdrFormat{GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT, 4, "R11F_G11F_B10F", "r11f_g11f_b10f"};
+    const TargetFormat halfFloatFormat{GL_RGBA16F, GL_RGBA, GL_FLOAT, 8, "RGBA16F", "rgba16f"};
+    const TargetFormat ldrFormat{GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, 4, "RGBA8", "rgba8"};
+    const TargetFormat meteringFormat{GL_RG16F, GL_RG, GL_FLOAT, 4, "RG16F", "rg16f"};
+    const TargetFormat normalFormat{GL_RG16F, GL_RG, GL_FLOAT, 4, "RG16F", "rg16f"};
+    const TargetFormat depthFormat{GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4, "DEPTH24", nullptr};
+
+    RenderTargets renderTargets;
+
+    unsigned int RenderTargets::createTexture(const std::string &name, int width, int height,
+                                              const TargetFormat &format, float accessesPerFrame) {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.format, format.type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        track(name, width, height, format, accessesPerFrame);
+        return texture;
+    }
+
+    void RenderTargets::track(const std::string &name, int width, int height, const TargetFormat &format,
+                              float accessesPerFrame, int levels, int samples) {
+        entries.push_back({name, width, height, &format, accessesPerFrame, levels, samples});
+    }
+
+    void RenderTargets::release(const std::string &name) {
+        entries.erase(std::remove_if(entries.begin(), entries.end(), [&](const Entry &entry) {
+            return entry.name == name;
+        }), entries.end());
+    }
+
+    size_t RenderTargets::Entry::bytes() const {
+        size_t total = 0;
+        for (int level = 0; level < levels; ++level) {
+            total += (size_t) std::max(1, width >> level) * std::max(1, height >> level) * format->bytesPerPixel;
+        }
+        return total * samples;
+    }
+
+    size_t RenderTargets::memoryUsage() const {
+        size_t bytes = 0;
+        for (const Entry &entry: entries) {
+            bytes += entry.bytes();
+        }
+        return bytes;
+    }
+
+    void RenderTargets::report(std::ostream &out) const {
+        const double MiB = 1024.0 * 1024.0;
+        size_t baseline = 0;
+        double traffic = 0.0;
+        double baselineTraffic = 0.0;
+        for (const Entry &entry: entries) {
+            // depth and metering never were RGBA16F, they count as they are
+            bool colour = entry.format != &depthFormat && entry.format != &meteringFormat;
+            int baselinePixel = colour ? halfFloatFormat.bytesPerPixel : entry.format->bytesPerPixel;
+            size_t bytes = entry.bytes();
+            size_t halfFloatBytes = bytes / entry.format->bytesPerPixel * baselinePixel;
+            // mip levels past the first are only touched while downsampling, leave them out of the traffic
+            double pixelAccesses = (double) entry.width * entry.height * entry.samples * entry.accessesPerFrame;
+            baseline += halfFloatBytes;
+            traffic += pixelAccesses * entry.format->bytesPerPixel;
+            baselineTraffic += pixelAccesses * baselinePixel;
+            out << "  " << entry.name << ' ' << entry.width << 'x' << entry.height << ' ' << entry.format->name;
+            if (entry.samples > 1) {
+                out << ' ' << entry.samples << "x MSAA";
+            }
+            out << ": " << bytes / 1024 << " KiB (RGBA16F " << halfFloatBytes / 1024 << " KiB), ~"
+                << pixelAccesses * entry.format->bytesPerPixel / MiB << " MiB per frame\n";
+        }
+        out << "  total " << memoryUsage() / 1024 << " KiB (RGBA16F " << baseline / 1024 << " KiB), ~"
+            << traffic / MiB << " MiB per frame (RGBA16F ~" << baselineTraffic / MiB << " MiB)\n";
+    }
+
+    namespace {
+        // Round a non-negative value to a float with a 5 bit exponent (bias 15) and the given mantissa bits,
+        // the layout shared by half floats and the packed 11/10 bit ones.
+        float quantizeSmallFloat(float value, int mantissaBits) {
+            if (!(value > 0.0f)) {
+                return 0.0f; // the packed formats have no sign, negatives and NaN clamp to 0
+            }
+            const float largest = (2.0f - std::ldexp(1.0f, -mantissaBits)) * 32768.0f;
+            value = std::min(value, largest);
+            int exponent = std::max(std::ilogb(value), -14); // below 2^-14 the spacing stays that of denormals
+            float step = std::ldexp(1.0f, exponent - mantissaBits);
+            return std::min(std::round(value / step) * step, largest);
+        }
+    }
+
+    glm::vec3 RenderTargets::quantize(const glm::vec3 &color, const TargetFormat &format) {
+        if (format.internalFormat == GL_R11F_G11F_B10F) {
+            return {quantizeSmallFloat(color.r, 6), quantizeSmallFloat(color.g, 6), quantizeSmallFloat(color.b, 5)};
+        }
+        if (format.internalFormat == GL_RGBA16F) {
+            // the scene never writes negatives, so the sign bit doesn't matter here
+            return {quantizeSmallFloat(color.r, 10), quantizeSmallFloat(color.g, 10), quantizeSmallFloat(color.b, 10)};
+        }
+        auto unorm8 = [](float value) {
+            return std::round(std::min(std::max(value, 0.0f), 1.0f) * 255.0f) / 255.0f;
+        };
+        return {unorm8(color.r), unorm8(color.g), unorm8(color.b)};
+    }
+}
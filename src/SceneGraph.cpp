@@ -0,0 +1,81 @@
+#include <rg/SceneGraph.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    constexpr int SceneGraph::noParent;
+
+    int SceneGraph::addNode(int parent) {
+        ASSERT(parent == noParent || (parent >= 0 && parent < (int) size()), "Parent node does not exist.");
+        parents.push_back(parent);
+        translations.emplace_back(0.0f);
+        rotations.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+        scales.emplace_back(1.0f);
+        worlds.emplace_back(1.0f);
+        dirty.push_back(1);
+        changed.push_back(0);
+        return (int) size() - 1;
+    }
+
+    size_t SceneGraph::size() const {
+        return parents.size();
+    }
+
+    int SceneGraph::parent(int node) const {
+        return parents[node];
+    }
+
+    void SceneGraph::setTranslation(int node, const glm::vec3 &translation) {
+        translations[node] = translation;
+        dirty[node] = 1;
+    }
+
+    void SceneGraph::setRotation(int node, const glm::quat &rotation) {
+        rotations[node] = rotation;
+        dirty[node] = 1;
+    }
+
+    void SceneGraph::setScale(int node, const glm::vec3 &scale) {
+        scales[node] = scale;
+        dirty[node] = 1;
+    }
+
+    const glm::vec3 &SceneGraph::translation(int node) const {
+        return translations[node];
+    }
+
+    void SceneGraph::update() {
+        lastUpdated = 0;
+        for (size_t i = 0; i < size(); ++i) {
+            int p = parents[i];
+            // parents come first, so changed[p] is already final for this pass
+            if (!dirty[i] && (p == noParent || !changed[p])) {
+                changed[i] = 0;
+                continue;
+            }
+
+            glm::mat4 local = glm::mat4_cast(rotations[i]);
+            local[0] *= scales[i].x;
+            local[1] *= scales[i].y;
+            local[2] *= scales[i].z;
+            local[3] = glm::vec4(translations[i], 1.0f);
+
+            worlds[i] = p == noParent ? local : worlds[p] * local;
+            dirty[i] = 0;
+            changed[i] = 1;
+            ++lastUpdated;
+        }
+    }
+
+    const glm::mat4 &SceneGraph::world(int node) const {
+        return worlds[node];
+    }
+
+    glm::vec3 SceneGraph::worldPosition(int node) const {
+        return glm::vec3(worlds[node][3]);
+    }
+
+    size_t SceneGraph::lastUpdateCount() const {
+        return lastUpdated;
+    }
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <utility>
 
 #include <glad/glad.h>
@@ -6,41 +7,54 @@
 #include <rg/Shader.hpp>
 #include <rg/utils/utils.hpp>
 #include <rg/utils/debug.hpp>
+#include <rg/utils/glext.hpp>
 
 namespace rg {
 
     extern bool gladLoaded;
 
-    Shader::Shader(std::string vertexShaderPath, std::string fragmentShaderPath) {
+    Shader::Shader(std::string vertexShaderPath, std::string fragmentShaderPath)
+            : Shader(std::move(vertexShaderPath), std::move(fragmentShaderPath), "") {
+    }
+
+    Shader::Shader(std::string vertexShaderPath, std::string fragmentShaderPath, const std::string &defines) {
         ASSERT(gladLoaded, "Glad is not loaded.");
 //        appendShaderFolderIfNotPresent(vertexShaderPath);
 //        appendShaderFolderIfNotPresent(fragmentShaderPath);
-        std::string vsString = readFileContents(std::move(vertexShaderPath));
+        std::string vsString = loadSource(vertexShaderPath);
         ASSERT(!vsString.empty(), "Vertex shader source is empty!");
-        std::string fsString = readFileContents(std::move(fragmentShaderPath));
+        std::string fsString = loadSource(fragmentShaderPath);
         ASSERT(!fsString.empty(), "Fragment shader source is empty!");
 
-        int vertexShader = compileShader(GL_VERTEX_SHADER, vsString);
-        int fragmentShader = compileShader(GL_FRAGMENT_SHADER, fsString);
+        int vertexShader = compileShader(GL_VERTEX_SHADER, injectDefines(vsString, defines));
+        int fragmentShader = compileShader(GL_FRAGMENT_SHADER, injectDefines(fsString, defines));
 
-        // Link Shaders:
-        int shaderProgram = glCreateProgram();
-        glAttachShader(shaderProgram, vertexShader);
-        glAttachShader(shaderProgram, fragmentShader);
-        glLinkProgram(shaderProgram);
+        pId = linkProgram({vertexShader, fragmentShader});
+    }
 
-        // Check for linking errors:
-        int success;
-        char infoLog[512];
-        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-        if (!success) {
-            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
-            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog <<
-                      std::endl;
-        }
-        glDeleteShader(vertexShader);
-        glDeleteShader(fragmentShader);
-        pId = shaderProgram;
+    Shader::Shader(const std::string &vertexShaderPath, const std::string &geometryShaderPath,
+                   const std::string &fragmentShaderPath, const std::string &defines) {
+        ASSERT(gladLoaded, "Glad is not loaded.");
+        std::string vsString = loadSource(vertexShaderPath);
+        ASSERT(!vsString.empty(), "Vertex shader source is empty!");
+        std::string gsString = loadSource(geometryShaderPath);
+        ASSERT(!gsString.empty(), "Geometry shader source is empty!");
+        std::string fsString = loadSource(fragmentShaderPath);
+        ASSERT(!fsString.empty(), "Fragment shader source is empty!");
+
+        pId = linkProgram({compileShader(GL_VERTEX_SHADER, injectDefines(vsString, defines)),
+                           compileShader(GL_GEOMETRY_SHADER, injectDefines(gsString, defines)),
+                           compileShader(GL_FRAGMENT_SHADER, injectDefines(fsString, defines))});
+    }
+
+    Shader Shader::compute(const std::string &computeShaderPath, const std::string &defines) {
+        ASSERT(gladLoaded && glext.computeShaders, "Compute shaders are not available.");
+        std::string csString = loadSource(computeShaderPath);
+        ASSERT(!csString.empty(), "Compute shader source is empty!");
+
+        Shader shader;
+        shader.pId = linkProgram({compileShader(GL_COMPUTE_SHADER, injectDefines(csString, defines))});
+        return shader;
     }
 
     // activate the shader
@@ -58,10 +72,18 @@ namespace rg {
         glUniform1i(glGetUniformLocation(pId, name.c_str()), value);
     }
 
+    void Shader::setIVec2(const std::string &name, int x, int y) const {
+        glUniform2i(glGetUniformLocation(pId, name.c_str()), x, y);
+    }
+
     void Shader::setFloat(const std::string &name, float value) const {
         glUniform1f(glGetUniformLocation(pId, name.c_str()), value);
     }
 
+    void Shader::setFloats(const std::string &name, const float *values, int count) const {
+        glUniform1fv(glGetUniformLocation(pId, name.c_str()), count, values);
+    }
+
     void Shader::setVec2(const std::string &name, const glm::vec2 &value) const {
         glUniform2fv(glGetUniformLocation(pId, name.c_str()), 1, &value[0]);
     }
@@ -145,7 +167,8 @@ namespace rg {
         glGetShaderiv(shaderId, GL_COMPILE_STATUS, &success);
         if (!success) {
             glGetShaderInfoLog(shaderId, 512, nullptr, infoLog);
-            std::cout << "ERROR::SHADER::" << (type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT")
+            std::cout << "ERROR::SHADER::" << (type == GL_VERTEX_SHADER ? "VERTEX" : type == GL_GEOMETRY_SHADER ? "GEOMETRY"
+                                              : type == GL_FRAGMENT_SHADER ? "FRAGMENT" : "COMPUTE")
                       << "::COMPILATION_FAILED\n"
                       << infoLog <<
                       std::endl;
@@ -154,4 +177,77 @@ namespace rg {
         return shaderId;
     }
 
+    unsigned int Shader::linkProgram(std::initializer_list<int> shaders) {
+        // Link Shaders:
+        int shaderProgram = glCreateProgram();
+        for (int shader: shaders) {
+            glAttachShader(shaderProgram, shader);
+        }
+        glLinkProgram(shaderProgram);
+
+        // Check for linking errors:
+        int success;
+        char infoLog[512];
+        glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+        if (!success) {
+            glGetProgramInfoLog(shaderProgram, 512, nullptr, infoLog);
+            std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog <<
+                      std::endl;
+        }
+        for (int shader: shaders) {
+            glDeleteShader(shader);
+        }
+        return shaderProgram;
+    }
+
+    std::string Shader::injectDefines(const std::string &source, const std::string &defines) {
+        if (defines.empty()) {
+            return source;
+        }
+        // #version has to stay the first statement
+        size_t version = source.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+        if (lineEnd == std::string::npos) {
+            return defines + "\n" + source;
+        }
+        return source.substr(0, lineEnd + 1) + defines + "\n#line 2 0\n" + source.substr(lineEnd + 1);
+    }
+
+    std::string Shader::loadSource(const std::string &path, std::vector<std::string> &included) {
+        int index = (int) included.size();
+        included.push_back(path);
+        std::string source = readFileContents(path);
+        ASSERT(!source.empty(), "Shader source is empty: " << path);
+        std::string directory = path.substr(0, path.find_last_of('/') + 1);
+
+        std::istringstream lines(source);
+        std::string line;
+        std::string result;
+        int number = 0;
+        while (std::getline(lines, line)) {
+            ++number;
+            size_t start = line.find_first_not_of(" \t");
+            if (start == std::string::npos || line.compare(start, 8, "#include") != 0) {
+                result += line + '\n';
+                continue;
+            }
+            size_t open = line.find('"', start);
+            size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+            ASSERT(close != std::string::npos, "Malformed #include at " << path << ':' << number);
+            std::string file = directory + line.substr(open + 1, close - open - 1);
+            if (std::find(included.begin(), included.end(), file) != included.end()) {
+                continue;
+            }
+            int fileIndex = (int) included.size();
+            result += "#line 1 " + std::to_string(fileIndex) + '\n' + loadSource(file, included) + "#line " +
+                      std::to_string(number + 1) + ' ' + std::to_string(index) + '\n';
+        }
+        return result;
+    }
+
+    std::string Shader::loadSource(const std::string &path) {
+        std::vector<std::string> included;
+        return loadSource(path, included);
+    }
+
 }
\ No newline at end of file
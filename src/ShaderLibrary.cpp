@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <chrono>
+
+#include <rg/ShaderLibrary.hpp>
+
+namespace rg {
+
+    std::string ShaderLibrary::defines(const std::vector<std::string> &features) {
+        std::string result;
+        for (const std::string &feature: features) {
+            bool hasValue = feature.find(' ') != std::string::npos;
+            result += "#define " + feature + (hasValue ? "\n" : " 1\n");
+        }
+        return result;
+    }
+
+    template<typename Compile>
+    const Shader &ShaderLibrary::variant(std::string key, std::vector<std::string> &features, const Setup &setup,
+                                         Compile &&compile) {
+        ++counters.lookups;
+        std::sort(features.begin(), features.end());
+        features.erase(std::unique(features.begin(), features.end()), features.end());
+        for (const std::string &feature: features) {
+            key += '|' + feature;
+        }
+
+        auto it = variants.find(key);
+        if (it != variants.end()) {
+            return *it->second.shader;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::unique_ptr<Shader> shader(new Shader(compile(defines(features))));
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (setup) {
+            shader->use();
+            setup(*shader);
+        }
+
+        ++counters.variants;
+        counters.compileMilliseconds += elapsed.count();
+        if (elapsed.count() > counters.slowestMilliseconds) {
+            counters.slowestMilliseconds = elapsed.count();
+            counters.slowest = key;
+        }
+        return *variants.emplace(key, Variant{std::move(shader), elapsed.count()}).first->second.shader;
+    }
+
+    const Shader &ShaderLibrary::get(const std::string &vertexShaderPath, const std::string &fragmentShaderPath,
+                                     std::vector<std::string> features, const Setup &setup) {
+        return variant(vertexShaderPath + '+' + fragmentShaderPath, features, setup, [&](const std::string &defines) {
+            return Shader(vertexShaderPath, fragmentShaderPath, defines);
+        });
+    }
+
+    const Shader &ShaderLibrary::getGeometry(const std::string &vertexShaderPath, const std::string &geometryShaderPath,
+                                             const std::string &fragmentShaderPath, std::vector<std::string> features,
+                                             const Setup &setup) {
+        return variant(vertexShaderPath + '+' + geometryShaderPath + '+' + fragmentShaderPath, features, setup,
+                       [&](const std::string &defines) {
+                           return Shader(vertexShaderPath, geometryShaderPath, fragmentShaderPath, defines);
+                       });
+    }
+
+    const Shader &ShaderLibrary::getCompute(const std::string &computeShaderPath, std::vector<std::string> features,
+                                            const Setup &setup) {
+        return variant(computeShaderPath, features, setup, [&](const std::string &defines) {
+            return Shader::compute(computeShaderPath, defines);
+        });
+    }
+
+    const ShaderLibrary::Stats &ShaderLibrary::stats() const {
+        return counters;
+    }
+
+    void ShaderLibrary::report(std::ostream &out) const {
+        out << counters.variants << " shader variants, " << counters.compileMilliseconds << " ms compiling, "
+            << counters.lookups << " lookups, slowest " << counters.slowest << " (" << counters.slowestMilliseconds
+            << " ms)\n";
+        for (const auto &entry: variants) {
+            out << "  " << entry.first << ": " << entry.second.compileMilliseconds << " ms\n";
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include <string>
+#include <utility>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/ShadowMap.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+        // GL cube map face order, +X -X +Y -Y +Z -Z, with the up vectors the faces are addressed with
+        const glm::vec3 faceDirections[6] = {{1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f},
+                                             {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}};
+        const glm::vec3 faceUps[6] = {{0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, 0.0f, 1.0f},
+                                      {0.0f, 0.0f, -1.0f}, {0.0f, -1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}};
+    }
+
+    ShadowMap::ShadowMap(ShaderLibrary &shaders) : shaders(shaders), timer(GL_TIME_ELAPSED) {
+    }
+
+    void ShadowMap::allocate() {
+        if (allocatedResolution == resolution) {
+            return;
+        }
+        if (!texture) {
+            glGenTextures(1, &texture);
+            glGenFramebuffers(1, &fbo);
+        } else {
+            renderTargets.release("shadow cube");
+        }
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        for (unsigned int face = 0; face < 6; ++face) {
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + face, 0, depthFormat.internalFormat, resolution,
+                         resolution, 0, depthFormat.format, depthFormat.type, nullptr);
+        }
+        // linear filtering with comparison is a 2x2 PCF per lookup for free
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+        glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
+
+        GLint previous = 0;
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previous);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        // layered attachment, gl_Layer picks the face
+        glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0);
+        glDrawBuffer(GL_NONE);
+        glReadBuffer(GL_NONE);
+        ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Shadow framebuffer not complete!");
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+        // six faces; written when rendered, read by every lit fragment (20 taps, mostly cached)
+        renderTargets.track("shadow cube", resolution, 6 * resolution, depthFormat, 1.0f);
+        allocatedResolution = resolution;
+        valid = false;
+    }
+
+    bool ShadowMap::begin(const glm::vec3 &lightPosition, double sceneTime) {
+        if (!enabled) {
+            return false;
+        }
+        allocate();
+        ++framesSinceRender;
+        bool moved = lightPosition != cachedLight || sceneTime != cachedTime;
+        if (valid && (!moved || framesSinceRender < updateInterval)) {
+            ++stats.reused;
+            return false;
+        }
+
+        light = lightPosition;
+        cachedLight = lightPosition;
+        cachedTime = sceneTime;
+        glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, nearPlane, farPlane);
+        for (int face = 0; face < 6; ++face) {
+            faceMatrices[face] = projection * glm::lookAt(light, light + faceDirections[face], faceUps[face]);
+        }
+
+        timer.begin();
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, resolution, resolution);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        rendering = true;
+        return true;
+    }
+
+    const Shader &ShadowMap::caster(const std::string &vertexShaderPath, std::vector<std::string> features,
+                                    const ShaderLibrary::Setup &setup) {
+        ASSERT(rendering, "Shadow casters drawn outside begin() and end().");
+        const Shader &shader = shaders.getGeometry(vertexShaderPath, "resources/shaders/shadow.gs",
+                                                   "resources/shaders/shadow.fs", std::move(features), setup);
+        shader.use();
+        shader.setMat4("view", glm::mat4(1.0f));
+        shader.setMat4("projection", glm::mat4(1.0f));
+        for (int face = 0; face < 6; ++face) {
+            shader.setMat4("faceMatrices[" + std::to_string(face) + "]", faceMatrices[face]);
+        }
+        shader.setVec3("lightPos", light);
+        shader.setFloat("farPlane", farPlane);
+        return shader;
+    }
+
+    void ShadowMap::end() {
+        ASSERT(rendering, "Shadow map is not being rendered.");
+        glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        timer.end();
+        rendering = false;
+        valid = true;
+        framesSinceRender = 0;
+        ++stats.renders;
+    }
+
+    void ShadowMap::invalidate() {
+        valid = false;
+    }
+
+    void ShadowMap::bind(const Shader &shader) const {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("shadowMap", textureUnit);
+        shader.setFloat("shadowFarPlane", farPlane);
+        // a texel of a 90 degree face spans 2 / resolution at distance 1
+        shader.setFloat("shadowFilterSize", filterRadius * 2.0f / (float) allocatedResolution);
+    }
+
+    double ShadowMap::milliseconds() const {
+        return timer.milliseconds();
+    }
+
+    size_t ShadowMap::memoryUsage() const {
+        return (size_t) 6 * allocatedResolution * allocatedResolution * depthFormat.bytesPerPixel;
+    }
+}
@@ -0,0 +1,59 @@
+#include <algorithm>
+
+#include <rg/SimulationClock.hpp>
+
+namespace rg {
+
+    SimulationClock::SimulationClock(double fixedStep, int maxStepsPerFrame)
+            : fixedStep(fixedStep), maxStepsPerFrame(maxStepsPerFrame) {
+    }
+
+    void SimulationClock::advance(double realSeconds) {
+        stepsThisFrame = 0;
+        if (paused) {
+            return;
+        }
+        accumulator += std::max(realSeconds, 0.0) * scale;
+        // drop whatever can't be simulated this frame instead of carrying it over
+        accumulator = std::min(accumulator, fixedStep * maxStepsPerFrame);
+    }
+
+    double SimulationClock::setTimeScale(double timeScale) {
+        scale = std::min(std::max(timeScale, 0.0), maxTimeScale());
+        return scale;
+    }
+
+    double SimulationClock::timeScale() const {
+        return scale;
+    }
+
+    double SimulationClock::maxTimeScale() const {
+        return (double) maxStepsPerFrame;
+    }
+
+    bool SimulationClock::tick() {
+        if (accumulator < fixedStep || stepsThisFrame >= maxStepsPerFrame) {
+            return false;
+        }
+        accumulator -= fixedStep;
+        ++steps;
+        ++stepsThisFrame;
+        return true;
+    }
+
+    double SimulationClock::step() const {
+        return fixedStep;
+    }
+
+    double SimulationClock::now() const {
+        return (double) steps * fixedStep;
+    }
+
+    double SimulationClock::alpha() const {
+        return std::min(accumulator / fixedStep, 1.0);
+    }
+
+    double SimulationClock::renderTime() const {
+        return now() - fixedStep + alpha() * fixedStep;
+    }
+}
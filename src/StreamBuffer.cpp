@@ -0,0 +1,123 @@
+#include <chrono>
+
+#include <rg/StreamBuffer.hpp>
+#include <rg/utils/glext.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    namespace {
+        unsigned int createBuffer(GLsizeiptr size, char **persistent) {
+            unsigned int buffer;
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            if (glext.persistentMapping) {
+                GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+                glext.bufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+                *persistent = (char *) glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags);
+                ASSERT(*persistent != nullptr, "Failed to persistently map stream buffer.");
+            } else {
+                glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+            }
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            return buffer;
+        }
+
+        void *mapBufferRange(unsigned int buffer, GLintptr offset, GLsizeiptr size) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            return glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT |
+                                                                        GL_MAP_INVALIDATE_RANGE_BIT |
+                                                                        GL_MAP_UNSYNCHRONIZED_BIT);
+        }
+
+        void unmapBuffer(unsigned int buffer) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        }
+
+        GLsync fenceSync() {
+            return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        GLenum clientWaitSync(GLsync fence, GLbitfield flags, GLuint64 timeout) {
+            return glClientWaitSync(fence, flags, timeout);
+        }
+
+        void deleteSync(GLsync fence) {
+            glDeleteSync(fence);
+        }
+    }
+
+    const StreamBufferGL streamBufferGL = {createBuffer, mapBufferRange, unmapBuffer, fenceSync, clientWaitSync,
+                                           deleteSync};
+
+    StreamBuffer::StreamBuffer(GLsizeiptr regionSize, int regionCount, const StreamBufferGL &gl)
+            : gl(gl), regionSize(regionSize), regionCount(regionCount) {
+        ASSERT(regionCount > 0 && regionCount <= maxRegions, "Unsupported stream buffer region count.");
+        buffer = gl.create(regionSize * regionCount, &persistent);
+    }
+
+    void StreamBuffer::beginFrame() {
+        region = (region + 1) % regionCount;
+        used = 0;
+        ++frames;
+
+        GLsync &fence = fences[region];
+        if (!fence) {
+            return;
+        }
+        GLenum status = gl.clientWaitSync(fence, 0, 0);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            ++stalls;
+            auto start = std::chrono::steady_clock::now();
+            do {
+                status = gl.clientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (status == GL_TIMEOUT_EXPIRED);
+            stallMilliseconds += std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start).count();
+        }
+        ASSERT(status != GL_WAIT_FAILED, "Waiting on stream buffer fence failed.");
+        gl.deleteSync(fence);
+        fence = nullptr;
+    }
+
+    void StreamBuffer::endFrame() {
+        ASSERT(!mapped, "Stream buffer still mapped at the end of the frame.");
+        fences[region] = gl.fenceSync();
+    }
+
+    void *StreamBuffer::map(GLsizeiptr size, GLsizeiptr alignment, GLintptr &offset) {
+        ASSERT(!mapped, "Stream buffer is already mapped.");
+        GLsizeiptr start = (used + alignment - 1) / alignment * alignment;
+        ASSERT(start + size <= regionSize, "Stream buffer region is too small for this frame.");
+        used = start + size;
+        offset = region * regionSize + start;
+
+        mapped = true;
+        if (persistent) {
+            return persistent + offset;
+        }
+        void *data = gl.mapRange(buffer, offset, size);
+        ASSERT(data != nullptr, "Failed to map stream buffer range.");
+        return data;
+    }
+
+    void StreamBuffer::unmap() {
+        if (!mapped) {
+            return;
+        }
+        mapped = false;
+        if (persistent) {
+            return;
+        }
+        gl.unmap(buffer);
+    }
+
+    unsigned int StreamBuffer::id() const {
+        return buffer;
+    }
+
+    bool StreamBuffer::isPersistent() const {
+        return persistent != nullptr;
+    }
+}
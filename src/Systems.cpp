@@ -0,0 +1,21 @@
+#include <cmath>
+
+#include <rg/Systems.hpp>
+#include <rg/Components.hpp>
+
+namespace rg {
+
+    void orbitSystem(World &world, double time) {
+        world.each<Orbit, Motion>([&](Entity e, Orbit &orbit, Motion &motion) {
+            double angle = orbit.phase + time * orbit.speed;
+            motion.previous = motion.current;
+            motion.current = glm::vec3(orbit.radius * std::sin(angle), 0.0f, orbit.radius * std::cos(angle));
+        });
+    }
+
+    void interpolationSystem(World &world, SceneGraph &scene, double alpha) {
+        world.each<Motion, Transform>([&](Entity e, Motion &motion, Transform &transform) {
+            scene.setTranslation(transform.node, glm::mix(motion.previous, motion.current, (float) alpha));
+        });
+    }
+}
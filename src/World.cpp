@@ -0,0 +1,96 @@
+#include <rg/World.hpp>
+
+namespace rg {
+
+    int World::archetypeFor(ComponentMask mask) {
+        auto it = archetypeLookup.find(mask);
+        if (it != archetypeLookup.end()) {
+            return it->second;
+        }
+
+        std::unique_ptr<Archetype> archetype(new Archetype());
+        archetype->mask = mask;
+        for (unsigned int id = 0; id < maxComponentTypes; ++id) {
+            archetype->columnOf[id] = -1;
+            if (mask & (ComponentMask(1) << id)) {
+                archetype->columnOf[id] = (int) archetype->columns.size();
+                archetype->columns.push_back({id, componentSizes[id], {}});
+            }
+        }
+        archetypes.push_back(std::move(archetype));
+        int index = (int) archetypes.size() - 1;
+        archetypeLookup[mask] = index;
+        return index;
+    }
+
+    void World::moveEntity(Entity e, int archetype) {
+        Record &record = records[e];
+        Archetype &to = *archetypes[archetype];
+        size_t row = to.entities.size();
+        to.entities.push_back(e);
+        for (Column &column: to.columns) {
+            column.data.resize(column.data.size() + column.elementSize);
+            unsigned char *dst = column.data.data() + row * column.elementSize;
+            if (record.archetype >= 0) {
+                Archetype &from = *archetypes[record.archetype];
+                int source = from.columnOf[column.component];
+                if (source >= 0) {
+                    std::memcpy(dst, from.columns[source].data.data() + record.row * column.elementSize,
+                                column.elementSize);
+                    continue;
+                }
+            }
+            std::memset(dst, 0, column.elementSize);
+        }
+
+        if (record.archetype >= 0) {
+            removeRow(record.archetype, record.row);
+        }
+        record.archetype = archetype;
+        record.row = row;
+    }
+
+    void World::removeRow(int archetype, size_t row) {
+        Archetype &a = *archetypes[archetype];
+        size_t last = a.entities.size() - 1;
+        if (row != last) {
+            Entity moved = a.entities[last];
+            a.entities[row] = moved;
+            for (Column &column: a.columns) {
+                std::memcpy(column.data.data() + row * column.elementSize,
+                            column.data.data() + last * column.elementSize, column.elementSize);
+            }
+            records[moved].row = row;
+        }
+        a.entities.pop_back();
+        for (Column &column: a.columns) {
+            column.data.resize(column.data.size() - column.elementSize);
+        }
+    }
+
+    void *World::component(Entity e, unsigned int id) {
+        const Record &record = records[e];
+        Archetype &a = *archetypes[record.archetype];
+        int column = a.columnOf[id];
+        if (column < 0) {
+            return nullptr;
+        }
+        return a.columns[column].data.data() + record.row * a.columns[column].elementSize;
+    }
+
+    void World::destroy(Entity e) {
+        ASSERT(alive(e), "Destroying an entity that is not alive.");
+        removeRow(records[e].archetype, records[e].row);
+        records[e].archetype = -1;
+        freeEntities.push_back(e);
+        --aliveCount;
+    }
+
+    bool World::alive(Entity e) const {
+        return e < records.size() && records[e].archetype >= 0;
+    }
+
+    size_t World::size() const {
+        return aliveCount;
+    }
+}
@@ -1,5 +1,12 @@
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -15,13 +22,53 @@
 #include <rg/Model.hpp>
 #include <rg/Camera.hpp>
 #include <rg/utils/utils.hpp>
+#include <rg/utils/glext.hpp>
 #include <rg/light.hpp>
 #include <rg/utils/textures.hpp>
+#include <rg/AsteroidBelt.hpp>
+#include <rg/AsteroidMeshes.hpp>
+#include <rg/JobSystem.hpp>
+#include <rg/SceneGraph.hpp>
+#include <rg/World.hpp>
+#include <rg/Components.hpp>
+#include <rg/SimulationClock.hpp>
+#include <rg/Systems.hpp>
+#include <rg/NBody.hpp>
+#include <rg/GeometryArena.hpp>
+#include <rg/StreamBuffer.hpp>
+#include <rg/MaterialLibrary.hpp>
+#include <rg/FrameStats.hpp>
+#include <rg/GpuQuery.hpp>
+#include <rg/OcclusionBuffer.hpp>
+#include <rg/ReferenceRenderer.hpp>
+#include <rg/Blur.hpp>
+#include <rg/ComputeComposite.hpp>
+#include <rg/Compositor.hpp>
+#include <rg/ShaderLibrary.hpp>
+#include <rg/AutoExposure.hpp>
+#include <rg/RenderTargets.hpp>
+#include <rg/AntiAliasing.hpp>
+#include <rg/DynamicResolution.hpp>
+#include <rg/ShadowMap.hpp>
+#include <rg/LocalLights.hpp>
+#include <rg/DeferredRenderer.hpp>
 
 void framebufferSizeCallback(GLFWwindow *window, int width, int height);
 
 void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods);
 
+void gravitySystem(rg::World &world, const rg::SceneGraph &scene, rg::NBody &bodies);
+
+float innerRadius(const rg::Model &model);
+
+void occluderSystem(rg::World &world, const rg::SceneGraph &scene, rg::OcclusionBuffer &occlusionBuffer);
+
+// Meshes and diffuse maps of a model already loaded for GL, in the form rg::ReferenceRenderer takes.
+rg::ObjData cpuGeometry(const rg::Model &model);
+
+// Same entities as renderSystem, through the CPU reference renderer.
+void referenceSystem(rg::World &world, const rg::SceneGraph &scene, rg::ReferenceRenderer &reference);
+
 void mouseCallback(GLFWwindow *window, double xpos, double ypos);
 
 void scrollCallback(GLFWwindow *window, double xoffset, double yoffset);
@@ -30,6 +77,21 @@ void drawImGui();
 
 void update(GLFWwindow *window);
 
+void lightSystem(rg::World &world, const rg::SceneGraph &scene);
+
+// which Renderables a pass draws, emissive ones (the sun) are the only unlit bodies
+enum class Bodies {
+    All, Lit, Emissive
+};
+
+void renderSystem(rg::World &world, const rg::SceneGraph &scene, const glm::vec3 &viewPos, bool depthOnly,
+                  Bodies bodies = Bodies::All);
+
+void shadowSystem(rg::World &world, const rg::SceneGraph &scene, const rg::Shader &casterShader);
+
+// lit.fs feature keys for the current toggles, gbuffer.fs ones on the deferred path
+std::vector<std::string> litFeatures(bool specularMap);
+
 glm::vec3 spotLightAmbient = glm::vec3(0.0f);
 glm::vec3 spotLightDiffuse = glm::vec3(5.f, 3.f, 6.f);
 glm::vec3 spotLightSpecular = glm::vec3(6.0f, 3.f, 7.f);
@@ -60,23 +122,53 @@ rg::PointLight pointLight{
 bool hdr = true;
 bool bloom = true;
 bool spotLightEnabled = true;
+bool gpuAsteroids = true;
+bool nbodyAsteroids = false;
+bool multiDraw = true;
+bool depthPrepass = true;
+bool occlusionCulling = true;
+bool printStats = false;
+bool captureReference = false;
+bool benchmarkBlur = false;
+bool computePost = true;
+bool autoExposure = true;
+bool dynamicResolution = true;
+bool upscaleSharpen = true;
+bool injectLoadSpike = false;
+bool shadows = true;
+int shadowResolution = 1024;
+int shadowUpdateInterval = 1;
+bool deferredShading = false;
+int localLightCount = 0;
 float exposure = 1.0f;
+rg::AntiAliasing::Mode antiAliasingMode = rg::AntiAliasing::Mode::None;
+float bloomRadius = 12.0f; // texels
 int numberOfAsteroids = 50;
+int asteroidVariants = 64;
 int effect = 0;
 
 constexpr float PI = glm::radians(360.f);
 
 glm::vec3 sunPosition{0.0f};
-glm::vec3 mercuryPosition{};
-glm::vec3 earthPosition{};
 
 float mercurySpeed = 0.05f;
 float earthSpeed = 0.1f;
+// gives the belt at radius 30 the same 0.1 rad/s it has on rails
+float sunMass = 270.0f;
+float asteroidMass = 1e-4f;
 float cameraDefaultSpeed = 3.f;
 
 rg::Camera camera{glm::vec3(0.0f, 0.0f, 10.0f)};
+rg::SimulationClock simulationClock;
+
+int main(int argc, char **argv) {
+    // Belt size from the command line, e.g. --asteroids 20000 for the N-body tree path.
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (std::string(argv[i]) == "--asteroids") {
+            numberOfAsteroids = std::max(1, std::atoi(argv[i + 1]));
+        }
+    }
 
-int main() {
     // GLFW Init
     rg::glfwInit(3, 3, GLFW_OPENGL_CORE_PROFILE);
 
@@ -103,6 +195,8 @@ int main() {
 
     // OpenGL Config
     glEnable(GL_DEPTH_TEST);
+    // PCF taps near a face edge of the shadow cube filter across it
+    glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 //    glEnable(GL_BLEND);
 //    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
@@ -151,82 +245,20 @@ int main() {
             1.0f, -1.0f, 1.0f
     };
 
-    float asteroidVertices[] = {
-            0.5, 0.0, -0.5, 0.0, 0.0, 0.5, 0.5, 0.0,
-            0.5, 0.0, 0.5, 0.0, 1.0, 0.5, 0.5, 0.0,
-            0.0, 0.5, 0.0, 0.5, 0.5, 0.5, 0.5, 0.0,
-
-            0.5, 0, 0.5, 0, 0, 0, 0.5, 0.5,
-            -0.5, 0, 0.5, 0, 1, 0, 0.5, 0.5,
-            0, 0.5, 0, 0.5, 0.5, 0, 0.5, 0.5,
-
-            -0.5, 0, 0.5, 0, 0, -0.5, 0.5, 0,
-            -0.5, 0, -0.5, 0, 1, -0.5, 0.5, 0,
-            0, 0.5, 0, 0.5, 0.5, -0.5, 0.5, 0,
-
-            0.5, 0, -0.5, 0, 1, 0, 0.5, -0.5,
-            -0.5, 0, -0.5, 0, 0, 0, 0.5, -0.5,
-            0, 0.5, 0, 0.5, 0.5, 0, 0.5, -0.5,
-
-            0.5, 0, -0.5, 0, 0, 0.5, -0.5, 0,
-            0.5, 0, 0.5, 0, 1, 0.5, -0.5, 0,
-            0, -0.5, 0, 0.5, 0.5, 0.5, -0.5, 0,
+    rg::JobSystem jobs;
 
-            0.5, 0, 0.5, 0, 0, 0, -0.5, 0.5,
-            -0.5, 0, 0.5, 0, 1, 0, -0.5, 0.5,
-            0, -0.5, 0, 0.5, 0.5, 0, -0.5, 0.5,
+    rg::AsteroidBelt asteroidBelt(numberOfAsteroids, 30.0f, 2.0f);
+    // everything uploaded per frame: asteroid matrices and indirect draw commands
+    rg::StreamBuffer frameData(rg::AsteroidBelt::frameBytes(numberOfAsteroids) + (64 << 10));
 
-            -0.5, 0, 0.5, 0, 0, -0.5, -0.5, 0,
-            -0.5, 0, -0.5, 0, 1, -0.5, -0.5, 0,
-            0, -0.5, 0, 0.5, 0.5, -0.5, -0.5, 0,
-
-            0.5, 0, -0.5, 0, 1, 0, -0.5, -0.5,
-            -0.5, 0, -0.5, 0, 0, 0, -0.5, -0.5,
-            0, -0.5, 0, 0.5, 0.5, 0, -0.5, -0.5,
-    };
-
-    unsigned int asteroidIndices[] = {
-            0, 1, 2,
-            3, 4, 5,
-            6, 7, 8,
-            9, 10, 11,
-            12, 13, 14,
-            15, 16, 17,
-            18, 19, 20,
-            21, 22, 23
-    };
-
-    std::vector<glm::vec3> asteroidRotations(numberOfAsteroids);
-    for (auto &v: asteroidRotations) {
-        v = rg::randomVec3(-1.0f, 1.0f);
-    }
-
-    std::vector<std::pair<float, float>> asteroidValues(numberOfAsteroids);
-    for (auto &v: asteroidValues) {
-        float rRadius = rg::random(-2.f, 2.f) + 30.0f;
-        float ry = rg::random(-2.f, 2.f);
-        v.first = rRadius;
-        v.second = ry;
-    }
-
-    unsigned int asteroidVAO, asteroidVBO, asteroidEBO;
-    glGenVertexArrays(1, &asteroidVAO);
-    glGenBuffers(1, &asteroidVBO);
-    glGenBuffers(1, &asteroidEBO);
-    glBindVertexArray(asteroidVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, asteroidVBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(asteroidVertices), asteroidVertices, GL_STATIC_DRAW);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, asteroidEBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(asteroidIndices), asteroidIndices, GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) 0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void *) (5 * sizeof(float)));
-    glEnableVertexAttribArray(2);
-//    glBindVertexArray(0);
+    auto generationStart = std::chrono::steady_clock::now();
+    rg::AsteroidMeshes asteroidMeshes(asteroidVariants, 2, 1234u, jobs);
+    std::chrono::duration<double, std::milli> generationTime = std::chrono::steady_clock::now() - generationStart;
+    LOG(std::cout) << asteroidMeshes.variants() << " asteroid variants generated in " << generationTime.count()
+                   << " ms, " << asteroidMeshes.memoryUsage() / 1024 << " KiB\n";
+    asteroidMeshes.setupMesh();
+    asteroidBelt.setupInstancing(asteroidMeshes.vao(), asteroidMeshes.variants());
+    asteroidBelt.boundingRadius = asteroidMeshes.boundingRadius();
 
     float quadVertices[] = {
             // positions        // texture Coords
@@ -258,22 +290,17 @@ int main() {
     unsigned int hdrFBO;
     glGenFramebuffers(1, &hdrFBO);
     glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
+    // nothing reads alpha back, the packed format halves the scene and bright pass targets (F2 shows the error)
     unsigned int colorBuffers[2];
-    glGenTextures(2, colorBuffers);
+    // scene: written, composited and metered; bright pass: written and blurred
+    colorBuffers[0] = rg::renderTargets.createTexture("scene", 1280, 720, rg::packedHdrFormat, 3.0f);
+    colorBuffers[1] = rg::renderTargets.createTexture("bright pass", 1280, 720, rg::packedHdrFormat, 2.0f);
     for (unsigned int i = 0; i < 2; ++i) {
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 720, 0, GL_RGBA, GL_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colorBuffers[i], 0);
     }
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, 1280, 720);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    // a texture rather than a renderbuffer, TAA reprojects with it
+    unsigned int depthTexture = rg::renderTargets.createTexture("depth", 1280, 720, rg::depthFormat, 3.0f);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
 
     unsigned int attachments[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
     glDrawBuffers(2, attachments);
@@ -281,34 +308,24 @@ int main() {
     ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Framebuffer not completed.");
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    unsigned int pingpongFBO[2];
-    unsigned int pingpongColorBuffers[2];
-    glGenFramebuffers(2, pingpongFBO);
-    glGenTextures(2, pingpongColorBuffers);
-    for (unsigned int i = 0; i < 2; ++i) {
-        glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[i]);
-        glBindTexture(GL_TEXTURE_2D, pingpongColorBuffers[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 720, 0, GL_RGBA, GL_FLOAT, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, pingpongColorBuffers[i], 0);
+    rg::ShaderLibrary shaders;
+    rg::Blur bloomBlur(1280, 720, quadVAO, shaders);
+    // compute post-processing when the driver gives us 4.3, the fragment passes stay as the fallback
+    std::unique_ptr<rg::ComputeComposite> computeComposite;
+    if (rg::glext.computeShaders) {
+        computeComposite.reset(new rg::ComputeComposite(1280, 720, shaders));
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-    unsigned int screenFBO;
-    unsigned int screenColorBuffer;
-    glGenFramebuffers(1, &screenFBO);
-    glGenTextures(1, &screenColorBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, screenFBO);
-    glBindTexture(GL_TEXTURE_2D, screenColorBuffer);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, 1280, 720, 0, GL_RGBA, GL_FLOAT, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, screenColorBuffer, 0);
+    rg::Compositor compositor(1280, 720, quadVAO, shaders);
+    rg::AutoExposure exposureMeter(1280, 720, quadVAO, shaders);
+    rg::AntiAliasing antiAliasing(1280, 720, hdrFBO, colorBuffers[0], depthTexture, quadVAO, shaders);
+    // scene and post targets stay 1280x720, frames render into a part of them sized to the GPU time budget
+    rg::DynamicResolution resolutionController(1280, 720);
+    rg::ShadowMap shadowMap(shaders);
+    rg::DeferredRenderer deferredRenderer(1280, 720, depthTexture, colorBuffers[0], colorBuffers[1], quadVAO, shaders);
+    // benchmark lights between the belt and the earth's orbit, localLightCount of them are used
+    rg::LocalLights localLights(1024, 24.0f, 86.0f);
+    rg::renderTargets.report(LOG(std::cout) << "Render targets:\n");
 
     std::vector<std::string> faces{
             "resources/textures/cubemaps/space/right.jpg",
@@ -319,38 +336,100 @@ int main() {
             "resources/textures/cubemaps/space/back.jpg"
     };
     unsigned int cubemapTexture = rg::loadCubemap(faces, false, true);
-    unsigned int blackWood = rg::loadTexture("resources/textures/black_wood.jpg", true, true);
-    unsigned int blackWoodSpecular = rg::loadTexture("resources/textures/black_wood_specular.jpg", true, true);
 
     // Shaders and models and lights.
     rg::Shader skyboxShader("resources/shaders/skybox.vs", "resources/shaders/skybox.fs");
-    rg::Shader planetShader("resources/shaders/planet.vs", "resources/shaders/planet.fs");
     rg::Shader sunShader("resources/shaders/sun.vs", "resources/shaders/sun.fs");
-    rg::Shader hdrShader("resources/shaders/hdr.vs", "resources/shaders/hdr.fs");
-    rg::Shader blurShader("resources/shaders/blur.vs", "resources/shaders/blur.fs");
-    rg::Shader asteroidShader("resources/shaders/asteroid.vs", "resources/shaders/asteroid.fs");
-    rg::Shader screenShader("resources/shaders/screen.vs", "resources/shaders/screen.fs");
+    // depth pre-pass, same vertex shaders so positions match exactly, empty fragment shader
+    rg::Shader planetDepthShader("resources/shaders/planet.vs", "resources/shaders/depth.fs");
+    rg::Shader sunDepthShader("resources/shaders/sun.vs", "resources/shaders/depth.fs");
+    rg::Shader asteroidDepthShader("resources/shaders/asteroid.vs", "resources/shaders/depth.fs");
+    rg::Shader asteroidBeltDepthShader("resources/shaders/asteroid_belt.vs", "resources/shaders/depth.fs");
 
     rg::Model earth("resources/objects/earth/scene.gltf", true);
     rg::Model sun("resources/objects/sun/Sun.obj");
     rg::Model mercury("resources/objects/mercury_planet/scene.gltf", true);
 
+    // all static model geometry in shared buffers, drawn with multi draw indirect when available
+    rg::GeometryArena geometryArena(frameData);
+    earth.addToArena(geometryArena);
+    sun.addToArena(geometryArena);
+    mercury.addToArena(geometryArena);
+    LOG(std::cout) << "Geometry arena: " << geometryArena.memoryUsage() / 1024 << " KiB\n";
+
+    // Textures packed into arrays by size, materials are switched with a uniform. Model textures are
+    // flipped to match how they used to load (stb flipping was left on by the asteroid loadTexture calls).
+    rg::MaterialLibrary materials;
+    int asteroidMaterial = materials.addMaterial("resources/textures/black_wood.jpg",
+                                                 "resources/textures/black_wood_specular.jpg", true, true);
+    earth.addToMaterials(materials, true);
+    mercury.addToMaterials(materials, true);
+    materials.build();
+    LOG(std::cout) << materials.size() << " materials, " << materials.memoryUsage() / 1024 << " KiB of textures\n";
+
+    // Planets and asteroids are lit.fs variants. The handles below are what Renderable and the draw code
+    // use, every frame they are pointed at the variant for the current features (compiled on first use).
+    rg::ShaderLibrary::Setup setupAsteroidVertices = [&](const rg::Shader &shader) {
+        shader.setInt("asteroidVertices", 2);
+        shader.setInt("asteroidVertexCount", asteroidMeshes.vertexCount());
+    };
+    rg::ShaderLibrary::Setup setupLit = [&](const rg::Shader &shader) {
+        materials.setupShader(shader);
+        setupAsteroidVertices(shader);
+    };
+    rg::Shader planetShader = shaders.get("resources/shaders/planet.vs", "resources/shaders/lit.fs",
+                                          litFeatures(false), setupLit);
+    rg::Shader asteroidShader = shaders.get("resources/shaders/asteroid.vs", "resources/shaders/lit.fs",
+                                            litFeatures(true), setupLit);
+    rg::Shader asteroidBeltShader = shaders.get("resources/shaders/asteroid_belt.vs", "resources/shaders/lit.fs",
+                                                litFeatures(true), setupLit);
+
+    // sun <- mercury <- earth, orbits are set as local translations every frame
+    rg::SceneGraph scene;
+    rg::World world;
+    int sunNode = scene.addNode();
+    int mercuryNode = scene.addNode(sunNode);
+    int earthNode = scene.addNode(mercuryNode);
+    scene.setTranslation(sunNode, sunPosition);
+    scene.setScale(earthNode, glm::vec3(1.5f));
+
+    rg::Entity sunEntity = world.create(rg::Transform{sunNode}, rg::Renderable{&sun, &sunShader, &sunDepthShader},
+                                        rg::Light{pointLight}, rg::Gravity{sunMass}, rg::Occluder{innerRadius(sun)},
+                                        rg::Emissive{glm::vec3(100.0f)});
+    world.create(rg::Transform{mercuryNode}, rg::Orbit{60.0f, mercurySpeed, 0.0f}, rg::Motion{},
+                 rg::Renderable{&mercury, &planetShader, &planetDepthShader}, rg::Gravity{2.0f},
+                 rg::Occluder{innerRadius(mercury)});
+    world.create(rg::Transform{earthNode}, rg::Orbit{20.0f, earthSpeed, 0.0f}, rg::Motion{},
+                 rg::Renderable{&earth, &planetShader, &planetDepthShader}, rg::Gravity{5.0f},
+                 rg::Occluder{innerRadius(earth)});
+    // fill both interpolation states with the starting positions
+    rg::orbitSystem(world, simulationClock.now());
+    rg::orbitSystem(world, simulationClock.now());
+
+    rg::NBody asteroidBodies;
+    // the sun and planets rasterized on the CPU, asteroids behind them are never streamed or drawn
+    rg::OcclusionBuffer occlusionBuffer(256, 144);
+    double initialEnergy = 0.0;
+    double lastEnergyReport = 0.0;
+
     skyboxShader.use();
     skyboxShader.setInt("skybox", 0);
 
-    blurShader.use();
-    blurShader.setInt("image", 0);
+    asteroidDepthShader.use();
+    asteroidDepthShader.setInt("asteroidVertices", 2);
+    asteroidDepthShader.setInt("asteroidVertexCount", asteroidMeshes.vertexCount());
 
-    hdrShader.use();
-    hdrShader.setInt("scene", 0);
-    hdrShader.setInt("bloomBlur", 1);
+    asteroidBeltDepthShader.use();
+    asteroidBeltDepthShader.setInt("asteroidVertices", 2);
+    asteroidBeltDepthShader.setInt("asteroidVertexCount", asteroidMeshes.vertexCount());
 
-    asteroidShader.use();
-    asteroidShader.setInt("diffuseMap", 0);
-    asteroidShader.setInt("specularMap", 1);
+    // Scene pass GPU time and how many fragments the colour pass shades. Without pipeline statistics
+    // samples passing the depth test are the closest stand-in, they miss fragments killed by late Z.
+    rg::GpuQuery sceneTimer(GL_TIME_ELAPSED);
+    rg::GpuQuery fragmentQuery(rg::glext.pipelineStatistics ? GL_FRAGMENT_SHADER_INVOCATIONS : GL_SAMPLES_PASSED);
+    rg::GpuQuery blurTimer(GL_TIME_ELAPSED);
+    rg::GpuQuery compositeTimer(GL_TIME_ELAPSED);
 
-    screenShader.use();
-    screenShader.setInt("screenTexture", 0);
     // Loop
     while (!glfwWindowShouldClose(window)) {
 
@@ -364,88 +443,341 @@ int main() {
 
         // Update Scene
         update(window);
+        if (printStats) {
+            LOG(std::cout) << (multiDraw ? "[arena] " : "[per mesh] ") << rg::frameStats << '\n';
+            LOG(std::cout) << "frame data " << (frameData.isPersistent() ? "persistent" : "unsynchronized")
+                           << ", stalls: " << frameData.stalls << " / " << frameData.frames << " frames, "
+                           << frameData.stallMilliseconds << " ms\n";
+            LOG(std::cout) << "scene pass " << (depthPrepass ? "with" : "without") << " depth pre-pass: "
+                           << sceneTimer.milliseconds() << " ms GPU, " << fragmentQuery.result()
+                           << (rg::glext.pipelineStatistics ? " fragment shader invocations" : " samples passed")
+                           << ", frame: " << rg::getDeltaTime() * 1000.0f << " ms\n";
+            if (deferredShading) {
+                LOG(std::cout) << "deferred shading, " << localLights.count << " local lights: G-buffer "
+                               << sceneTimer.milliseconds() << " ms + lighting "
+                               << deferredRenderer.lightingMilliseconds() << " ms = "
+                               << sceneTimer.milliseconds() + deferredRenderer.lightingMilliseconds()
+                               << " ms GPU, G-buffer " << deferredRenderer.memoryUsage() / 1024 << " KiB\n";
+            } else {
+                LOG(std::cout) << "forward shading, " << localLights.count << " local lights: "
+                               << sceneTimer.milliseconds() << " ms GPU\n";
+            }
+            // effective bandwidth, every pass reads and writes each texel once
+            bool compute = computePost && computeComposite;
+            double blurBytes = (double) resolutionController.width() * resolutionController.height() * 2 *
+                               rg::packedHdrFormat.bytesPerPixel * 2 *
+                               bloomBlur.iterationsFor(bloomRadius * resolutionController.scale()).first;
+            double compositeBytes = compute ? (double) computeComposite->bytesPerFrame()
+                                            : (double) compositor.bytesPerFrame(effect);
+            LOG(std::cout) << (compute ? "compute" : "fragment") << " post-processing, blur: "
+                           << blurTimer.milliseconds() << " ms, " << blurBytes / (blurTimer.milliseconds() * 1.0e6)
+                           << " GB/s, composite (" << (compute ? 1 : compositor.passes(effect)) << " pass): "
+                           << compositeTimer.milliseconds() << " ms, "
+                           << compositeBytes / (compositeTimer.milliseconds() * 1.0e6) << " GB/s\n";
+            const rg::AutoExposure::Stats &metering = exposureMeter.stats;
+            LOG(std::cout) << "exposure " << exposure << (autoExposure ? " (auto)" : " (manual)") << ", luminance "
+                           << exposureMeter.luminance() << ", metering " << exposureMeter.meteringMilliseconds()
+                           << " ms GPU, readbacks " << metering.readbacks << " (latency " << metering.latencyFrames
+                           << " frames, not ready " << metering.notReady << ", skipped " << metering.skipped
+                           << ", slowest CPU side " << metering.maxReadbackMilliseconds << " ms)\n";
+            LOG(std::cout) << "render scale " << resolutionController.scale() << " ("
+                           << resolutionController.width() << 'x' << resolutionController.height() << ", "
+                           << (dynamicResolution ? "dynamic" : "fixed") << "), GPU frame "
+                           << resolutionController.milliseconds() << " ms of " << resolutionController.targetMilliseconds
+                           << " ms budget\n";
+            LOG(std::cout) << "anti-aliasing " << rg::AntiAliasing::name(antiAliasing.mode) << ": resolve "
+                           << antiAliasing.resolveMilliseconds() << " ms GPU, "
+                           << antiAliasing.memoryUsage() / 1024 << " KiB of extra targets\n";
+            LOG(std::cout) << "sun shadows " << (shadows ? "on" : "off") << ", 6x" << shadowMap.resolution
+                           << "^2 cube, " << shadowMap.memoryUsage() / 1024 << " KiB, render every "
+                           << shadowMap.updateInterval << " frame(s) while moving: " << shadowMap.milliseconds()
+                           << " ms GPU per render, " << shadowMap.stats.renders << " renders, "
+                           << shadowMap.stats.reused << " frames reused the cached map\n";
+            LOG(std::cout) << asteroidMeshes.variants() << " asteroid variants of " << asteroidMeshes.vertexCount()
+                           << " vertices, " << asteroidMeshes.memoryUsage() / 1024 << " KiB, generated in "
+                           << generationTime.count() << " ms\n";
+            LOG(std::cout) << "simulation " << (simulationClock.paused ? "paused" : "running") << " at "
+                           << simulationClock.timeScale() << "x (at most " << simulationClock.maxTimeScale()
+                           << "x), t = " << simulationClock.now() << " s\n";
+            shaders.report(LOG(std::cout));
+            printStats = false;
+        }
+        rg::frameStats.reset();
+        geometryArena.enabled = multiDraw;
+        frameData.beginFrame();
+
+        resolutionController.enabled = dynamicResolution;
+        if (injectLoadSpike) {
+            // 20 ms more GPU time at full resolution for two seconds at 60 fps, trace the response for five
+            resolutionController.injectSpike(20.0, 120, 300);
+            injectLoadSpike = false;
+        }
+        resolutionController.beginFrame();
+        if (resolutionController.traceReady()) {
+            resolutionController.writeTrace(LOG(std::cout) << "Dynamic resolution under a synthetic load spike:\n");
+            resolutionController.trace.clear();
+        }
+        int renderWidth = resolutionController.width();
+        int renderHeight = resolutionController.height();
+        antiAliasing.setRenderSize(renderWidth, renderHeight);
+        bloomBlur.setRenderSize(renderWidth, renderHeight);
+        exposureMeter.setRenderSize(renderWidth, renderHeight);
+        compositor.setRenderSize(renderWidth, renderHeight);
+        compositor.sharpen = upscaleSharpen;
+        if (computeComposite) {
+            computeComposite->setRenderSize(renderWidth, renderHeight);
+        }
+        deferredRenderer.setRenderSize(renderWidth, renderHeight);
 
         // OpenGL Clear
 //        glClearColor(programState->clearColor.r, programState->clearColor.g, programState->clearColor.b, 1.0);
 //        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        glBindFramebuffer(GL_FRAMEBUFFER, hdrFBO);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         // Render
-        glm::mat4 projection = camera.getPerspectiveMatrix((float) windowWidth / (float) windowHeight);
+        // MSAA would need the G-buffer lit per sample, the deferred path goes without it
+        bool msaaUnavailable = deferredShading && antiAliasingMode == rg::AntiAliasing::Mode::MSAA;
+        antiAliasing.mode = msaaUnavailable ? rg::AntiAliasing::Mode::None : antiAliasingMode;
+        glm::mat4 projection = antiAliasing.beginFrame(camera, (float) windowWidth / (float) windowHeight);
         glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 model = glm::mat4(1.0f);
+        glBindFramebuffer(GL_FRAMEBUFFER, antiAliasing.framebuffer());
+        glViewport(0, 0, renderWidth, renderHeight);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         spotLight.position = camera.position;
         spotLight.direction = camera.front;
 
+        // Scene updates run on the job system, the GL thread only consumes the results. Simulation moves
+        // in fixed steps, rendering interpolates between the last two.
+        simulationClock.advance(rg::getDeltaTimeSeconds());
+        if (nbodyAsteroids && asteroidBodies.size() == 0) {
+            asteroidBelt.seedBodies(asteroidBodies, simulationClock.now(), sunMass, asteroidMass);
+            gravitySystem(world, scene, asteroidBodies);
+            initialEnergy = asteroidBodies.energy(jobs);
+            lastEnergyReport = simulationClock.now();
+        } else if (!nbodyAsteroids && asteroidBodies.size() != 0) {
+            asteroidBodies.clear();
+        }
+        // The steps are taken off the clock here, the job only gets their times, so nothing read below
+        // races with it and everything rendered this frame agrees on the time.
+        int steps = 0;
+        while (simulationClock.tick()) {
+            ++steps;
+        }
+        double stepSeconds = simulationClock.step();
+        double lastStep = simulationClock.now();
+        double alpha = simulationClock.alpha();
+        double time = simulationClock.renderTime();
+        rg::JobCounter sceneUpdate{0};
+        jobs.submit([&world, &scene, &jobs, &asteroidBodies, steps, stepSeconds, lastStep, alpha]() {
+            // planets move little in a step, the belt feels them where they were rendered last frame
+            gravitySystem(world, scene, asteroidBodies);
+            for (int i = steps - 1; i >= 0; --i) {
+                rg::orbitSystem(world, lastStep - i * stepSeconds);
+                if (asteroidBodies.size() != 0) {
+                    asteroidBodies.step((float) stepSeconds, jobs);
+                }
+            }
+            rg::interpolationSystem(world, scene, alpha);
+            scene.update();
+            lightSystem(world, scene);
+        }, sceneUpdate);
+        if (!gpuAsteroids && !nbodyAsteroids && !occlusionCulling) {
+            // Matrices built on the CPU with SIMD and streamed into the instance buffer.
+            asteroidBelt.updateMatrices(time, jobs, frameData);
+        }
+        jobs.wait(sceneUpdate);
+
+        // Culling needs this frame's occluders, so a culled belt is only built once the scene is done.
+        const rg::OcclusionBuffer *culler = nullptr;
+        if (occlusionCulling) {
+            occlusionBuffer.clear(view, projection);
+            occluderSystem(world, scene, occlusionBuffer);
+            occlusionBuffer.buildPyramid();
+            culler = &occlusionBuffer;
+        }
+        if (nbodyAsteroids) {
+            asteroidBelt.updateMatrices(asteroidBodies, time, jobs, frameData, culler);
+        } else if (culler && gpuAsteroids) {
+            // asteroid_belt.vs animates the survivors itself, culling only needs their orbit centers
+            asteroidBelt.updateVisible(time, jobs, frameData, *culler);
+        } else if (culler) {
+            asteroidBelt.updateMatrices(time, jobs, frameData, culler);
+        } else if (gpuAsteroids) {
+            asteroidBelt.useStaticInstances();
+        }
+        rg::frameStats.culledInstances = asteroidBelt.size() - asteroidBelt.visibleCount();
+        if (nbodyAsteroids && simulationClock.now() - lastEnergyReport >= 10.0) {
+            // Not conserved here, the moving planets do work on the belt. nbody_benchmark measures the
+            // integrator's own drift with fixed attractors.
+            double energy = asteroidBodies.energy(jobs);
+            LOG(std::cout) << "N-body energy change (planets included): "
+                           << (energy - initialEnergy) / std::abs(initialEnergy) * 100.0 << "%\n";
+            lastEnergyReport = simulationClock.now();
+        }
+
+        const rg::PointLight &sunLight = world.get<rg::Light>(sunEntity)->point;
+        localLights.count = localLightCount;
+        localLights.update(time);
+
+        if (captureReference) {
+            // Sun and planets as the CPU reference sees them this frame, without skybox, asteroids, shadows and bloom.
+            rg::ReferenceRenderer reference(windowWidth, windowHeight);
+            reference.begin(camera, sunLight, spotLight);
+            referenceSystem(world, scene, reference);
+            reference.render(jobs);
+            const rg::ReferenceRenderer::Stats &stats = reference.stats();
+            bool written = reference.writePPM("reference.ppm", exposure);
+            LOG(std::cout) << "Reference frame " << reference.width() << 'x' << reference.height() << ": "
+                           << stats.triangles << " triangles, " << stats.fragments << " fragments, setup "
+                           << stats.setupMilliseconds << " ms, raster " << stats.rasterMilliseconds << " ms on "
+                           << jobs.threadCount() << " threads"
+                           << (written ? ", written to reference.ppm\n" : ", writing reference.ppm failed\n");
+            captureReference = false;
+        }
+
         // Setup Shaders
+        const char *litShader = deferredShading ? "resources/shaders/gbuffer.fs" : "resources/shaders/lit.fs";
+        planetShader = shaders.get("resources/shaders/planet.vs", litShader, litFeatures(false), setupLit);
+        asteroidShader = shaders.get("resources/shaders/asteroid.vs", litShader, litFeatures(true), setupLit);
+        asteroidBeltShader = shaders.get("resources/shaders/asteroid_belt.vs", litShader, litFeatures(true),
+                                         setupLit);
         planetShader.use();
-        planetShader.setLight("pointLight", pointLight);
+        planetShader.setLight("pointLight", sunLight);
         planetShader.setLight("spotLight", spotLight);
         planetShader.setVec3("viewPos", camera.position);
         planetShader.setMat4("projection", projection);
         planetShader.setMat4("view", view);
+        if (shadows) {
+            shadowMap.bind(planetShader);
+        }
+        if (localLightCount > 0) {
+            localLights.bind(planetShader);
+        }
 
         asteroidShader.use();
-        asteroidShader.setLight("pointLight", pointLight);
+        asteroidShader.setLight("pointLight", sunLight);
         asteroidShader.setLight("spotLight", spotLight);
         asteroidShader.setVec3("viewPos", camera.position);
         asteroidShader.setMat4("projection", projection);
         asteroidShader.setMat4("view", view);
+        if (shadows) {
+            shadowMap.bind(asteroidShader);
+        }
+        if (localLightCount > 0) {
+            localLights.bind(asteroidShader);
+        }
+
+        asteroidBeltShader.use();
+        asteroidBeltShader.setLight("pointLight", sunLight);
+        asteroidBeltShader.setLight("spotLight", spotLight);
+        asteroidBeltShader.setVec3("viewPos", camera.position);
+        asteroidBeltShader.setMat4("projection", projection);
+        asteroidBeltShader.setMat4("view", view);
+        if (shadows) {
+            shadowMap.bind(asteroidBeltShader);
+        }
+        if (localLightCount > 0) {
+            localLights.bind(asteroidBeltShader);
+        }
 
         sunShader.use();
         sunShader.setMat4("projection", projection);
         sunShader.setMat4("view", view);
 
-        mercuryPosition = sunPosition + glm::vec3(60.0f * sin(glfwGetTime() * mercurySpeed), 0.0f,
-                                                  60.0f * cos(glfwGetTime() * mercurySpeed));
-
-//        jupiterPosition = sunPosition + glm::vec3(0.0f, 0.0f, glfwGetTime());
+        for (rg::Shader *depthShader: {&planetDepthShader, &sunDepthShader, &asteroidDepthShader,
+                                       &asteroidBeltDepthShader}) {
+            depthShader->use();
+            depthShader->setMat4("projection", projection);
+            depthShader->setMat4("view", view);
+        }
 
-        earthPosition = mercuryPosition + glm::vec3(20.0f * sin(glfwGetTime() * earthSpeed), 0.0f,
-                                                    20.0f * cos(glfwGetTime() * earthSpeed));
-        planetShader.use();
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, mercuryPosition);
-        planetShader.setMat4("model", model);
-        mercury.draw(planetShader);
+        // Whole belt animated in asteroid_belt.vs, one draw call. Otherwise the matrices were streamed.
+        bool beltOnGpu = gpuAsteroids && !nbodyAsteroids;
+        rg::Shader &beltShader = beltOnGpu ? asteroidBeltShader : asteroidShader;
+        rg::Shader &beltDepthShader = beltOnGpu ? asteroidBeltDepthShader : asteroidDepthShader;
+        if (beltOnGpu) {
+            glm::vec2 beltAngles = asteroidBelt.angles(time);
+            for (rg::Shader *shader: {&asteroidBeltShader, &asteroidBeltDepthShader}) {
+                shader->use();
+                shader->setFloat("orbitAngle", beltAngles.x);
+                shader->setFloat("spinAngle", beltAngles.y);
+            }
+        }
 
-        planetShader.use();
-        model = glm::mat4(1.0f);
-        model = glm::translate(model, earthPosition);
-        model = glm::scale(model, glm::vec3(1.5f));
-        planetShader.setMat4("model", model);
-        earth.draw(planetShader);
+        // Sun shadow cube, kept from an earlier frame while nothing has moved.
+        shadowMap.enabled = shadows;
+        shadowMap.resolution = shadowResolution;
+        shadowMap.updateInterval = shadowUpdateInterval;
+        if (shadowMap.begin(sunLight.position, time)) {
+            shadowSystem(world, scene, shadowMap.caster("resources/shaders/planet.vs"));
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_BUFFER, asteroidMeshes.vertexTexture());
+            if (nbodyAsteroids) {
+                // particles only reach the GPU as this frame's matrices, the camera culled set would lose
+                // the shadows of asteroids behind it and keep that in the cached map
+                shadowMap.caster("resources/shaders/asteroid.vs", {}, setupAsteroidVertices);
+                asteroidBelt.drawAllMatrices(frameData, asteroidMeshes.indexCount());
+            } else {
+                // the belt on rails is where asteroid_belt.vs puts it whichever way it is drawn
+                const rg::Shader &beltCaster = shadowMap.caster("resources/shaders/asteroid_belt.vs", {},
+                                                                setupAsteroidVertices);
+                glm::vec2 beltAngles = asteroidBelt.angles(time);
+                beltCaster.setFloat("orbitAngle", beltAngles.x);
+                beltCaster.setFloat("spinAngle", beltAngles.y);
+                asteroidBelt.drawAllInstanced(asteroidMeshes.indexCount());
+            }
+            glActiveTexture(GL_TEXTURE0);
+            shadowMap.end();
+        }
 
-        asteroidShader.use();
-        float interval = PI / numberOfAsteroids;
-        for (int i = 0; i < numberOfAsteroids; ++i) {
-            float rRadius, ry;
-            std::tie(rRadius, ry) = asteroidValues[i];
-            model = glm::mat4(1.0f);
-            model = glm::translate(model,
-                                   glm::vec3(rRadius * std::sin(i * interval + glfwGetTime() * 0.1f), ry,
-                                             rRadius * std::cos(interval * i + glfwGetTime() * 0.1f)));
-            model = glm::rotate(model, (float) glm::radians(glfwGetTime() * 20.f), asteroidRotations[i]);
-//        model = glm::scale(model, glm::vec3(5.0f));
-            asteroidShader.setMat4("model", model);
-            glBindVertexArray(asteroidVAO);
+        sceneTimer.begin();
+        // the G-buffer pass shades nothing, a pre-pass would only add to it
+        bool prepass = depthPrepass && !deferredShading;
+        if (prepass) {
+            // Lay down the final depth first, the colour pass then shades every pixel only once.
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+            renderSystem(world, scene, camera.position, true);
+            beltDepthShader.use();
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_BUFFER, asteroidMeshes.vertexTexture());
+            asteroidBelt.drawInstanced(asteroidMeshes.indexCount());
             glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, blackWood);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, blackWoodSpecular);
-            glDrawElements(GL_TRIANGLES, 24, GL_UNSIGNED_INT, 0);
-//        glDrawArrays(GL_TRIANGLES, 0, 120);
-            glBindVertexArray(0);
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthFunc(GL_EQUAL);
+            glDepthMask(GL_FALSE);
         }
+        if (deferredShading) {
+            // depth was cleared with the scene targets, it is shared
+            glBindFramebuffer(GL_FRAMEBUFFER, deferredRenderer.framebuffer());
+            glClear(GL_COLOR_BUFFER_BIT);
+        }
+        fragmentQuery.begin();
 
+        // Sun and planets, only the lit ones into the G-buffer
+        renderSystem(world, scene, camera.position, false, deferredShading ? Bodies::Lit : Bodies::All);
 
-        // Draw sun
-        sunShader.use();
-        model = glm::mat4(1.0f);
-        sunShader.setMat4("model", model);
-        sun.draw(sunShader);
+        beltShader.use();
+        materials.bind(asteroidMaterial, beltShader);
+        // every variant in one instanced draw, vertices are fetched per instance from the buffer texture
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_BUFFER, asteroidMeshes.vertexTexture());
+        asteroidBelt.drawInstanced(asteroidMeshes.indexCount());
+        glActiveTexture(GL_TEXTURE0);
+
+        fragmentQuery.end();
+        if (prepass) {
+            glDepthFunc(GL_LESS);
+            glDepthMask(GL_TRUE);
+        }
+        sceneTimer.end();
+
+        if (deferredShading) {
+            deferredRenderer.light(view, projection, camera.position, sunLight, spotLightEnabled ? &spotLight : nullptr,
+                                   shadows ? &shadowMap : nullptr, localLights);
+            // the sun isn't lit, it goes straight into the scene targets behind the G-buffer depth
+            glBindFramebuffer(GL_FRAMEBUFFER, antiAliasing.framebuffer());
+            renderSystem(world, scene, camera.position, false, Bodies::Emissive);
+        }
 
         // Draw Skybox
         glDepthMask(GL_FALSE);
@@ -462,57 +794,43 @@ int main() {
         glDepthFunc(GL_LESS);
 
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-        bool horizontal = true;
-        bool first_iteration = true;
-        blurShader.use();
-        unsigned int amount = 10;
-        for (unsigned int i = 0; i < amount; ++i) {
-            glBindFramebuffer(GL_FRAMEBUFFER, pingpongFBO[horizontal]);
-            blurShader.setBool("horizontal", horizontal);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, first_iteration ? colorBuffers[i] : pingpongColorBuffers[!horizontal]);
-
-            glBindVertexArray(quadVAO);
-            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-            glBindVertexArray(0);
-
-            horizontal = !horizontal;
-            if (first_iteration) {
-                first_iteration = false;
-            }
+        // post-processing ends in the window
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        glViewport(0, 0, framebufferWidth, framebufferHeight);
+        unsigned int sceneColor = antiAliasing.resolve();
+
+        if (benchmarkBlur) {
+            bloomBlur.benchmark(colorBuffers[1], {4.0f, 8.0f, 16.0f, 32.0f, 64.0f});
+            benchmarkBlur = false;
+        }
+        if (autoExposure && hdr) {
+            exposure = exposureMeter.update(exposure, rg::getDeltaTime());
+            exposureMeter.meter(sceneColor);
         }
 
-        glBindFramebuffer(GL_FRAMEBUFFER, screenFBO);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        hdrShader.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, pingpongColorBuffers[!horizontal]);
-        hdrShader.setBool("hdr", hdr);
-        hdrShader.setBool("bloom", bloom);
-        hdrShader.setFloat("exposure", exposure);
-
-        glBindVertexArray(quadVAO);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glBindVertexArray(0);
-
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        screenShader.use();
-        screenShader.setInt("effect", effect);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, screenColorBuffer);
-
-        glBindVertexArray(quadVAO);
-        glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-        glBindVertexArray(0);
+        bool compute = computePost && computeComposite;
+        bloomBlur.compute = compute;
+        blurTimer.begin();
+        // with bloom off the resolve variant doesn't sample it at all
+        unsigned int bloomTexture = bloom ? bloomBlur.apply(colorBuffers[1], bloomRadius * resolutionController.scale()) : 0;
+        blurTimer.end();
+
+        compositeTimer.begin();
+        if (compute) {
+            computeComposite->apply(sceneColor, bloomTexture, hdr, bloom, exposure, effect);
+            computeComposite->present();
+        } else {
+            compositor.apply(sceneColor, bloomTexture, hdr, bloom, exposure, effect);
+        }
+        compositeTimer.end();
 
 
 //        drawImGui();
 
 
+        frameData.endFrame();
+        resolutionController.endFrame();
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -551,6 +869,93 @@ void update(GLFWwindow *window) {
     }
 }
 
+void lightSystem(rg::World &world, const rg::SceneGraph &scene) {
+    world.each<rg::Light, rg::Transform>([&](rg::Entity e, rg::Light &light, rg::Transform &transform) {
+        light.point.position = scene.worldPosition(transform.node);
+    });
+}
+
+// Everything lit casts a shadow from the sun, emissive bodies are the light itself. Lit bodies are drawn with
+// planet.vs, casterShader is its shadow variant.
+void shadowSystem(rg::World &world, const rg::SceneGraph &scene, const rg::Shader &casterShader) {
+    world.each<rg::Renderable, rg::Transform>([&](rg::Entity e, rg::Renderable &renderable, rg::Transform &transform) {
+        if (world.get<rg::Emissive>(e)) {
+            return;
+        }
+        casterShader.setMat4("model", scene.world(transform.node));
+        renderable.model->drawDepth();
+    });
+}
+
+// Opaque draws go front to back by distance to the camera, so early Z rejects what is hidden behind
+// nearer bodies even without the pre-pass.
+void renderSystem(rg::World &world, const rg::SceneGraph &scene, const glm::vec3 &viewPos, bool depthOnly,
+                  Bodies bodies) {
+    struct Draw {
+        float distance;
+        rg::Renderable *renderable;
+        int node;
+    };
+    std::vector<Draw> draws;
+    world.each<rg::Renderable, rg::Transform>(
+            [&](rg::Entity e, rg::Renderable &renderable, rg::Transform &transform) {
+                bool emissive = world.get<rg::Emissive>(e) != nullptr;
+                if ((bodies == Bodies::Lit && emissive) || (bodies == Bodies::Emissive && !emissive)) {
+                    return;
+                }
+                glm::vec3 offset = scene.worldPosition(transform.node) - viewPos;
+                draws.push_back({glm::dot(offset, offset), &renderable, transform.node});
+            });
+    std::sort(draws.begin(), draws.end(), [](const Draw &a, const Draw &b) {
+        return a.distance < b.distance;
+    });
+
+    for (const Draw &draw: draws) {
+        rg::Shader *shader = depthOnly ? draw.renderable->depthShader : draw.renderable->shader;
+        shader->use();
+        shader->setMat4("model", scene.world(draw.node));
+        if (depthOnly) {
+            draw.renderable->model->drawDepth();
+        } else {
+            draw.renderable->model->draw(*shader);
+        }
+    }
+}
+
+void gravitySystem(rg::World &world, const rg::SceneGraph &scene, rg::NBody &bodies) {
+    bodies.attractors.clear();
+    world.each<rg::Gravity, rg::Transform>([&](rg::Entity e, rg::Gravity &gravity, rg::Transform &transform) {
+        bodies.attractors.push_back({scene.worldPosition(transform.node), gravity.mass});
+    });
+}
+
+void occluderSystem(rg::World &world, const rg::SceneGraph &scene, rg::OcclusionBuffer &occlusionBuffer) {
+    world.each<rg::Occluder, rg::Transform>([&](rg::Entity e, rg::Occluder &occluder, rg::Transform &transform) {
+        const glm::mat4 &model = scene.world(transform.node);
+        float scale = std::min({glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])),
+                                glm::length(glm::vec3(model[2]))});
+        occlusionBuffer.addSphereOccluder(glm::vec3(model[3]), occluder.radius * scale);
+    });
+}
+
+void referenceSystem(rg::World &world, const rg::SceneGraph &scene, rg::ReferenceRenderer &reference) {
+    std::unordered_map<const rg::Model *, int> models;
+    world.each<rg::Renderable, rg::Transform>([&](rg::Entity e, rg::Renderable &renderable, rg::Transform &transform) {
+        auto it = models.find(renderable.model);
+        if (it == models.end()) {
+            const rg::Model &model = *renderable.model;
+            int id = reference.addModel(cpuGeometry(model), model.directory, model.gammaCorrection);
+            it = models.emplace(renderable.model, id).first;
+        }
+        const rg::Emissive *emissive = world.get<rg::Emissive>(e);
+        if (emissive) {
+            reference.drawEmissive(it->second, scene.world(transform.node), emissive->color);
+        } else {
+            reference.drawLit(it->second, scene.world(transform.node), true);
+        }
+    });
+}
+
 void mouseCallback(GLFWwindow *w, double xPos, double yPos) {
     glm::vec2 mouseOffset = rg::getMouseOffset((float) xPos, (float) yPos);
     camera.rotate(mouseOffset.x, mouseOffset.y, true);
@@ -576,6 +981,110 @@ void keyCallback(GLFWwindow *window, int key, int scancode, int action, int mods
         bloom = !bloom;
     }
 
+    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+        simulationClock.paused = !simulationClock.paused;
+    }
+
+    if (key == GLFW_KEY_LEFT_BRACKET && action == GLFW_PRESS) {
+        simulationClock.setTimeScale(simulationClock.timeScale() * 0.5);
+    }
+
+    if (key == GLFW_KEY_RIGHT_BRACKET && action == GLFW_PRESS) {
+        simulationClock.setTimeScale(simulationClock.timeScale() * 2.0);
+    }
+
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        gpuAsteroids = !gpuAsteroids;
+    }
+
+    if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+        multiDraw = !multiDraw;
+    }
+
+    if (key == GLFW_KEY_O && action == GLFW_PRESS) {
+        occlusionCulling = !occlusionCulling;
+    }
+
+    if (key == GLFW_KEY_Z && action == GLFW_PRESS) {
+        depthPrepass = !depthPrepass;
+    }
+
+    if (key == GLFW_KEY_F1 && action == GLFW_PRESS) {
+        printStats = true;
+    }
+
+    if (key == GLFW_KEY_F2 && action == GLFW_PRESS) {
+        captureReference = true;
+    }
+
+    if (key == GLFW_KEY_E && action == GLFW_PRESS) {
+        autoExposure = !autoExposure;
+    }
+
+    if ((key == GLFW_KEY_MINUS || key == GLFW_KEY_EQUAL) && action == GLFW_PRESS) {
+        exposure *= key == GLFW_KEY_MINUS ? 0.8f : 1.25f;
+        autoExposure = false;
+    }
+
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        computePost = !computePost;
+    }
+
+    if (key == GLFW_KEY_R && action == GLFW_PRESS) {
+        dynamicResolution = !dynamicResolution;
+    }
+
+    if (key == GLFW_KEY_U && action == GLFW_PRESS) {
+        upscaleSharpen = !upscaleSharpen;
+    }
+
+    if (key == GLFW_KEY_F4 && action == GLFW_PRESS) {
+        injectLoadSpike = true;
+    }
+
+    if (key == GLFW_KEY_T && action == GLFW_PRESS) {
+        // off -> MSAA -> TAA
+        antiAliasingMode = (rg::AntiAliasing::Mode) (((int) antiAliasingMode + 1) % 3);
+        LOG(std::cout) << "Anti-aliasing: " << rg::AntiAliasing::name(antiAliasingMode)
+                       << (deferredShading && antiAliasingMode == rg::AntiAliasing::Mode::MSAA
+                           ? " (off while shading is deferred)\n" : "\n");
+    }
+
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        shadows = !shadows;
+    }
+
+    if (key == GLFW_KEY_K && action == GLFW_PRESS) {
+        // 512 -> 1024 -> 2048 -> 4096
+        shadowResolution = shadowResolution >= 4096 ? 512 : shadowResolution * 2;
+        LOG(std::cout) << "Shadow cube faces: " << shadowResolution << 'x' << shadowResolution << '\n';
+    }
+
+    if (key == GLFW_KEY_J && action == GLFW_PRESS) {
+        // every 1st, 2nd, 4th or 8th frame
+        shadowUpdateInterval = shadowUpdateInterval >= 8 ? 1 : shadowUpdateInterval * 2;
+        LOG(std::cout) << "Shadows rendered every " << shadowUpdateInterval << " frame(s) while the scene moves\n";
+    }
+
+    if (key == GLFW_KEY_X && action == GLFW_PRESS) {
+        deferredShading = !deferredShading;
+        LOG(std::cout) << (deferredShading ? "Deferred" : "Forward") << " shading\n";
+    }
+
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        // 0 -> 16 -> 64 -> 256 -> 1024
+        localLightCount = localLightCount == 0 ? 16 : localLightCount >= 1024 ? 0 : localLightCount * 4;
+        LOG(std::cout) << "Local lights: " << localLightCount << '\n';
+    }
+
+    if (key == GLFW_KEY_F3 && action == GLFW_PRESS) {
+        benchmarkBlur = true;
+    }
+
+    if (key == GLFW_KEY_N && action == GLFW_PRESS) {
+        nbodyAsteroids = !nbodyAsteroids;
+    }
+
     if (key >= GLFW_KEY_0 && key <= GLFW_KEY_3 && action == GLFW_PRESS) {
         effect = key - GLFW_KEY_0;
     }
@@ -611,4 +1120,60 @@ void drawImGui() {
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
-}
\ No newline at end of file
+}
+
+std::vector<std::string> litFeatures(bool specularMap) {
+    std::vector<std::string> features;
+    if (deferredShading) {
+        // lights are applied by rg::DeferredRenderer
+        if (specularMap) {
+            features.emplace_back("SPECULAR_MAP");
+        }
+        return features;
+    }
+    if (spotLightEnabled) {
+        features.emplace_back("SPOT_LIGHT");
+    }
+    if (specularMap) {
+        features.emplace_back("SPECULAR_MAP");
+    }
+    if (shadows) {
+        features.emplace_back("SHADOWS");
+    }
+    if (localLightCount > 0) {
+        features.emplace_back("LOCAL_LIGHTS");
+    }
+    return features;
+}
+
+// Occluders stand in for their models and must not cover more, so they get the closest vertex
+// distance with a little margin for the faces between vertices.
+float innerRadius(const rg::Model &model) {
+    float radius = std::numeric_limits<float>::max();
+    for (const rg::Mesh &mesh: model.meshes) {
+        for (const rg::Vertex &vertex: mesh.vertices) {
+            radius = std::min(radius, glm::length(vertex.Position));
+        }
+    }
+    return radius * 0.9f;
+}
+
+rg::ObjData cpuGeometry(const rg::Model &model) {
+    rg::ObjData data;
+    for (const rg::Mesh &mesh: model.meshes) {
+        rg::ObjMesh cpuMesh;
+        cpuMesh.vertices = mesh.vertices;
+        cpuMesh.indices = mesh.indices;
+        for (const rg::Texture &texture: mesh.textures) {
+            if (texture.type == "texture_diffuse") {
+                rg::ObjMaterial material;
+                material.diffuseMap = texture.path;
+                cpuMesh.material = (int) data.materials.size();
+                data.materials.push_back(material);
+                break;
+            }
+        }
+        data.meshes.push_back(std::move(cpuMesh));
+    }
+    return data;
+}
@@ -0,0 +1,60 @@
+#include <cstring>
+
+#include <GLFW/glfw3.h>
+
+#include <rg/utils/glext.hpp>
+#include <rg/utils/debug.hpp>
+
+namespace rg {
+
+    GLExtensions glext;
+
+    bool hasGLVersion(int major, int minor) {
+        return glext.major > major || (glext.major == major && glext.minor >= minor);
+    }
+
+    bool hasGLExtension(const char *name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; ++i) {
+            auto *extension = (const char *) glGetStringi(GL_EXTENSIONS, i);
+            if (extension && std::strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void loadGLExtensions() {
+        glext = GLExtensions();
+        glext.major = GLVersion.major;
+        glext.minor = GLVersion.minor;
+
+        if (hasGLVersion(4, 3) || hasGLExtension("GL_ARB_multi_draw_indirect")) {
+            glext.multiDrawElementsIndirect = (PFNRGMULTIDRAWELEMENTSINDIRECTPROC) glfwGetProcAddress(
+                    "glMultiDrawElementsIndirect");
+            glext.multiDrawIndirect = glext.multiDrawElementsIndirect != nullptr;
+        }
+
+        if (hasGLVersion(4, 4) || hasGLExtension("GL_ARB_buffer_storage")) {
+            glext.bufferStorage = (PFNRGBUFFERSTORAGEPROC) glfwGetProcAddress("glBufferStorage");
+            glext.persistentMapping = glext.bufferStorage != nullptr;
+        }
+
+        glext.pipelineStatistics = hasGLVersion(4, 6) || hasGLExtension("GL_ARB_pipeline_statistics_query");
+
+        // the compute shaders are #version 430, so no extension fallback here
+        if (hasGLVersion(4, 3)) {
+            glext.dispatchCompute = (PFNRGDISPATCHCOMPUTEPROC) glfwGetProcAddress("glDispatchCompute");
+            glext.bindImageTexture = (PFNRGBINDIMAGETEXTUREPROC) glfwGetProcAddress("glBindImageTexture");
+            glext.memoryBarrier = (PFNRGMEMORYBARRIERPROC) glfwGetProcAddress("glMemoryBarrier");
+            glext.computeShaders = glext.dispatchCompute && glext.bindImageTexture && glext.memoryBarrier;
+        }
+
+        LOG(std::cout) << "OpenGL " << glext.major << '.' << glext.minor << ", multi draw indirect: "
+                       << (glext.multiDrawIndirect ? "yes" : "no") << ", buffer storage: "
+                       << (glext.persistentMapping ? "yes" : "no") << ", pipeline statistics: "
+                       << (glext.pipelineStatistics ? "yes" : "no") << ", compute shaders: "
+                       << (glext.computeShaders ? "yes" : "no") << '\n';
+    }
+}
@@ -1,4 +1,5 @@
 #include <rg/utils/utils.hpp>
+#include <rg/utils/glext.hpp>
 
 namespace rg {
 
@@ -7,8 +8,8 @@ namespace rg {
     bool firstMouse = true;
     float lastX{};
     float lastY{};
-    float deltaTime{};
-    float lastFrame{};
+    double deltaTime{};
+    double lastFrame{};
 
     std::random_device rand_dev;
     std::mt19937 generator(rand_dev());
@@ -27,15 +28,20 @@ namespace rg {
         }
 
         gladLoaded = true;
+        loadGLExtensions();
     }
 
     void updateDeltaTime() {
-        float currentFrame = glfwGetTime();
+        double currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
     }
 
     float getDeltaTime() {
+        return (float) deltaTime;
+    }
+
+    double getDeltaTimeSeconds() {
         return deltaTime;
     }
 
@@ -0,0 +1,180 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <rg/OrbitTransforms.hpp>
+#include <rg/utils/utils.hpp>
+
+// Runs asteroid_belt.vs for a few instances with transform feedback and compares the world positions it
+// produces to buildOrbitTransforms. Each instance draws a point at the origin and at the three unit axes, so
+// the captured positions are the translation and translation + each rotation column.
+// Run from the repository root, exits with 77 (skipped) when no GL 3.3 context can be created.
+
+namespace {
+    const int skipped = 77;
+
+    unsigned int compile(GLenum type, const std::string &source) {
+        unsigned int shader = glCreateShader(type);
+        const char *code = source.c_str();
+        glShaderSource(shader, 1, &code, nullptr);
+        glCompileShader(shader);
+        int success = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            LOG(std::cerr) << "Failed to compile asteroid_belt.vs:\n" << log << '\n';
+        }
+        return shader;
+    }
+}
+
+int main() {
+    rg::glfwInit(3, 3, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(64, 64, "asteroid_belt_gpu", nullptr, nullptr);
+    if (!window) {
+        LOG(std::cout) << "No OpenGL 3.3 context, skipping.\n";
+        glfwTerminate();
+        return skipped;
+    }
+    glfwMakeContextCurrent(window);
+    rg::loadGlad();
+
+    // Only the vertex stage runs, the rasterizer is discarded. FragPos is captured before the view and
+    // projection (identity here anyway) are applied.
+    std::string source = rg::readFileContents("resources/shaders/asteroid_belt.vs");
+    unsigned int program = glCreateProgram();
+    unsigned int vertexShader = compile(GL_VERTEX_SHADER, source);
+    glAttachShader(program, vertexShader);
+    const char *varyings[] = {"VS_OUT.FragPos"};
+    glTransformFeedbackVaryings(program, 1, varyings, GL_INTERLEAVED_ATTRIBS);
+    glLinkProgram(program);
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        LOG(std::cerr) << "Failed to link asteroid_belt.vs:\n" << log << '\n';
+        return 1;
+    }
+
+    // one variant of four vertices, two texels each as in AsteroidMeshes: position.xyz uv.x, uv.y normal.xyz
+    const int vertexCount = 4;
+    const glm::vec3 points[vertexCount] = {glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f),
+                                           glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)};
+    std::vector<glm::vec4> texels;
+    for (const glm::vec3 &p: points) {
+        texels.emplace_back(p, 0.0f);
+        texels.emplace_back(0.0f, 0.0f, 1.0f, 0.0f);
+    }
+    unsigned int vertexBuffer, vertexTexture;
+    glGenBuffers(1, &vertexBuffer);
+    glBindBuffer(GL_TEXTURE_BUFFER, vertexBuffer);
+    glBufferData(GL_TEXTURE_BUFFER, texels.size() * sizeof(glm::vec4), texels.data(), GL_STATIC_DRAW);
+    glGenTextures(1, &vertexTexture);
+    glActiveTexture(GL_TEXTURE2);
+    glBindTexture(GL_TEXTURE_BUFFER, vertexTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, vertexBuffer);
+    glActiveTexture(GL_TEXTURE0);
+
+    // instances laid out like AsteroidBelt::setupInstancing
+    const int instanceCount = 16;
+    std::mt19937 random(42u);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    rg::OrbitBatch batch;
+    std::vector<glm::vec3> instanceData;
+    for (int i = 0; i < instanceCount; ++i) {
+        glm::vec3 orbit(30.0f + 2.0f * unit(random), 2.0f * unit(random), glm::radians(360.0f) * i / instanceCount);
+        glm::vec3 axis = glm::normalize(glm::vec3(unit(random), unit(random), unit(random)));
+        batch.add(orbit.x, orbit.y, orbit.z, axis);
+        instanceData.push_back(orbit);
+        instanceData.push_back(axis);
+    }
+    std::vector<int> variants(instanceCount, 0);
+
+    unsigned int vao, instanceVBO, variantVBO, feedbackBuffer;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, instanceData.size() * sizeof(glm::vec3), instanceData.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) 0);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 2 * sizeof(glm::vec3), (void *) sizeof(glm::vec3));
+    glVertexAttribDivisor(4, 1);
+    glGenBuffers(1, &variantVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, variantVBO);
+    glBufferData(GL_ARRAY_BUFFER, variants.size() * sizeof(int), variants.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(9);
+    glVertexAttribIPointer(9, 1, GL_INT, sizeof(int), (void *) 0);
+    glVertexAttribDivisor(9, 1);
+
+    glGenBuffers(1, &feedbackBuffer);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, feedbackBuffer);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, instanceCount * vertexCount * sizeof(glm::vec3), nullptr,
+                 GL_STATIC_READ);
+
+    glm::mat4 identity(1.0f);
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "asteroidVertices"), 2);
+    glUniform1i(glGetUniformLocation(program, "asteroidVertexCount"), vertexCount);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, &identity[0][0]);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, &identity[0][0]);
+    glEnable(GL_RASTERIZER_DISCARD);
+
+    // angles as AsteroidBelt::angles hands them out, wrapped to [0, 2 pi)
+    const glm::vec2 frames[] = {{0.0f, 0.0f}, {0.7f, 2.1f}, {3.1f, 4.4f}, {6.28f, 6.2f}};
+    // float sin/cos of angles up to 2 pi plus radius 32 leave a few ulps at that scale
+    const float tolerance = 1e-3f;
+    float maxError = 0.0f;
+    std::vector<float> expected(instanceCount * 16);
+    std::vector<glm::vec3> captured(instanceCount * vertexCount);
+    for (const glm::vec2 &angles: frames) {
+        glUniform1f(glGetUniformLocation(program, "orbitAngle"), angles.x);
+        glUniform1f(glGetUniformLocation(program, "spinAngle"), angles.y);
+        glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedbackBuffer);
+        glBeginTransformFeedback(GL_POINTS);
+        glDrawArraysInstanced(GL_POINTS, 0, vertexCount, instanceCount);
+        glEndTransformFeedback();
+        glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, feedbackBuffer);
+        glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captured.size() * sizeof(glm::vec3), captured.data());
+
+        rg::buildOrbitTransforms(batch, angles.x, angles.y, expected.data(), 0, instanceCount);
+        for (int i = 0; i < instanceCount; ++i) {
+            const float *m = &expected[i * 16];
+            glm::vec3 translation(m[12], m[13], m[14]);
+            for (int v = 0; v < vertexCount; ++v) {
+                glm::vec3 cpu = translation;
+                if (v > 0) {
+                    cpu += glm::vec3(m[(v - 1) * 4], m[(v - 1) * 4 + 1], m[(v - 1) * 4 + 2]);
+                }
+                glm::vec3 gpu = captured[i * vertexCount + v];
+                float error = glm::length(gpu - cpu);
+                maxError = std::max(maxError, error);
+                if (error > tolerance) {
+                    LOG(std::cout) << "Instance " << i << " vertex " << v << " at angles " << angles.x << ", "
+                                   << angles.y << ": GPU " << gpu << ", CPU " << cpu << '\n';
+                }
+            }
+        }
+    }
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    bool passed = glGetError() == GL_NO_ERROR && maxError <= tolerance;
+    LOG(std::cout) << instanceCount << " instances, " << sizeof(frames) / sizeof(frames[0]) << " frames on "
+                   << rg::orbitTransformsBackend() << ": max difference " << maxError
+                   << (passed ? "\n" : ", FAILED\n");
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/AsteroidBelt.hpp>
+#include <rg/OcclusionBuffer.hpp>
+#include <rg/JobSystem.hpp>
+#include <rg/utils/debug.hpp>
+
+// Culls the belt by orbit centers (the GPU animated path) behind synthetic sphere occluders and checks it
+// against culling the translations of full CPU matrices. Every asteroid culled by occlusion must really be
+// hidden: its bounding sphere inside the silhouette of an occluder and behind it. No GL context.
+// Usage: asteroid_culling [asteroids]
+
+namespace {
+    struct Sphere {
+        glm::vec3 center;
+        float radius;
+    };
+
+    // Whole sphere s seen from eye inside the cone of occluder o and farther away than its front.
+    bool hiddenBehind(const glm::vec3 &eye, const Sphere &s, const Sphere &o) {
+        glm::vec3 toS = s.center - eye;
+        glm::vec3 toO = o.center - eye;
+        float distS = glm::length(toS);
+        float distO = glm::length(toO);
+        if (distS - s.radius <= distO || distO <= o.radius) {
+            return false;
+        }
+        float angle = std::acos(glm::clamp(glm::dot(toS, toO) / (distS * distO), -1.0f, 1.0f));
+        return angle + std::asin(s.radius / distS) <= std::asin(o.radius / distO);
+    }
+}
+
+int main(int argc, char **argv) {
+    int count = argc > 1 ? std::atoi(argv[1]) : 20000;
+    rg::JobSystem jobs;
+    rg::AsteroidBelt belt(count, 30.0f, 2.0f);
+    // the same batch the belt builds its matrices from
+    rg::OrbitBatch batch;
+    for (int i = 0; i < count; ++i) {
+        batch.add(belt.orbits[i].x, belt.orbits[i].y, belt.orbits[i].z, belt.axes[i]);
+    }
+
+    // looking across the sun at the far side of the belt, a planet in between
+    const glm::vec3 eye(0.0f, 3.0f, 42.0f);
+    const std::vector<Sphere> occluders = {{glm::vec3(0.0f), 12.0f}, {glm::vec3(-8.0f, 0.0f, 20.0f), 3.0f}};
+    glm::mat4 view = glm::lookAt(eye, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 200.0f);
+
+    rg::OcclusionBuffer frustumOnly(256, 144);
+    frustumOnly.clear(view, projection);
+    frustumOnly.buildPyramid();
+    rg::OcclusionBuffer culler(256, 144);
+    culler.clear(view, projection);
+    for (const Sphere &occluder: occluders) {
+        culler.addSphereOccluder(occluder.center, occluder.radius);
+    }
+    culler.buildPyramid();
+
+    bool passed = true;
+    int occluded = 0;
+    double orbitSeconds = 0.0;
+    double matrixSeconds = 0.0;
+    std::vector<glm::mat4> matrices(count);
+    for (double time: {0.0, 7.5, 31.0, 1e5}) {
+        std::vector<unsigned char> inFrustum;
+        belt.cullOrbits(time, jobs, frustumOnly);
+        inFrustum = belt.visibility();
+
+        auto start = std::chrono::steady_clock::now();
+        int visible = belt.cullOrbits(time, jobs, culler);
+        orbitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // what the matrix path tests: the translation of the full model matrix
+        start = std::chrono::steady_clock::now();
+        glm::vec2 angles = belt.angles(time);
+        std::vector<unsigned char> reference(count);
+        jobs.parallelFor(0, count, 1024, [&](size_t first, size_t last) {
+            rg::buildOrbitTransforms(batch, angles.x, angles.y, (float *) matrices.data() + first * 16,
+                                     first, last - first);
+            for (size_t i = first; i < last; ++i) {
+                reference[i] = culler.isVisible(glm::vec3(matrices[i][3]), belt.boundingRadius);
+            }
+        });
+        matrixSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const std::vector<unsigned char> &result = belt.visibility();
+        for (int i = 0; i < count; ++i) {
+            glm::vec3 center(matrices[i][3]);
+            // centers from the sine/cosine pairs may differ in the last bits, only on the edge of a test
+            if (result[i] != reference[i] && culler.isVisible(center, belt.boundingRadius * 1.001f) ==
+                                             culler.isVisible(center, belt.boundingRadius * 0.999f)) {
+                LOG(std::cout) << "Asteroid " << i << " at time " << time << ": orbit culling says "
+                               << (int) result[i] << ", matrix culling " << (int) reference[i] << '\n';
+                passed = false;
+            }
+            if (inFrustum[i] && !result[i]) {
+                ++occluded;
+                Sphere asteroid{center, belt.boundingRadius};
+                bool hidden = std::any_of(occluders.begin(), occluders.end(), [&](const Sphere &occluder) {
+                    return hiddenBehind(eye, asteroid, occluder);
+                });
+                if (!hidden) {
+                    LOG(std::cout) << "Asteroid " << i << " at time " << time << " culled but not hidden\n";
+                    passed = false;
+                }
+            }
+        }
+        LOG(std::cout) << "time " << time << ": " << visible << " of " << count << " visible, "
+                       << std::count(inFrustum.begin(), inFrustum.end(), 1) << " in the frustum\n";
+    }
+    if (occluded == 0) {
+        LOG(std::cout) << "Nothing was culled by the occluders.\n";
+        passed = false;
+    }
+
+    LOG(std::cout) << occluded << " asteroids culled by occlusion over 4 frames on " << jobs.threadCount()
+                   << " threads, orbit culling " << orbitSeconds * 250.0 << " ms per frame, matrices + culling "
+                   << matrixSeconds * 250.0 << " ms per frame" << (passed ? "\n" : ", FAILED\n");
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <string>
+
+#include <rg/DynamicResolution.hpp>
+#include <rg/utils/debug.hpp>
+
+// Drives DynamicResolution::update with a made up GPU whose frame costs 4 ms plus 18 ms at full resolution,
+// read back as many frames late as the real timestamp queries, then injects the same 20 ms spike as the
+// demo's key. Checks that the controller settles under the budget, gets back under it during the spike and
+// recovers its old scale after. No GL context.
+// Usage: dynamic_resolution [--trace], --trace prints every frame of the spike as CSV.
+
+namespace {
+    const double fixedMilliseconds = 4.0;
+    const double pixelMilliseconds = 18.0;
+    // frames between rendering and reading the timestamps back, DynamicResolution's query ring
+    const int latency = 4;
+
+    class FakeGPU {
+        std::deque<float> inFlight;
+    public:
+        // renders a frame at the given scale, returns the GPU time of the one whose queries are now ready
+        double frame(float scale) {
+            inFlight.push_back(scale);
+            float measured = inFlight.front();
+            if ((int) inFlight.size() > latency) {
+                inFlight.pop_front();
+            }
+            return fixedMilliseconds + pixelMilliseconds * measured * measured;
+        }
+    };
+
+    // the model's frame time at a scale, spike included
+    double cost(float scale, double spike) {
+        return fixedMilliseconds + (pixelMilliseconds + spike) * scale * scale;
+    }
+}
+
+int main(int argc, char **argv) {
+    bool printTrace = argc > 1 && std::string(argv[1]) == "--trace";
+    rg::DynamicResolution controller(1280, 720);
+    FakeGPU gpu;
+    const double budget = controller.targetMilliseconds;
+    bool passed = true;
+
+    // from full resolution, 22 ms, down to where the model fits the budget with its headroom
+    int settleFrames = -1;
+    for (int i = 0; i < 300; ++i) {
+        controller.update(gpu.frame(controller.scale()));
+        if (settleFrames < 0 && cost(controller.scale(), 0.0) <= budget) {
+            settleFrames = i + 1;
+        }
+    }
+    float settledScale = controller.scale();
+    double settledMilliseconds = cost(settledScale, 0.0);
+    bool settled = settleFrames >= 0 && settledMilliseconds <= budget * controller.headroom + 0.5;
+    LOG(std::cout) << "Settled at scale " << settledScale << ", " << settledMilliseconds << " ms of " << budget
+                   << " ms, under budget after " << settleFrames << " frames" << (settled ? "\n" : ", FAILED\n");
+    passed = passed && settled;
+
+    // the F4 spike: 20 ms more at full resolution for 120 frames, traced for 300
+    const double spike = 20.0;
+    const int spikeFrames = 120;
+    const int tracedFrames = 300;
+    controller.injectSpike(spike, spikeFrames, tracedFrames);
+    int overBudget = 0;
+    int lastOverBudget = -1;
+    double worstMilliseconds = 0.0;
+    for (int i = 0; i < tracedFrames; ++i) {
+        double milliseconds = cost(controller.scale(), i < spikeFrames ? spike : 0.0);
+        worstMilliseconds = std::max(worstMilliseconds, milliseconds);
+        if (milliseconds > budget) {
+            ++overBudget;
+            lastOverBudget = i;
+        }
+        controller.update(gpu.frame(controller.scale()));
+    }
+    if (printTrace) {
+        controller.writeTrace(std::cout);
+    }
+
+    float lowestScale = controller.maxScale;
+    for (const rg::DynamicResolution::Sample &sample: controller.trace) {
+        lowestScale = std::min(lowestScale, sample.scale);
+    }
+    // it has to react within the spike and come back to where it was once the spike is gone
+    bool reacted = lastOverBudget >= 0 && lastOverBudget < spikeFrames / 2;
+    bool recovered = std::abs(controller.scale() - settledScale) <= controller.maxStep;
+    LOG(std::cout) << spike << " ms spike for " << spikeFrames << " frames: worst " << worstMilliseconds << " ms, "
+                   << overBudget << " frames over budget, the last one " << lastOverBudget
+                   << " frames in, lowest scale " << lowestScale << ", back to " << controller.scale()
+                   << (reacted && recovered ? "\n" : ", FAILED\n");
+    passed = passed && reacted && recovered && controller.traceReady();
+    return passed ? 0 : 1;
+}
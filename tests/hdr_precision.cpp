@@ -0,0 +1,173 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+#include <rg/RenderTargets.hpp>
+#include <rg/utils/utils.hpp>
+
+// How much R11F_G11F_B10F loses against RGBA16F once an HDR frame is tonemapped to 8 bits. The frame is a
+// ramp from 2^-8 to 2^8 with a different tint per row, the range the sun, lit planets and bloom cover.
+// First on the CPU with RenderTargets::quantize, then by rendering the same values into a target of each
+// format and reading them back. Both must stay above the PSNR floor.
+// Run from anywhere, exits with 77 (skipped) when no GL 3.3 context can be created and the CPU check passed.
+
+namespace {
+    const int skipped = 77;
+    const int width = 256;
+    const int height = 64;
+    const float exposure = 1.0f;
+    // 6/6/5 bit mantissas against 10 bit ones move a pixel by a step or two after tonemapping, ~55-60 dB
+    const double minPsnr = 50.0;
+
+    std::vector<glm::vec3> hdrFrame() {
+        std::vector<glm::vec3> frame((size_t) width * height);
+        for (int y = 0; y < height; ++y) {
+            float hue = 6.2832f * (float) y / (float) height;
+            glm::vec3 tint(0.6f + 0.4f * std::sin(hue), 0.6f + 0.4f * std::sin(hue + 2.0944f),
+                           0.6f + 0.4f * std::sin(hue + 4.1888f));
+            for (int x = 0; x < width; ++x) {
+                frame[(size_t) y * width + x] = tint * std::exp2(-8.0f + 16.0f * (float) x / (float) (width - 1));
+            }
+        }
+        return frame;
+    }
+
+    // what hdr.fs puts on screen
+    int display(float hdr) {
+        float mapped = std::pow(1.0f - std::exp(-hdr * exposure), 1.0f / 2.2f);
+        return (int) std::lround(std::min(std::max(mapped, 0.0f), 1.0f) * 255.0f);
+    }
+
+    bool compare(const char *name, const std::vector<glm::vec3> &half, const std::vector<glm::vec3> &packed) {
+        int maxDifference = 0;
+        size_t differing = 0;
+        double squaredError = 0.0;
+        for (size_t i = 0; i < half.size(); ++i) {
+            bool same = true;
+            for (int c = 0; c < 3; ++c) {
+                int difference = std::abs(display(half[i][c]) - display(packed[i][c]));
+                maxDifference = std::max(maxDifference, difference);
+                squaredError += difference * difference;
+                same = same && difference == 0;
+            }
+            differing += !same;
+        }
+        double mse = squaredError / (3.0 * (double) half.size());
+        double psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+        bool passed = psnr >= minPsnr;
+        LOG(std::cout) << name << ": R11F_G11F_B10F vs RGBA16F after tonemapping, " << differing << " of "
+                       << half.size() << " pixels differ, max " << maxDifference << "/255, PSNR " << psnr
+                       << " dB (at least " << minPsnr << ")" << (passed ? "\n" : ", FAILED\n");
+        return passed;
+    }
+
+    unsigned int compile(GLenum type, const char *source) {
+        unsigned int shader = glCreateShader(type);
+        glShaderSource(shader, 1, &source, nullptr);
+        glCompileShader(shader);
+        int success = 0;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success) {
+            char log[1024];
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            LOG(std::cerr) << "Failed to compile:\n" << log << '\n';
+        }
+        return shader;
+    }
+
+    // draws the frame from a RGB32F texture into a target of the given format and reads it back as floats
+    std::vector<glm::vec3> renderInto(const rg::TargetFormat &format, unsigned int source, unsigned int program) {
+        unsigned int target, fbo;
+        glGenTextures(1, &target);
+        glBindTexture(GL_TEXTURE_2D, target);
+        glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, width, height, 0, format.format, format.type, nullptr);
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+        std::vector<glm::vec3> pixels((size_t) width * height);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE) {
+            glViewport(0, 0, width, height);
+            glUseProgram(program);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, source);
+            glDrawArrays(GL_TRIANGLES, 0, 3);
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glReadPixels(0, 0, width, height, GL_RGB, GL_FLOAT, pixels.data());
+        } else {
+            LOG(std::cout) << format.name << " is not renderable here\n";
+            std::fill(pixels.begin(), pixels.end(), glm::vec3(-1.0f));
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteTextures(1, &target);
+        return pixels;
+    }
+}
+
+int main() {
+    std::vector<glm::vec3> frame = hdrFrame();
+    std::vector<glm::vec3> half, packed;
+    for (const glm::vec3 &color: frame) {
+        half.push_back(rg::RenderTargets::quantize(color, rg::halfFloatFormat));
+        packed.push_back(rg::RenderTargets::quantize(color, rg::packedHdrFormat));
+    }
+    if (!compare("RenderTargets::quantize", half, packed)) {
+        return 1;
+    }
+
+    rg::glfwInit(3, 3, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow *window = glfwCreateWindow(64, 64, "hdr_precision", nullptr, nullptr);
+    if (!window) {
+        LOG(std::cout) << "No OpenGL 3.3 context, skipping the readback.\n";
+        glfwTerminate();
+        return skipped;
+    }
+    glfwMakeContextCurrent(window);
+    rg::loadGlad();
+
+    // a fullscreen triangle copying the source texel for texel, so only the target's format rounds
+    const char *vertexSource = "#version 330 core\n"
+                               "void main() {\n"
+                               "    vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+                               "    gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);\n"
+                               "}\n";
+    const char *fragmentSource = "#version 330 core\n"
+                                 "uniform sampler2D frame;\n"
+                                 "out vec4 FragColor;\n"
+                                 "void main() {\n"
+                                 "    FragColor = vec4(texelFetch(frame, ivec2(gl_FragCoord.xy), 0).rgb, 1.0);\n"
+                                 "}\n";
+    unsigned int program = glCreateProgram();
+    glAttachShader(program, compile(GL_VERTEX_SHADER, vertexSource));
+    glAttachShader(program, compile(GL_FRAGMENT_SHADER, fragmentSource));
+    glLinkProgram(program);
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "frame"), 0);
+
+    unsigned int vao, source;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenTextures(1, &source);
+    glBindTexture(GL_TEXTURE_2D, source);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, frame.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    std::vector<glm::vec3> halfGPU = renderInto(rg::halfFloatFormat, source, program);
+    std::vector<glm::vec3> packedGPU = renderInto(rg::packedHdrFormat, source, program);
+    bool passed = glGetError() == GL_NO_ERROR && compare("GL readback", halfGPU, packedGPU);
+
+    glDeleteTextures(1, &source);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteProgram(program);
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <rg/ReferenceRenderer.hpp>
+#include <rg/Camera.hpp>
+#include <rg/JobSystem.hpp>
+
+// Renders the sun and two lit spheres from a fixed camera on the CPU, with geometry from rg::loadObj and no
+// GL context, and compares the tonemapped frame to tests/data/reference_renderer.ppm. Also reports the
+// renderer's throughput over the frames.
+// Run from the repository root: reference_renderer [frames] [--update], --update rewrites the golden image.
+
+namespace {
+    const char *goldenPath = "tests/data/reference_renderer.ppm";
+    const int width = 320;
+    const int height = 180;
+    const float exposure = 1.0f;
+    // the golden image comes from this renderer, only edge pixels may move with the compiler
+    const double minPsnr = 40.0;
+    const int maxError = 64;
+
+    bool readPPM(const std::string &path, int &w, int &h, std::vector<unsigned char> &pixels) {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        int maxValue = 0;
+        if (!(file >> magic >> w >> h >> maxValue) || magic != "P6" || maxValue != 255) {
+            return false;
+        }
+        file.get();
+        pixels.resize((size_t) w * h * 3);
+        return (bool) file.read((char *) pixels.data(), (std::streamsize) pixels.size());
+    }
+
+    // the lights main.cpp starts with, the spot light on and pointing from the camera
+    rg::PointLight sunLight() {
+        return {glm::vec3(0.0f), glm::vec3(0.01f), glm::vec3(10.0f), glm::vec3(10.0f), 0.5f, 0.01f, 0.001f};
+    }
+
+    rg::SpotLight spotLight(const rg::Camera &camera) {
+        return {camera.position, camera.front, glm::vec3(0.0f), glm::vec3(5.0f, 3.0f, 6.0f),
+                glm::vec3(6.0f, 3.0f, 7.0f), std::cos(glm::radians(12.5f)), std::cos(glm::radians(15.0f)), 1.0f,
+                0.02f, 0.005f};
+    }
+}
+
+int main(int argc, char **argv) {
+    int frames = 10;
+    bool update = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--update") == 0) {
+            update = true;
+        } else {
+            frames = std::max(1, std::atoi(argv[i]));
+        }
+    }
+
+    rg::JobSystem jobs;
+    rg::ReferenceRenderer renderer(width, height);
+    int sun = renderer.loadModel("resources/objects/sun/Sun.obj");
+    if (sun < 0) {
+        std::cout << "Failed to load resources/objects/sun/Sun.obj, run from the repository root.\n";
+        return 1;
+    }
+
+    rg::Camera camera(glm::vec3(0.0f, 6.0f, 30.0f));
+    camera.pitch = -10.0f;
+    camera.rotate(0.0f, 0.0f, true);
+    const glm::mat4 planets[] = {
+            glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(12.0f, 0.0f, 0.0f)), glm::vec3(0.6f)),
+            glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-7.0f, 1.0f, 8.0f)), glm::vec3(0.4f))
+    };
+
+    double setupMilliseconds = 0.0, rasterMilliseconds = 0.0, frameMilliseconds = 0.0;
+    size_t triangles = 0, fragments = 0;
+    for (int frame = 0; frame < frames; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+        renderer.begin(camera, sunLight(), spotLight(camera));
+        renderer.drawEmissive(sun, glm::mat4(1.0f), glm::vec3(100.0f));
+        for (const glm::mat4 &transform: planets) {
+            renderer.drawLit(sun, transform, true);
+        }
+        renderer.render(jobs);
+        frameMilliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        setupMilliseconds += renderer.stats().setupMilliseconds;
+        rasterMilliseconds += renderer.stats().rasterMilliseconds;
+        triangles += renderer.stats().triangles;
+        fragments += renderer.stats().fragments;
+    }
+    std::cout << width << 'x' << height << ", " << frames << " frames on " << jobs.threadCount() << " threads: "
+              << frameMilliseconds / frames << " ms per frame (setup " << setupMilliseconds / frames << ", raster "
+              << rasterMilliseconds / frames << "), " << (double) triangles / (frameMilliseconds / 1000.0) / 1e6
+              << " M triangles/s, " << (double) fragments / (frameMilliseconds / 1000.0) / 1e6
+              << " M fragments/s\n";
+
+    if (update) {
+        bool written = renderer.writePPM(goldenPath, exposure);
+        std::cout << (written ? "Wrote " : "Failed to write ") << goldenPath << '\n';
+        return written ? 0 : 1;
+    }
+
+    int goldenWidth = 0, goldenHeight = 0;
+    std::vector<unsigned char> golden;
+    if (!readPPM(goldenPath, goldenWidth, goldenHeight, golden) || goldenWidth != width || goldenHeight != height) {
+        std::cout << "No " << width << 'x' << height << " golden image at " << goldenPath << '\n';
+        return 1;
+    }
+    std::vector<unsigned char> image = renderer.toneMapped(exposure);
+    int worst = 0;
+    double squaredError = 0.0;
+    for (size_t i = 0; i < image.size(); ++i) {
+        int difference = std::abs((int) image[i] - (int) golden[i]);
+        worst = std::max(worst, difference);
+        squaredError += difference * difference;
+    }
+    double mse = squaredError / (double) image.size();
+    double psnr = mse > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+    bool passed = psnr >= minPsnr && worst <= maxError;
+    std::cout << "Against " << goldenPath << ": PSNR " << psnr << " dB (at least " << minPsnr << "), max error "
+              << worst << "/255 (at most " << maxError << ")" << (passed ? "\n" : ", FAILED\n");
+    return passed ? 0 : 1;
+}
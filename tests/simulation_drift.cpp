@@ -0,0 +1,98 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include <rg/SimulationClock.hpp>
+#include <rg/Systems.hpp>
+#include <rg/Components.hpp>
+#include <rg/utils/debug.hpp>
+
+// Runs days x 86400 simulated seconds (5184000 fixed 1/60 s steps a day) of the demo's orbits through
+// SimulationClock and orbitSystem with uneven frame times and reports how far the clock and the orbit angles
+// drift from exact time.
+// Usage: simulation_drift [days]
+
+namespace {
+    constexpr long double twoPi = 6.283185307179586476925L;
+
+    // difference of two angles, in [-pi, pi]
+    double angleError(long double angle, long double expected) {
+        return (double) std::remainder(angle - expected, twoPi);
+    }
+
+    // uneven but repeatable frame times between 4 and 40 ms, slow enough that the clock never drops steps
+    struct FrameTimes {
+        uint32_t state = 12345u;
+
+        double next() {
+            state = state * 1664525u + 1013904223u;
+            return 0.004 + 0.036 * (double) (state >> 8) / (double) (1u << 24);
+        }
+    };
+}
+
+int main(int argc, char **argv) {
+    long long days = argc > 1 ? std::atoll(argv[1]) : 1;
+
+    rg::SimulationClock clock;
+    long long targetSteps = std::llround((double) days * 86400.0 / clock.step());
+    rg::World world;
+    rg::SceneGraph scene;
+    const rg::Orbit orbits[] = {{60.0f, 0.05f, 0.0f}, {20.0f, 0.1f, 0.0f}, {30.0f, 2.0f, 1.0f}};
+    for (const rg::Orbit &orbit: orbits) {
+        world.create(rg::Transform{scene.addNode()}, orbit, rg::Motion{});
+    }
+    rg::orbitSystem(world, clock.now());
+    rg::orbitSystem(world, clock.now());
+
+    FrameTimes frameTimes;
+    long double fed = 0.0L;
+    float naiveTime = 0.0f;
+    long long steps = 0;
+    while (steps < targetSteps) {
+        double dt = frameTimes.next();
+        clock.advance(dt);
+        fed += dt;
+        while (clock.tick()) {
+            rg::orbitSystem(world, clock.now());
+            naiveTime += (float) clock.step();
+            ++steps;
+        }
+        rg::interpolationSystem(world, scene, clock.alpha());
+    }
+    scene.update();
+
+    // all fed time is either simulated or waiting in the accumulator
+    long double exactNow = (long double) steps * (long double) clock.step();
+    double clockDrift = (double) (fed - (exactNow + (long double) clock.alpha() * clock.step()));
+    double stepDrift = (double) ((long double) clock.now() - exactNow);
+    long double exactRender = exactNow - clock.step() + (long double) clock.alpha() * clock.step();
+
+    double orbitDrift = 0.0;
+    double renderDrift = 0.0;
+    world.each<rg::Orbit, rg::Motion, rg::Transform>(
+            [&](rg::Entity e, rg::Orbit &orbit, rg::Motion &motion, rg::Transform &transform) {
+                long double expected = orbit.phase + exactNow * orbit.speed;
+                orbitDrift = std::max(orbitDrift, std::abs(
+                        angleError(std::atan2(motion.current.x, motion.current.z), expected)));
+                // rendering cuts the chord of the last step, that is well inside this
+                glm::vec3 rendered = scene.worldPosition(transform.node);
+                long double expectedRender = orbit.phase + exactRender * orbit.speed;
+                renderDrift = std::max(renderDrift, std::abs(
+                        angleError(std::atan2(rendered.x, rendered.z), expectedRender)));
+            });
+
+    LOG(std::cout) << steps << " steps (" << exactNow / 3600.0L << " simulated hours)\n"
+                   << "  clock drift from fed time: " << clockDrift << " s\n"
+                   << "  step time drift: " << stepDrift << " s, a float accumulator is off by "
+                   << (double) (naiveTime - exactNow) << " s\n"
+                   << "  orbit angle drift: " << orbitDrift << " rad, rendered: " << renderDrift << " rad\n";
+
+    bool passed = std::abs(clockDrift) < 1e-6 && std::abs(stepDrift) < 1e-6 && orbitDrift < 1e-4
+                  && renderDrift < 1e-3;
+    if (!passed) {
+        LOG(std::cout) << "Drift over tolerance.\n";
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include <rg/StreamBuffer.hpp>
+#include <rg/utils/debug.hpp>
+
+// Runs StreamBuffer's region and fence rotation against a fake GPU that finishes each frame a set number
+// of frames after it was submitted. Checks that every frame writes to the next region, that a region is
+// never handed out before the GPU is done with its last frame, that waits happen exactly when the GPU is
+// a whole ring behind, and that every fence is deleted once. No GL context.
+
+namespace {
+    // Fences are ids into this list, the GPU signals them in order.
+    struct FakeGPU {
+        std::vector<bool> signaled{false};
+        std::vector<bool> deleted{false};
+        std::vector<char> memory;
+        int maps = 0;
+        int unmaps = 0;
+        int blockingWaits = 0;
+        bool persistent = false;
+
+        size_t fenceCount() const {
+            return signaled.size() - 1;
+        }
+
+        // everything submitted up to the fence placed `lag` frames ago is done
+        void finishAllBut(int lag) {
+            for (size_t fence = 1; fence + lag <= fenceCount(); ++fence) {
+                signaled[fence] = true;
+            }
+        }
+    } gpu;
+
+    size_t id(GLsync fence) {
+        return (size_t) (uintptr_t) fence;
+    }
+
+    const rg::StreamBufferGL fakeGL = {
+            [](GLsizeiptr size, char **persistent) {
+                gpu.memory.assign((size_t) size, 0);
+                if (gpu.persistent) {
+                    *persistent = gpu.memory.data();
+                }
+                return 1u;
+            },
+            [](unsigned int, GLintptr offset, GLsizeiptr) {
+                ++gpu.maps;
+                return (void *) (gpu.memory.data() + offset);
+            },
+            [](unsigned int) {
+                ++gpu.unmaps;
+            },
+            []() {
+                gpu.signaled.push_back(false);
+                gpu.deleted.push_back(false);
+                return (GLsync) (uintptr_t) gpu.fenceCount();
+            },
+            [](GLsync fence, GLbitfield, GLuint64 timeout) -> GLenum {
+                if (gpu.signaled[id(fence)]) {
+                    return GL_ALREADY_SIGNALED;
+                }
+                if (timeout == 0) {
+                    return GL_TIMEOUT_EXPIRED;
+                }
+                // a blocking wait lets the GPU catch up to this fence
+                ++gpu.blockingWaits;
+                std::fill(gpu.signaled.begin(), gpu.signaled.begin() + id(fence) + 1, true);
+                return GL_CONDITION_SATISFIED;
+            },
+            [](GLsync fence) {
+                ASSERT(!gpu.deleted[id(fence)], "Fence deleted twice.");
+                gpu.deleted[id(fence)] = true;
+            },
+    };
+
+    bool run(int regionCount, int lag, bool persistent) {
+        gpu = FakeGPU();
+        gpu.persistent = persistent;
+        const GLsizeiptr regionSize = 1024;
+        const int frames = 20;
+        rg::StreamBuffer stream(regionSize, regionCount, fakeGL);
+        bool passed = stream.isPersistent() == persistent;
+
+        // fence placed at the end of the last frame that wrote each region
+        std::vector<size_t> regionFence(regionCount, 0);
+        for (int frame = 0; frame < frames; ++frame) {
+            gpu.finishAllBut(lag);
+            long long stalls = stream.stalls;
+            stream.beginFrame();
+
+            GLintptr first, second;
+            stream.map(100, 16, first);
+            stream.unmap();
+            auto *data = (char *) stream.map(64, 256, second);
+            stream.unmap();
+
+            int region = (frame + 1) % regionCount;
+            size_t last = regionFence[region];
+            bool waited = stream.stalls > stalls;
+            // a region comes back once the GPU is done with it, waiting only when the GPU is a ring behind
+            passed = passed && first == region * regionSize && second == region * regionSize + 256
+                     && data == gpu.memory.data() + second
+                     && (last == 0 || (gpu.signaled[last] && gpu.deleted[last]))
+                     && waited == (last != 0 && lag >= regionCount);
+
+            stream.endFrame();
+            regionFence[region] = gpu.fenceCount();
+        }
+
+        // the fences of the last regionCount frames are still in flight, all older ones are gone
+        size_t live = std::count(gpu.deleted.begin() + 1, gpu.deleted.end(), false);
+        bool mappedThroughGL = gpu.maps == (persistent ? 0 : 2 * frames) && gpu.unmaps == gpu.maps;
+        passed = passed && stream.frames == frames && gpu.fenceCount() == (size_t) frames
+                 && live == (size_t) regionCount && mappedThroughGL;
+        long long expectedStalls = lag >= regionCount ? frames - regionCount : 0;
+        passed = passed && stream.stalls == expectedStalls && gpu.blockingWaits == expectedStalls;
+
+        LOG(std::cout) << regionCount << " regions, GPU " << lag << " frames behind, "
+                       << (persistent ? "persistent" : "mapped per frame") << ": " << stream.stalls << " stalls"
+                       << (passed ? "\n" : ", FAILED\n");
+        return passed;
+    }
+}
+
+int main() {
+    bool passed = true;
+    for (bool persistent: {false, true}) {
+        for (int regionCount = 1; regionCount <= 4; ++regionCount) {
+            for (int lag = 0; lag <= regionCount; ++lag) {
+                passed = run(regionCount, lag, persistent) && passed;
+            }
+        }
+    }
+    return passed ? 0 : 1;
+}